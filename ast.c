@@ -22,6 +22,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <assert.h>
 
 #include "ast.h"
@@ -29,9 +30,9 @@
 #include "utils.h"
 
 /*! @cond INTERNAL */
-#define NODE_TYPE_IS_VALID(t) (t > NODE_UNDEFINED && t <= NODE_COMPARE)
+#define NODE_TYPE_IS_VALID(t) (t > NODE_UNDEFINED && t <= NODE_PRUNE)
 #define FILE_FLAG_IS_VALID(f) (f > FILE_FLAG_UNDEFINED && f <= FILE_FLAG_EMPTY)
-#define PROPERTY_IS_VALID(p)  (p > PROP_UNDEFINED && p <= PROP_FILESYSTEM)
+#define PROPERTY_IS_VALID(p)  (p > PROP_UNDEFINED && p <= PROP_IPATH)
 #define CMP_TYPE_IS_VALID(c)  (c >= CMP_UNDEFINED && c <= CMP_GT)
 #define OPERATOR_IS_VALID(op) (op >= OP_UNDEFINED && op <= OP_COMMA)
 /*! @endcond */
@@ -128,6 +129,14 @@ ast_str_to_property_id(const char *str)
 		{
 			id = PROP_FILESYSTEM;
 		}
+		else if(!strcmp(str, "path"))
+		{
+			id = PROP_PATH;
+		}
+		else if(!strcmp(str, "ipath"))
+		{
+			id = PROP_IPATH;
+		}
 		else
 		{
 			FATALF("parser", "Invalid property: %s", str);
@@ -262,6 +271,88 @@ ast_str_to_flag(const char *str)
 	return flag;
 }
 
+bool
+ast_is_find_expression(const Node *node)
+{
+	bool native = false;
+
+	assert(node != NULL);
+
+	switch(node->type)
+	{
+		case NODE_TRUE:
+		case NODE_CONDITION:
+			native = true;
+			break;
+
+		case NODE_VALUE:
+			native = ((ValueNode *)node)->vtype == VALUE_FLAG;
+			break;
+
+		case NODE_NOT:
+			native = ast_is_find_expression(((NotNode *)node)->expr);
+			break;
+
+		case NODE_EXPRESSION:
+			native = (((ExpressionNode *)node)->op == OP_AND || ((ExpressionNode *)node)->op == OP_OR)
+			         && ast_is_find_expression(((ExpressionNode *)node)->first)
+			         && ast_is_find_expression(((ExpressionNode *)node)->second);
+			break;
+
+		default:
+			break;
+	}
+
+	return native;
+}
+
+bool
+ast_is_time_invariant(const Node *node)
+{
+	bool invariant = true;
+
+	assert(node != NULL);
+
+	switch(node->type)
+	{
+		case NODE_CONDITION:
+			{
+				PropertyId prop = ((ConditionNode *)node)->prop;
+
+				/* times are compared to the current time */
+				invariant = prop != PROP_ATIME && prop != PROP_CTIME && prop != PROP_MTIME;
+			}
+			break;
+
+		case NODE_FUNC:
+			invariant = false;
+			break;
+
+		case NODE_NOT:
+			invariant = ast_is_time_invariant(((NotNode *)node)->expr);
+			break;
+
+		case NODE_PRUNE:
+			invariant = ast_is_time_invariant(((PruneNode *)node)->expr);
+			break;
+
+		case NODE_EXPRESSION:
+			invariant = ast_is_time_invariant(((ExpressionNode *)node)->first)
+			            && ast_is_time_invariant(((ExpressionNode *)node)->second);
+			break;
+
+		case NODE_COMPARE:
+			invariant = ast_is_time_invariant(((CompareNode *)node)->first)
+			            && ast_is_time_invariant(((CompareNode *)node)->second);
+			break;
+
+		default:
+			break;
+	}
+
+	return invariant;
+}
+
 static void *
 _node_new(Pool *pool, const YYLTYPE *locp, size_t size, NodeType type)
 {
@@ -391,6 +482,7 @@ _ast_cond_node_init(ConditionNode *node, PropertyId prop, CompareType cmp, Value
 	node->prop = prop;
 	node->cmp = cmp;
 	node->value = value;
+	node->predicate = SIZE_MAX;
 }
 
 Node *
@@ -449,6 +541,21 @@ ast_not_node_new(Pool *pool, const YYLTYPE *locp, Node *expr)
 	return (Node *)node;
 }
 
+Node *
+ast_prune_node_new(Pool *pool, const YYLTYPE *locp, Node *expr)
+{
+	PruneNode *node;
+
+	assert(expr != NULL);
+
+	TRACEF("parser", "new PruneNode[%#x] (first=new Node(type=%#x))", NODE_PRUNE, expr->type);
+
+	node = node_new(pool, locp, PruneNode, NODE_PRUNE);
+	node->expr = expr;
+
+	return (Node *)node;
+}
+
 Node *
 ast_func_node_new(Pool *pool, const YYLTYPE *locp, char *name, Node *args)
 {
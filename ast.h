@@ -22,6 +22,8 @@
 #ifndef AST_H
 #define AST_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <datatypes.h>
 #include "parser.y.h"
 
@@ -60,7 +62,11 @@ typedef enum
 	/*! File type. */
 	PROP_TYPE,
 	/*! File system. */
-	PROP_FILESYSTEM
+	PROP_FILESYSTEM,
+	/*! Path. */
+	PROP_PATH,
+	/*! Path (case insensitive). */
+	PROP_IPATH
 } PropertyId;
 
 /**
@@ -182,7 +188,9 @@ typedef enum
 	/*! Node is of type FuncNode. */
 	NODE_FUNC,
 	/*! Node is of type CompareNode. */
-	NODE_COMPARE
+	NODE_COMPARE,
+	/*! Node is of type PruneNode. */
+	NODE_PRUNE
 } NodeType;
 
 /**
@@ -209,6 +217,8 @@ typedef struct
 	Node *exprs;
 	/*! Root node of the filter expression tree. */
 	Node *filter_exprs;
+	/*! Directories matching this expression aren't descended. */
+	Node *prune_exprs;
 } RootNode;
 
 /**
@@ -301,6 +311,8 @@ typedef struct
 	CompareType cmp;
 	/*! A value node. */
 	ValueNode *value;
+	/*! Index of the compiled condition, assigned when predicates are compiled. */
+	size_t predicate;
 } ConditionNode;
 
 /**
@@ -347,6 +359,18 @@ typedef struct
 	Node *expr;
 } NotNode;
 
+/**
+   @struct PruneNode
+   @brief Excludes matching files and doesn't descend matching directories.
+ */
+typedef struct
+{
+	/*! Base type. */
+	Node padding;
+	/*! A node. */
+	Node *expr;
+} PruneNode;
+
 /**
    @struct FuncNode
    @brief FuncNodes hold a function name and arguments.
@@ -409,6 +433,24 @@ FileType ast_str_to_type(const char *str);
  */
 FileFlag ast_str_to_flag(const char *str);
 
+/**
+   @param node node to test
+   @return true if the node can be translated to find arguments
+
+   Tests if a node consists of conditions, flags and operators only. Such
+   nodes don't contain function calls or comparisons of function results.
+ */
+bool ast_is_find_expression(const Node *node);
+
+/**
+   @param node node to test
+   @return true if the result of the node only depends on the tested file
+
+   Tests if a node is free of time conditions, which are relative to the
+   current time, and of extension functions, which may access anything.
+ */
+bool ast_is_time_invariant(const Node *node);
+
 /**
    @param pool a Pool
    @param locp location information
@@ -517,6 +559,16 @@ Node *ast_expr_node_new(Pool *pool, const YYLTYPE *locp, Node *first, OperatorTy
  */
 Node *ast_not_node_new(Pool *pool, const YYLTYPE *locp, Node *expr);
 
+/**
+   @param pool a Pool
+   @param locp location information
+   @param expr a node
+   @return a new Node
+
+   Creates a new PruneNode from a Pool.
+ */
+Node *ast_prune_node_new(Pool *pool, const YYLTYPE *locp, Node *expr);
+
 /**
    @param pool a Pool
    @param locp location information
@@ -0,0 +1,658 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file device-sched.c
+   @brief Search starting points on different devices concurrently.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/sysmacros.h>
+#include <assert.h>
+
+#include "device-sched.h"
+#include "linux.h"
+#include "log.h"
+#include "utils.h"
+
+/*! @cond INTERNAL */
+typedef struct
+{
+	char *path;
+	size_t group;
+} DeviceSchedRoot;
+
+typedef struct
+{
+	dev_t disk;
+	size_t count;
+} DeviceSchedGroup;
+
+typedef struct
+{
+	pid_t pid;
+	int fd;
+	char *buffer;
+	size_t len;
+	size_t size;
+} DeviceSchedChild;
+
+typedef struct
+{
+	uint32_t cli_len;
+	uint32_t path_len;
+	/* file status read by the child, e.g. from the index */
+	uint32_t flags;
+	uint32_t mask;
+	mode_t type;
+	FileInfoStat sb;
+} DeviceSchedRecord;
+
+struct _DeviceSched
+{
+	size_t concurrency;
+	DeviceSchedRoot *roots;
+	size_t count;
+	DeviceSchedGroup *groups;
+	size_t ngroups;
+	int output_fd;
+};
+
+#define DEVICE_SCHED_READ_SIZE 4096
+/*! @endcond */
+
+DeviceSched *
+device_sched_new(size_t concurrency)
+{
+	DeviceSched *sched = utils_new(1, DeviceSched);
+
+	sched->concurrency = concurrency;
+	sched->output_fd = -1;
+
+	return sched;
+}
+
+void
+device_sched_watch_output(DeviceSched *sched, int fd)
+{
+	assert(sched != NULL);
+
+	sched->output_fd = fd;
+}
+
+void
+device_sched_destroy(DeviceSched *sched)
+{
+	if(sched)
+	{
+		for(size_t i = 0; i < sched->count; ++i)
+		{
+			free(sched->roots[i].path);
+		}
+
+		free(sched->roots);
+		free(sched->groups);
+		free(sched);
+	}
+}
+
+static size_t
+_device_sched_group(DeviceSched *sched, const char *path)
+{
+	struct stat sb;
+	dev_t disk = 0;
+	size_t group = 0;
+
+	assert(sched != NULL);
+	assert(path != NULL);
+
+	if(!stat(path, &sb))
+	{
+		disk = linux_dev_disk(sb.st_dev);
+	}
+
+	while(group < sched->ngroups && sched->groups[group].disk != disk)
+	{
+		++group;
+	}
+
+	if(group == sched->ngroups)
+	{
+		DEBUGF("search", "Adding device group %u:%u.", major(disk), minor(disk));
+
+		sched->groups = sched->ngroups ? utils_renew(sched->groups, sched->ngroups + 1, DeviceSchedGroup) : utils_new(1, DeviceSchedGroup);
+		sched->groups[group].disk = disk;
+		sched->groups[group].count = 0;
+		++sched->ngroups;
+	}
+
+	return group;
+}
+
+void
+device_sched_add(DeviceSched *sched, const char *path)
+{
+	assert(sched != NULL);
+	assert(path != NULL);
+
+	sched->roots = sched->count ? utils_renew(sched->roots, sched->count + 1, DeviceSchedRoot) : utils_new(1, DeviceSchedRoot);
+
+	DeviceSchedRoot *root = &sched->roots[sched->count];
+
+	root->path = utils_strdup(path);
+	root->group = _device_sched_group(sched, path);
+
+	++sched->groups[root->group].count;
+
+	TRACEF("search", "Starting point \"%s\" assigned to device group %zu.", path, root->group);
+
+	++sched->count;
+}
+
+static bool
+_device_sched_is_parallel(const DeviceSched *sched)
+{
+	assert(sched != NULL);
+
+	return sched->concurrency > 0 && sched->count > 1 && (sched->ngroups > 1 || sched->concurrency > 1);
+}
+
+static size_t
+_device_sched_children(const DeviceSched *sched, size_t group)
+{
+	assert(sched != NULL);
+	assert(group < sched->ngroups);
+
+	size_t count = sched->groups[group].count;
+
+	return count < sched->concurrency ? count : sched->concurrency;
+}
+
+static size_t
+_device_sched_partition(const DeviceSched *sched, size_t group, size_t part, size_t parts, const char **paths)
+{
+	size_t count = 0;
+	size_t n = 0;
+
+	assert(sched != NULL);
+	assert(part < parts);
+	assert(paths != NULL);
+
+	/* distribute starting points of a disk round-robin, keeping their order */
+	for(size_t i = 0; i < sched->count; ++i)
+	{
+		if(sched->roots[i].group == group)
+		{
+			if(n % parts == part)
+			{
+				paths[count++] = sched->roots[i].path;
+			}
+
+			++n;
+		}
+	}
+
+	return count;
+}
+
+static int
+_device_sched_run_sequentially(DeviceSched *sched, DeviceSchedSearch search, void *search_data, FoundFileCallback found_file, void *user_data)
+{
+	int result = 0;
+
+	assert(sched != NULL);
+	assert(search != NULL);
+
+	if(sched->count)
+	{
+		const char **paths = utils_new(sched->count, const char *);
+
+		for(size_t i = 0; i < sched->count; ++i)
+		{
+			paths[i] = sched->roots[i].path;
+		}
+
+		int ret = search(paths, sched->count, found_file, user_data, search_data);
+
+		if(ret < 0)
+		{
+			result = ret;
+		}
+
+		free(paths);
+	}
+
+	return result;
+}
+
+static bool
+_device_sched_write_file(FileInfo *info, void *user_data)
+{
+	FILE *out = (FILE *)user_data;
+	DeviceSchedRecord record;
+
+	assert(info != NULL);
+	assert(out != NULL);
+
+	memset(&record, 0, sizeof(DeviceSchedRecord));
+
+	record.cli_len = strlen(info->cli) + 1;
+	record.path_len = strlen(info->path) + 1;
+	/* the target status isn't passed on, the parent reads it again if needed */
+	record.flags = info->flags & ~FILE_INFO_FLAG_TARGET;
+	record.mask = info->mask;
+	record.type = info->type;
+
+	if(info->flags & FILE_INFO_FLAG_STAT)
+	{
+		record.sb = info->sb;
+	}
+
+	return fwrite(&record, sizeof(DeviceSchedRecord), 1, out) != 1
+	       || fwrite(info->cli, record.cli_len, 1, out) != 1
+	       || fwrite(info->path, record.path_len, 1, out) != 1;
+}
+
+static void
+_device_sched_child_process(int fd, const char *const *paths, size_t count, DeviceSchedSearch search, void *search_data)
+{
+	int status = EXIT_FAILURE;
+
+	assert(fd >= 0);
+	assert(paths != NULL);
+	assert(search != NULL);
+
+	FILE *out = fdopen(fd, "w");
+
+	if(out)
+	{
+		int ret = search(paths, count, _device_sched_write_file, out, search_data);
+
+		/* the parent receives the search result as exit status */
+		if(ret >= 0)
+		{
+			status = EXIT_SUCCESS;
+		}
+		else if(ret >= -127)
+		{
+			status = -ret;
+		}
+
+		fclose(out);
+	}
+	else
+	{
+		perror("fdopen()");
+	}
+
+	fflush(NULL);
+	_exit(status);
+}
+
+static bool
+_device_sched_spawn(DeviceSchedChild *child, const char *const *paths, size_t count, DeviceSchedSearch search, void *search_data)
+{
+	int fds[2];
+	bool success = false;
+
+	assert(child != NULL);
+	assert(paths != NULL);
+	assert(count > 0);
+
+	if(pipe2(fds, O_CLOEXEC))
+	{
+		perror("pipe2()");
+	}
+	else
+	{
+		/* don't write buffered output twice */
+		fflush(NULL);
+
+		pid_t pid = fork();
+
+		if(pid == -1)
+		{
+			perror("fork()");
+			close(fds[0]);
+			close(fds[1]);
+		}
+		else if(pid == 0)
+		{
+			close(fds[0]);
+			_device_sched_child_process(fds[1], paths, count, search, search_data);
+		}
+		else
+		{
+			DEBUGF("search", "Searching %zu directories starting with \"%s\" in child process %ld.", count, *paths, (long)pid);
+
+			close(fds[1]);
+
+			child->pid = pid;
+			child->fd = fds[0];
+			child->buffer = utils_malloc(DEVICE_SCHED_READ_SIZE);
+			child->len = 0;
+			child->size = DEVICE_SCHED_READ_SIZE;
+
+			success = true;
+		}
+	}
+
+	return success;
+}
+
+static bool
+_device_sched_start(DeviceSched *sched, DeviceSchedChild *children, size_t *running, DeviceSchedSearch search, void *search_data)
+{
+	bool success = true;
+
+	assert(sched != NULL);
+	assert(children != NULL);
+	assert(running != NULL);
+
+	const char **paths = utils_new(sched->count, const char *);
+
+	for(size_t group = 0; group < sched->ngroups && success; ++group)
+	{
+		size_t parts = _device_sched_children(sched, group);
+
+		for(size_t part = 0; part < parts && success; ++part)
+		{
+			size_t count = _device_sched_partition(sched, group, part, parts, paths);
+
+			success = _device_sched_spawn(&children[*running], paths, count, search, search_data);
+
+			if(success)
+			{
+				++*running;
+			}
+		}
+	}
+
+	free(paths);
+
+	return success;
+}
+
+static ssize_t
+_device_sched_read(DeviceSchedChild *child)
+{
+	ssize_t bytes;
+
+	assert(child != NULL);
+
+	if(child->size - child->len < DEVICE_SCHED_READ_SIZE)
+	{
+		child->size += DEVICE_SCHED_READ_SIZE;
+		child->buffer = utils_renew(child->buffer, child->size, char);
+	}
+
+	do
+	{
+		bytes = read(child->fd, child->buffer + child->len, child->size - child->len);
+	} while(bytes == -1 && errno == EINTR);
+
+	if(bytes > 0)
+	{
+		child->len += bytes;
+	}
+	else if(bytes == -1)
+	{
+		perror("read()");
+	}
+
+	return bytes;
+}
+
+static bool
+_device_sched_process(DeviceSchedChild *child, FoundFileCallback found_file, void *user_data)
+{
+	size_t offset = 0;
+	bool complete = true;
+	bool stop = false;
+
+	assert(child != NULL);
+	assert(found_file != NULL);
+
+	while(!stop && complete && child->len - offset >= sizeof(DeviceSchedRecord))
+	{
+		DeviceSchedRecord record;
+
+		memcpy(&record, child->buffer + offset, sizeof(DeviceSchedRecord));
+
+		size_t size = sizeof(DeviceSchedRecord) + record.cli_len + record.path_len;
+
+		if(child->len - offset >= size)
+		{
+			const char *cli = child->buffer + offset + sizeof(DeviceSchedRecord);
+			const char *path = cli + record.cli_len;
+			FileInfo *info = file_info_new(cli, true, path);
+
+			if(info)
+			{
+				info->flags = record.flags;
+				info->mask = record.mask;
+				info->type = record.type;
+				info->sb = record.sb;
+
+				stop = found_file(info, user_data);
+				file_info_unref(info);
+			}
+
+			offset += size;
+		}
+		else
+		{
+			complete = false;
+		}
+	}
+
+	child->len -= offset;
+	memmove(child->buffer, child->buffer + offset, child->len);
+
+	return stop;
+}
+
+static void
+_device_sched_kill(DeviceSchedChild *children, size_t running)
+{
+	assert(children != NULL);
+
+	for(size_t i = 0; i < running; ++i)
+	{
+		DEBUGF("search", "Killing child process with pid %ld.", (long)children[i].pid);
+
+		kill(children[i].pid, SIGTERM);
+	}
+}
+
+static int
+_device_sched_wait(DeviceSchedChild *child)
+{
+	int status;
+	int result = -1;
+	pid_t rc;
+
+	assert(child != NULL);
+
+	close(child->fd);
+	free(child->buffer);
+
+	do
+	{
+		rc = waitpid(child->pid, &status, 0);
+	} while(rc == -1 && errno == EINTR);
+
+	DEBUGF("search", "Child process %ld exited with status %#x.", (long)child->pid, status);
+
+	if(rc == child->pid && WIFEXITED(status))
+	{
+		result = -WEXITSTATUS(status);
+	}
+
+	return result;
+}
+
+static int
+_device_sched_run_children(DeviceSched *sched, DeviceSchedSearch search, void *search_data, FoundFileCallback found_file, void *user_data)
+{
+	size_t max = 0;
+	size_t running = 0;
+	bool stop = false;
+
+	assert(sched != NULL);
+	assert(search != NULL);
+	assert(found_file != NULL);
+
+	DEBUGF("search", "Searching %zu device group(s), up to %zu directories per device.", sched->ngroups, sched->concurrency);
+
+	for(size_t group = 0; group < sched->ngroups; ++group)
+	{
+		max += _device_sched_children(sched, group);
+	}
+
+	DeviceSchedChild *children = utils_new(max, DeviceSchedChild);
+	struct pollfd *fds = utils_new(max + 1, struct pollfd);
+	int result = 0;
+
+	if(!_device_sched_start(sched, children, &running, search, search_data))
+	{
+		result = -1;
+		stop = true;
+		_device_sched_kill(children, running);
+	}
+
+	while(running > 0)
+	{
+		nfds_t nfds = running;
+
+		for(size_t i = 0; i < running; ++i)
+		{
+			fds[i].fd = children[i].fd;
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+
+		/* POLLERR is reported when the read end of the output pipe has been closed */
+		if(sched->output_fd >= 0 && !stop)
+		{
+			fds[nfds].fd = sched->output_fd;
+			fds[nfds].events = 0;
+			fds[nfds].revents = 0;
+			++nfds;
+		}
+
+		if(poll(fds, nfds, -1) == -1)
+		{
+			if(errno != EINTR)
+			{
+				perror("poll()");
+				_device_sched_kill(children, running);
+				stop = true;
+				result = -1;
+
+				while(running > 0)
+				{
+					_device_sched_wait(&children[--running]);
+				}
+			}
+		}
+		else if(nfds > running && fds[running].revents)
+		{
+			TRACE("search", "Output has been closed, stopping child processes.");
+
+			stop = true;
+			_device_sched_kill(children, running);
+		}
+		else
+		{
+			/* finished children are replaced by the last one, which has already been processed */
+			for(size_t i = running; i > 0; --i)
+			{
+				DeviceSchedChild *child = &children[i - 1];
+
+				if(fds[i - 1].revents)
+				{
+					if(_device_sched_read(child) > 0)
+					{
+						if(stop)
+						{
+							child->len = 0;
+						}
+						else if(_device_sched_process(child, found_file, user_data))
+						{
+							TRACE("search", "Search aborted, stopping child processes.");
+
+							stop = true;
+							_device_sched_kill(children, running);
+						}
+					}
+					else
+					{
+						int ret = _device_sched_wait(child);
+
+						if(ret < 0 && !stop && !result)
+						{
+							result = ret;
+						}
+
+						*child = children[--running];
+					}
+				}
+			}
+		}
+	}
+
+	free(fds);
+	free(children);
+
+	return result;
+}
+
+int
+device_sched_run(DeviceSched *sched, DeviceSchedSearch search, void *search_data, FoundFileCallback found_file, void *user_data)
+{
+	int result;
+
+	assert(sched != NULL);
+	assert(search != NULL);
+	assert(found_file != NULL);
+
+	if(_device_sched_is_parallel(sched))
+	{
+		result = _device_sched_run_children(sched, search, search_data, found_file, user_data);
+	}
+	else
+	{
+		result = _device_sched_run_sequentially(sched, search, search_data, found_file, user_data);
+	}
+
+	return result;
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file device-sched.h
+   @brief Search starting points on different devices concurrently.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef DEVICE_SCHED_H
+#define DEVICE_SCHED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "search.h"
+
+/**
+   @struct DeviceSched
+   @brief Groups starting points by the disk they are located on. Disks are
+          searched concurrently, each by a limited number of child processes.
+ */
+typedef struct _DeviceSched DeviceSched;
+
+/**
+   @typedef DeviceSchedSearch
+   @brief A function searching a list of starting points. Returns a negative
+          value on failure.
+ */
+typedef int (*DeviceSchedSearch)(const char *const *paths, size_t count, FoundFileCallback found_file, void *found_data, void *user_data);
+
+/**
+   @param concurrency maximum number of starting points searched at the same
+                      time on a single disk, 0 to search all starting points
+                      one after another
+   @return a new DeviceSched
+
+   Creates a DeviceSched.
+ */
+DeviceSched *device_sched_new(size_t concurrency);
+
+/**
+   @param sched DeviceSched to free
+
+   Frees a DeviceSched.
+ */
+void device_sched_destroy(DeviceSched *sched);
+
+/**
+   @param sched a DeviceSched
+   @param fd write end of the pipe found files are printed to
+
+   All searches are stopped when the read end of the given pipe is closed.
+ */
+void device_sched_watch_output(DeviceSched *sched, int fd);
+
+/**
+   @param sched a DeviceSched
+   @param path starting point to add
+
+   Adds a starting point and assigns it to the group of its disk.
+ */
+void device_sched_add(DeviceSched *sched, const char *path);
+
+/**
+   @param sched a DeviceSched
+   @param search function searching a starting point
+   @param search_data user data passed to the search function
+   @param found_file function called for each found file
+   @param user_data user data passed to found_file
+   @return 0 on success, otherwise the negative value returned by a failed
+           search or -1
+
+   Searches all starting points. If only a single starting point can be
+   searched at a time all starting points are passed to a single in-process
+   search. Otherwise the starting points of each disk are distributed among
+   up to concurrency child processes. Found files are passed to found_file in
+   the order they arrive. All searches are stopped after found_file has
+   returned true.
+ */
+int device_sched_run(DeviceSched *sched, DeviceSchedSearch search, void *search_data, FoundFileCallback found_file, void *user_data);
+
+#endif
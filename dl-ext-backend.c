@@ -80,6 +80,46 @@ _dl_ext_discover(void *handle, RegisterCallback fn, RegistrationCtx *ctx)
 	}
 }
 
+static void
+_dl_ext_discover_pure(void *handle, MarkPure fn, RegistrationCtx *ctx)
+{
+	void (*declare_pure)(RegistrationCtx *ctx, MarkPure mark_fn);
+
+	assert(handle != NULL);
+	assert(fn != NULL);
+
+	declare_pure = dlsym(handle, "declare_pure");
+
+	if(declare_pure)
+	{
+		declare_pure(ctx, fn);
+	}
+	else
+	{
+		TRACE("extension", "declare_pure() function not found.");
+	}
+}
+
+static void
+_dl_ext_discover_reentrant(void *handle, MarkReentrant fn, RegistrationCtx *ctx)
+{
+	void (*declare_reentrant)(RegistrationCtx *ctx, MarkReentrant mark_fn);
+
+	assert(handle != NULL);
+	assert(fn != NULL);
+
+	declare_reentrant = dlsym(handle, "declare_reentrant");
+
+	if(declare_reentrant)
+	{
+		declare_reentrant(ctx, fn);
+	}
+	else
+	{
+		TRACE("extension", "declare_reentrant() function not found.");
+	}
+}
+
 static int
 _dl_ext_backend_invoke(void *handle, const char *name, const char *filename, uint32_t argc, void **argv, int *result)
 {
@@ -124,6 +164,8 @@ dl_extension_backend_get_class(ExtensionBackendClass *cls)
 
 	cls->load = _dl_ext_backend_load;
 	cls->discover = _dl_ext_discover;
+	cls->discover_pure = _dl_ext_discover_pure;
+	cls->discover_reentrant = _dl_ext_discover_reentrant;
 	cls->invoke = _dl_ext_backend_invoke;
 	cls->unload = _dl_ext_backend_unload;
 }
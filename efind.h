@@ -25,6 +25,8 @@
 #include <datatypes.h>
 
 #include "log.h"
+#include "walk.h"
+#include "linux.h"
 
 /*! Major version. */
 #define EFIND_VERSION_MAJOR     0
@@ -66,7 +68,17 @@ typedef enum
 	/*! Print extensions and exit. */
 	ACTION_PRINT_EXTENSIONS,
 	/*! Print ignore-list and exit. */
-	ACTION_PRINT_IGNORELIST
+	ACTION_PRINT_IGNORELIST,
+	/*! Build file index and exit. */
+	ACTION_BUILD_INDEX,
+	/*! Refresh file index and exit. */
+	ACTION_REFRESH_INDEX,
+	/*! Keep file index up to date and serve queries. */
+	ACTION_INDEX_DAEMON,
+	/*! Send search to the index daemon or query server. */
+	ACTION_CONNECT,
+	/*! Serve searches on a socket. */
+	ACTION_SERVE
 } Action;
 
 /**
@@ -83,6 +95,20 @@ typedef enum
 	FLAG_QUOTE  = 2
 } Flags;
 
+/**
+   @struct TeeOptions
+   @brief Output options of an additional branch started with --tee.
+ */
+typedef struct
+{
+	/*! Format string. */
+	char *printf;
+	/*! List of --exec argument lists. */
+	SList exec;
+	/*! File to write output to (NULL for stdout). */
+	char *output;
+} TeeOptions;
+
 /**
    @struct Options
    @brief Runtime options.
@@ -109,6 +135,10 @@ typedef struct
 	char *printf;
 	/*! List of --exec argument lists. */
 	SList exec;
+	/*! File to write output to (NULL for stdout). */
+	char *output;
+	/*! Additional output branches. */
+	SList tees;
 	/*! Don't stop if command exits with non-zero result. */
 	bool exec_ignore_errors;
 	/*! Sort string. */
@@ -117,8 +147,56 @@ typedef struct
 	int32_t skip;
 	/*! Maximum number of files to print to stdout. */
 	int32_t limit;
+	/*! Cache file for results of pure extension functions. */
+	char *cache_file;
+	/*! Number of entries of a new extension cache file (0 for default size). */
+	int32_t cache_size;
+	/*! Maximum number of files evaluated concurrently. */
+	int32_t inflight;
+	/*! Maximum number of directories searched concurrently on a single disk. */
+	int32_t device_concurrency;
+	/*! Skip files matching patterns found in .gitignore/.ignore files. */
+	bool respect_ignore_files;
+	/*! Don't descend directories on other filesystems. */
+	bool one_file_system;
+	/*! Comma-separated list of filesystems to skip. */
+	char *skip_fs_types;
+	/*! Query the file index instead of searching the filesystem. */
+	bool index_query;
+	/*! Index file (NULL for default location). */
+	char *index_file;
+	/*! Re-read the status of all indexed files when refreshing the index. */
+	bool deep_scan;
+	/*! Socket of the index daemon or query server (NULL for default location). */
+	char *socket;
+	/*! Directory to cache search results in. */
+	char *result_cache;
+	/*! Sort directory entries by inode number before reading their status. */
+	WalkInodeOrder inode_order;
+	/*! Maximum number of I/O operations per second, 0 for no limit. */
+	int32_t io_rate;
+	/*! Maximum number of I/O requests submitted at the same time, 0 for the default. */
+	int32_t max_inflight;
+	/*! I/O scheduling class. */
+	LinuxIOClass io_class;
+	/*! Milliseconds after which the search is stopped, 0 for no limit. */
+	int64_t timeout;
 } Options;
 
+/**
+   @return a new TeeOptions instance
+
+   Creates an empty output branch.
+ */
+TeeOptions *tee_options_new(void);
+
+/**
+   @param opts TeeOptions to destroy
+
+   Frees resources allocated by a TeeOptions instance.
+ */
+void tee_options_destroy(TeeOptions *opts);
+
 /**
    @param opts Options to set
 
@@ -126,6 +204,17 @@ typedef struct
  */
 void options_load_ini(Options *opts);
 
+/**
+   Reads the INI files once. Options loaded afterwards by options_load_ini()
+   are set from the cached entries.
+ */
+void options_cache_ini(void);
+
+/**
+   Frees the entries cached by options_cache_ini().
+ */
+void options_free_ini_cache(void);
+
 /**
    @param opts Options to set
    @param argc number of command-line arguments
@@ -136,5 +225,23 @@ void options_load_ini(Options *opts);
  */
 Action options_getopt(Options *opts, int argc, char *argv[]);
 
+/**
+   @param value string to parse ("auto", "yes" or "no")
+   @param dst location to store the parsed value to
+   @return true on success
+
+   Parses the value of the inode-order option.
+ */
+bool options_parse_inode_order(const char *value, WalkInodeOrder *dst);
+
+/**
+   @param value string to parse ("idle" or "best-effort")
+   @param dst location to store the parsed value to
+   @return true on success
+
+   Parses the value of the io-class option.
+ */
+bool options_parse_io_class(const char *value, LinuxIOClass *dst);
+
 #endif
 
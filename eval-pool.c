@@ -0,0 +1,330 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file eval-pool.c
+   @brief Evaluate filter expressions of several files concurrently.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <assert.h>
+
+#include "eval-pool.h"
+#include "log.h"
+#include "utils.h"
+
+/*! @cond INTERNAL */
+typedef struct
+{
+	FileInfo *info;
+	EvalResult result;
+	bool done;
+} EvalPoolSlot;
+
+typedef struct
+{
+	EvalPool *pool;
+	pthread_t thread;
+	EvalPlan *plan;
+	bool started;
+} EvalPoolWorker;
+
+struct _EvalPool
+{
+	ExtensionManager *manager;
+	EvalPoolCallback cb;
+	void *user_data;
+	pthread_mutex_t mutex;
+	pthread_cond_t job_cond;
+	pthread_cond_t done_cond;
+	EvalPoolSlot *slots;
+	size_t size;
+	/* sequence numbers: emitted < head <= started < next <= queued < tail */
+	uint64_t head;
+	uint64_t next;
+	uint64_t tail;
+	bool quit;
+	bool stopped;
+	EvalPoolWorker *workers;
+	size_t workers_count;
+};
+/*! @endcond */
+
+bool
+eval_pool_supports(const ExtensionManager *manager, const Node *root)
+{
+	bool supported = true;
+
+	assert(manager != NULL);
+
+	if(root)
+	{
+		switch(root->type)
+		{
+			case NODE_FUNC:
+				supported = extension_manager_is_reentrant(manager, ((FuncNode *)root)->name)
+				            && eval_pool_supports(manager, ((FuncNode *)root)->args);
+
+				if(!supported)
+				{
+					DEBUGF("eval", "Function `%s' is not reentrant.", ((FuncNode *)root)->name);
+				}
+				break;
+
+			case NODE_EXPRESSION:
+				supported = eval_pool_supports(manager, ((ExpressionNode *)root)->first)
+				            && eval_pool_supports(manager, ((ExpressionNode *)root)->second);
+				break;
+
+			case NODE_COMPARE:
+				supported = eval_pool_supports(manager, ((CompareNode *)root)->first)
+				            && eval_pool_supports(manager, ((CompareNode *)root)->second);
+				break;
+
+			case NODE_NOT:
+				supported = eval_pool_supports(manager, ((NotNode *)root)->expr);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return supported;
+}
+
+static void *
+_eval_pool_worker_main(void *arg)
+{
+	EvalPoolWorker *worker = arg;
+	EvalPool *pool = worker->pool;
+
+	pthread_mutex_lock(&pool->mutex);
+
+	while(!pool->quit)
+	{
+		if(pool->next == pool->tail)
+		{
+			pthread_cond_wait(&pool->job_cond, &pool->mutex);
+		}
+		else
+		{
+			EvalPoolSlot *slot = &pool->slots[pool->next++ % pool->size];
+			FileInfo *info = slot->info;
+
+			pthread_mutex_unlock(&pool->mutex);
+
+			EvalResult result = eval_plan_evaluate(worker->plan, pool->manager, info);
+
+			pthread_mutex_lock(&pool->mutex);
+
+			slot->result = result;
+			slot->done = true;
+
+			pthread_cond_signal(&pool->done_cond);
+		}
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+EvalPool *
+eval_pool_new(ExtensionManager *manager, Node *root, const Predicates *predicates, size_t inflight, EvalPoolCallback cb, void *user_data)
+{
+	assert(manager != NULL);
+	assert(root != NULL);
+	assert(inflight > 0);
+	assert(cb != NULL);
+
+	DEBUGF("eval", "Starting pool with %zu worker threads.", inflight);
+
+	EvalPool *pool = utils_new(1, EvalPool);
+
+	pool->manager = manager;
+	pool->cb = cb;
+	pool->user_data = user_data;
+	pool->size = inflight;
+	pool->slots = utils_new(inflight, EvalPoolSlot);
+	pool->workers = utils_new(inflight, EvalPoolWorker);
+
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->job_cond, NULL);
+	pthread_cond_init(&pool->done_cond, NULL);
+
+	bool success = true;
+
+	for(size_t i = 0; i < inflight && success; ++i)
+	{
+		EvalPoolWorker *worker = &pool->workers[i];
+
+		worker->pool = pool;
+		worker->plan = eval_plan_new(root, predicates);
+
+		if(pthread_create(&worker->thread, NULL, _eval_pool_worker_main, worker))
+		{
+			perror("pthread_create()");
+			eval_plan_destroy(worker->plan);
+			success = false;
+		}
+		else
+		{
+			worker->started = true;
+			++pool->workers_count;
+		}
+	}
+
+	if(!success)
+	{
+		eval_pool_destroy(pool);
+		pool = NULL;
+	}
+
+	return pool;
+}
+
+void
+eval_pool_destroy(EvalPool *pool)
+{
+	if(pool)
+	{
+		DEBUG("eval", "Stopping worker threads.");
+
+		pthread_mutex_lock(&pool->mutex);
+		pool->quit = true;
+		pthread_cond_broadcast(&pool->job_cond);
+		pthread_mutex_unlock(&pool->mutex);
+
+		for(size_t i = 0; i < pool->workers_count; ++i)
+		{
+			pthread_join(pool->workers[i].thread, NULL);
+			eval_plan_destroy(pool->workers[i].plan);
+		}
+
+		for(uint64_t seq = pool->head; seq < pool->tail; ++seq)
+		{
+			file_info_unref(pool->slots[seq % pool->size].info);
+		}
+
+		pthread_cond_destroy(&pool->done_cond);
+		pthread_cond_destroy(&pool->job_cond);
+		pthread_mutex_destroy(&pool->mutex);
+
+		free(pool->workers);
+		free(pool->slots);
+		free(pool);
+	}
+}
+
+/* emits completed results at the front of the window, has to be called with locked mutex */
+static void
+_eval_pool_emit(EvalPool *pool, bool wait)
+{
+	assert(pool != NULL);
+
+	while(!pool->stopped && pool->head < pool->tail)
+	{
+		EvalPoolSlot *slot = &pool->slots[pool->head % pool->size];
+
+		if(!slot->done)
+		{
+			if(!wait)
+			{
+				break;
+			}
+
+			pthread_cond_wait(&pool->done_cond, &pool->mutex);
+		}
+		else
+		{
+			FileInfo *info = slot->info;
+			EvalResult result = slot->result;
+
+			slot->info = NULL;
+			slot->done = false;
+			++pool->head;
+
+			pthread_mutex_unlock(&pool->mutex);
+
+			bool stop = pool->cb(info, result, pool->user_data);
+
+			file_info_unref(info);
+
+			pthread_mutex_lock(&pool->mutex);
+
+			pool->stopped = stop;
+
+			/* a slot has been freed, only wait until the window has space */
+			wait = wait && pool->tail - pool->head >= pool->size;
+		}
+	}
+}
+
+bool
+eval_pool_submit(EvalPool *pool, FileInfo *info)
+{
+	assert(pool != NULL);
+	assert(info != NULL);
+
+	pthread_mutex_lock(&pool->mutex);
+
+	if(pool->tail - pool->head == pool->size)
+	{
+		_eval_pool_emit(pool, true);
+	}
+
+	if(!pool->stopped)
+	{
+		EvalPoolSlot *slot = &pool->slots[pool->tail++ % pool->size];
+
+		slot->info = file_info_ref(info);
+		slot->done = false;
+
+		pthread_cond_signal(&pool->job_cond);
+
+		_eval_pool_emit(pool, false);
+	}
+
+	bool success = !pool->stopped;
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	return success;
+}
+
+bool
+eval_pool_flush(EvalPool *pool)
+{
+	assert(pool != NULL);
+
+	TRACE("eval", "Waiting for in-flight files.");
+
+	pthread_mutex_lock(&pool->mutex);
+
+	while(!pool->stopped && pool->head < pool->tail)
+	{
+		_eval_pool_emit(pool, true);
+	}
+
+	bool success = !pool->stopped;
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	return success;
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file eval-pool.h
+   @brief Evaluate filter expressions of several files concurrently.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef EVAL_POOL_H
+#define EVAL_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "eval.h"
+#include "fileinfo.h"
+
+/**
+   @struct EvalPool
+   @brief A pool of worker threads evaluating a window of in-flight files.
+          Results are emitted in the order the files have been submitted.
+ */
+typedef struct _EvalPool EvalPool;
+
+/**
+   @typedef EvalPoolCallback
+   @brief Function called for each evaluated file in submission order. If the
+          callback returns true no further results are emitted.
+ */
+typedef bool (*EvalPoolCallback)(FileInfo *info, EvalResult result, void *user_data);
+
+/**
+   @param manager available extensions
+   @param root root node of a filter expression
+   @return true if all functions in the expression are reentrant
+
+   Tests if a filter expression can be evaluated concurrently.
+ */
+bool eval_pool_supports(const ExtensionManager *manager, const Node *root);
+
+/**
+   @param manager available extensions
+   @param root root node of a filter expression
+   @param predicates compiled conditions of the filter expression (may be NULL)
+   @param inflight maximum number of files evaluated at the same time
+   @param cb function called for each evaluated file
+   @param user_data user data passed to the callback
+   @return a new EvalPool or NULL on failure
+
+   Starts a pool of worker threads.
+ */
+EvalPool *eval_pool_new(ExtensionManager *manager, Node *root, const Predicates *predicates, size_t inflight, EvalPoolCallback cb, void *user_data);
+
+/**
+   @param pool EvalPool to destroy
+
+   Stops all worker threads and frees the pool. Pending results are dropped.
+ */
+void eval_pool_destroy(EvalPool *pool);
+
+/**
+   @param pool an EvalPool
+   @param info file to evaluate
+   @return false if the callback stopped processing
+
+   Submits a file to the pool. Blocks while the window of in-flight files is
+   full. Completed results at the front of the window are emitted.
+ */
+bool eval_pool_submit(EvalPool *pool, FileInfo *info);
+
+/**
+   @param pool an EvalPool
+   @return false if the callback stopped processing
+
+   Waits for all in-flight files and emits their results.
+ */
+bool eval_pool_flush(EvalPool *pool);
+
+#endif
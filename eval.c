@@ -20,12 +20,19 @@
    @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
 #include <assert.h>
 
 #include "eval.h"
 #include "log.h"
 #include "extension.h"
+#include "predicate.h"
 #include "gettext.h"
+#include "utils.h"
 
 /*! @cond INTERNAL */
 #define FN_STACK_SIZE 64
@@ -33,8 +40,60 @@
 typedef struct
 {
 	const char *filename;
+	FileInfo *info;
 	ExtensionManager *extensions;
+	EvalPlan *plan;
 } EvalContext;
+
+#define EVAL_PLAN_FIRST_INTERVAL 8
+#define EVAL_PLAN_MAX_INTERVAL   4096
+
+typedef struct _EvalChain EvalChain;
+
+typedef struct
+{
+	Node *node;
+	EvalChain *chain;
+	bool negate;
+	uint64_t calls;
+	uint64_t hits;
+	uint64_t nsecs;
+} EvalOperand;
+
+struct _EvalChain
+{
+	OperatorType op;
+	EvalOperand *operands;
+	size_t count;
+	uint64_t evaluations;
+	uint64_t interval;
+	uint64_t next_plan;
+};
+
+typedef struct
+{
+	uint64_t generation;
+	int result;
+} EvalMemo;
+
+typedef struct
+{
+	FuncNode *node;
+	size_t slot;
+} EvalFuncRef;
+
+struct _EvalPlan
+{
+	EvalOperand root;
+	const Predicates *predicates;
+	/* function calls sorted by node, each mapped to its memo slot */
+	EvalFuncRef *funcs;
+	size_t funcs_count;
+	size_t funcs_size;
+	EvalMemo *memos;
+	size_t memos_count;
+	uint64_t generation;
+};
 /*! @endcond */
 
 static EvalResult _eval_node(Node *node, EvalContext *ctx);
@@ -158,7 +217,7 @@ _eval_build_args_from_node(EvalContext *ctx, FuncNode *fn, int *argc, ExtensionC
 }
 
 static bool
-_eval_func_node(Node *node, EvalContext *ctx, int *fn_result)
+_eval_invoke_func_node(Node *node, EvalContext *ctx, int *fn_result)
 {
 	bool success = false;
 
@@ -200,6 +259,70 @@ _eval_func_node(Node *node, EvalContext *ctx, int *fn_result)
 	return success;
 }
 
+static int
+_eval_compare_func_refs(const void *a, const void *b)
+{
+	const FuncNode *na = ((const EvalFuncRef *)a)->node;
+	const FuncNode *nb = ((const EvalFuncRef *)b)->node;
+
+	return (na > nb) - (na < nb);
+}
+
+static EvalMemo *
+_eval_plan_find_memo(EvalPlan *plan, const FuncNode *node)
+{
+	EvalMemo *memo = NULL;
+	EvalFuncRef key;
+	EvalFuncRef *ref = NULL;
+
+	assert(plan != NULL);
+	assert(node != NULL);
+
+	key.node = (FuncNode *)node;
+	key.slot = 0;
+
+	if(plan->funcs_count)
+	{
+		ref = bsearch(&key, plan->funcs, plan->funcs_count, sizeof(EvalFuncRef), _eval_compare_func_refs);
+	}
+
+	if(ref)
+	{
+		memo = &plan->memos[ref->slot];
+	}
+
+	return memo;
+}
+
+static bool
+_eval_func_node(Node *node, EvalContext *ctx, int *fn_result)
+{
+	bool success = true;
+	EvalMemo *memo = NULL;
+
+	assert(node != NULL);
+	assert(ctx != NULL);
+	assert(fn_result != NULL);
+
+	if(ctx->plan)
+	{
+		memo = _eval_plan_find_memo(ctx->plan, (FuncNode *)node);
+	}
+
+	if(memo && memo->generation == ctx->plan->generation)
+	{
+		TRACEF("eval", "Found memoized result of function `%s': %d", ((FuncNode *)node)->name, memo->result);
+		*fn_result = memo->result;
+	}
+	else if((success = _eval_invoke_func_node(node, ctx, fn_result)) && memo)
+	{
+		memo->generation = ctx->plan->generation;
+		memo->result = *fn_result;
+	}
+
+	return success;
+}
+
 static EvalResult
 _eval_expression_node(Node *node, EvalContext *ctx)
 {
@@ -370,6 +493,31 @@ _eval_not_node(Node *node, EvalContext *ctx)
 	return result;
 }
 
+static EvalResult
+_eval_predicate_node(Node *node, EvalContext *ctx)
+{
+	EvalResult result = EVAL_RESULT_ABORTED;
+
+	assert(node != NULL);
+	assert(ctx != NULL);
+
+	if(ctx->plan && ctx->plan->predicates && ctx->info)
+	{
+		bool matches;
+
+		if(predicates_test(ctx->plan->predicates, node, ctx->info, &matches))
+		{
+			result = matches ? EVAL_RESULT_TRUE : EVAL_RESULT_FALSE;
+		}
+	}
+	else
+	{
+		FATALF("eval", "Couldn't evaluate node of type %#x, no conditions compiled.", node->type);
+	}
+
+	return result;
+}
+
 static EvalResult
 _eval_node(Node *node, EvalContext *ctx)
 {
@@ -394,6 +542,12 @@ _eval_node(Node *node, EvalContext *ctx)
 				result = _eval_not_node(node, ctx);
 				break;
 
+			case NODE_TRUE:
+			case NODE_VALUE:
+			case NODE_CONDITION:
+				result = _eval_predicate_node(node, ctx);
+				break;
+
 			default:
 				FATALF("eval", "Unexpected node type: %#x", node->type);
 		}
@@ -425,3 +579,436 @@ evaluate(ExtensionManager *manager, Node *node, const char *filename)
 	return _eval_node(node, &ctx);
 }
 
+
+/*
+ *	adaptive evaluation:
+ */
+static void _eval_operand_init(EvalOperand *operand, Node *node);
+
+static void _eval_operand_free(EvalOperand *operand);
+
+static size_t
+_eval_chain_count_operands(const Node *node, OperatorType op)
+{
+	size_t count = 1;
+
+	assert(node != NULL);
+
+	if(node->type == NODE_EXPRESSION && ((ExpressionNode *)node)->op == op)
+	{
+		count = _eval_chain_count_operands(((ExpressionNode *)node)->first, op)
+		        + _eval_chain_count_operands(((ExpressionNode *)node)->second, op);
+	}
+
+	return count;
+}
+
+static void
+_eval_chain_collect_operands(EvalChain *chain, Node *node)
+{
+	assert(chain != NULL);
+	assert(node != NULL);
+
+	if(node->type == NODE_EXPRESSION && ((ExpressionNode *)node)->op == chain->op)
+	{
+		_eval_chain_collect_operands(chain, ((ExpressionNode *)node)->first);
+		_eval_chain_collect_operands(chain, ((ExpressionNode *)node)->second);
+	}
+	else
+	{
+		_eval_operand_init(&chain->operands[chain->count++], node);
+	}
+}
+
+static EvalChain *
+_eval_chain_new(ExpressionNode *node)
+{
+	assert(node != NULL);
+	assert(node->op == OP_AND || node->op == OP_OR);
+
+	EvalChain *chain = utils_new(1, EvalChain);
+
+	chain->op = node->op;
+	chain->operands = utils_new(_eval_chain_count_operands((Node *)node, node->op), EvalOperand);
+	chain->interval = EVAL_PLAN_FIRST_INTERVAL;
+	chain->next_plan = EVAL_PLAN_FIRST_INTERVAL;
+
+	_eval_chain_collect_operands(chain, (Node *)node);
+
+	TRACEF("eval", "Created chain with %zu operands (op=%#x).", chain->count, chain->op);
+
+	return chain;
+}
+
+static void
+_eval_chain_destroy(EvalChain *chain)
+{
+	assert(chain != NULL);
+
+	for(size_t i = 0; i < chain->count; ++i)
+	{
+		_eval_operand_free(&chain->operands[i]);
+	}
+
+	free(chain->operands);
+	free(chain);
+}
+
+static void
+_eval_operand_init(EvalOperand *operand, Node *node)
+{
+	assert(operand != NULL);
+	assert(node != NULL);
+
+	memset(operand, 0, sizeof(EvalOperand));
+
+	while(node->type == NODE_NOT)
+	{
+		operand->negate = !operand->negate;
+		node = ((NotNode *)node)->expr;
+	}
+
+	if(node->type == NODE_EXPRESSION
+	   && (((ExpressionNode *)node)->op == OP_AND || ((ExpressionNode *)node)->op == OP_OR))
+	{
+		operand->chain = _eval_chain_new((ExpressionNode *)node);
+	}
+	else
+	{
+		operand->node = node;
+	}
+}
+
+static void
+_eval_operand_free(EvalOperand *operand)
+{
+	assert(operand != NULL);
+
+	if(operand->chain)
+	{
+		_eval_chain_destroy(operand->chain);
+	}
+}
+
+static double
+_eval_operand_rank(const EvalOperand *operand, OperatorType op)
+{
+	double rank = 0.0;
+
+	assert(operand != NULL);
+
+	/* operands without statistics are moved to the front to get sampled */
+	if(operand->calls)
+	{
+		double cost = (double)operand->nsecs / operand->calls;
+		double p = (operand->hits + 1.0) / (operand->calls + 2.0);
+
+		rank = cost / ((op == OP_AND) ? (1.0 - p) : p);
+	}
+
+	return rank;
+}
+
+static void
+_eval_chain_plan(EvalChain *chain)
+{
+	assert(chain != NULL);
+
+	DEBUGF("eval", "Re-planning chain with %zu operands after %" PRIu64 " evaluations.", chain->count, chain->evaluations);
+
+	double *ranks = utils_new(chain->count, double);
+
+	for(size_t i = 0; i < chain->count; ++i)
+	{
+		ranks[i] = _eval_operand_rank(&chain->operands[i], chain->op);
+
+		TRACEF("eval", "Operand %zu: calls=%" PRIu64 ", hits=%" PRIu64 ", nsecs=%" PRIu64 ", rank=%f",
+		       i, chain->operands[i].calls, chain->operands[i].hits, chain->operands[i].nsecs, ranks[i]);
+	}
+
+	/* stable insertion sort, operand lists are short */
+	for(size_t i = 1; i < chain->count; ++i)
+	{
+		EvalOperand operand = chain->operands[i];
+		double rank = ranks[i];
+		size_t j = i;
+
+		while(j > 0 && ranks[j - 1] > rank)
+		{
+			chain->operands[j] = chain->operands[j - 1];
+			ranks[j] = ranks[j - 1];
+			--j;
+		}
+
+		chain->operands[j] = operand;
+		ranks[j] = rank;
+	}
+
+	free(ranks);
+
+	if(chain->interval < EVAL_PLAN_MAX_INTERVAL)
+	{
+		chain->interval *= 2;
+	}
+
+	chain->next_plan = chain->evaluations + chain->interval;
+}
+
+static EvalResult _eval_chain(EvalChain *chain, EvalContext *ctx);
+
+static uint64_t
+_eval_timespec_diff(const struct timespec *begin, const struct timespec *end)
+{
+	assert(begin != NULL);
+	assert(end != NULL);
+
+	return (end->tv_sec - begin->tv_sec) * 1000000000ULL + end->tv_nsec - begin->tv_nsec;
+}
+
+static EvalResult
+_eval_operand(EvalOperand *operand, EvalContext *ctx)
+{
+	EvalResult result;
+	struct timespec begin, end;
+
+	assert(operand != NULL);
+	assert(ctx != NULL);
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+
+	result = operand->chain ? _eval_chain(operand->chain, ctx) : _eval_node(operand->node, ctx);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	if(operand->negate && result != EVAL_RESULT_ABORTED)
+	{
+		result = (result == EVAL_RESULT_TRUE) ? EVAL_RESULT_FALSE : EVAL_RESULT_TRUE;
+	}
+
+	++operand->calls;
+	operand->nsecs += _eval_timespec_diff(&begin, &end);
+
+	if(result == EVAL_RESULT_TRUE)
+	{
+		++operand->hits;
+	}
+
+	return result;
+}
+
+static EvalResult
+_eval_chain(EvalChain *chain, EvalContext *ctx)
+{
+	assert(chain != NULL);
+	assert(ctx != NULL);
+
+	EvalResult proceed = (chain->op == OP_AND) ? EVAL_RESULT_TRUE : EVAL_RESULT_FALSE;
+	EvalResult result = proceed;
+
+	for(size_t i = 0; i < chain->count && result == proceed; ++i)
+	{
+		result = _eval_operand(&chain->operands[i], ctx);
+	}
+
+	if(++chain->evaluations == chain->next_plan)
+	{
+		_eval_chain_plan(chain);
+	}
+
+	return result;
+}
+
+/*
+ *	common subexpressions:
+ */
+static bool
+_eval_node_equals(const Node *a, const Node *b)
+{
+	bool equals = false;
+
+	assert(a != NULL);
+	assert(b != NULL);
+
+	if(a->type == b->type)
+	{
+		if(a->type == NODE_VALUE)
+		{
+			const ValueNode *va = (ValueNode *)a;
+			const ValueNode *vb = (ValueNode *)b;
+
+			if(va->vtype == vb->vtype)
+			{
+				equals = (va->vtype == VALUE_STRING) ? !strcmp(va->value.svalue, vb->value.svalue)
+				                                     : va->value.ivalue == vb->value.ivalue;
+			}
+		}
+		else if(a->type == NODE_FUNC)
+		{
+			const FuncNode *fa = (FuncNode *)a;
+			const FuncNode *fb = (FuncNode *)b;
+
+			if(!strcmp(fa->name, fb->name))
+			{
+				equals = (fa->args && fb->args) ? _eval_node_equals(fa->args, fb->args) : fa->args == fb->args;
+			}
+		}
+		else if(a->type == NODE_EXPRESSION)
+		{
+			const ExpressionNode *ea = (ExpressionNode *)a;
+			const ExpressionNode *eb = (ExpressionNode *)b;
+
+			equals = ea->op == eb->op
+			         && _eval_node_equals(ea->first, eb->first)
+			         && _eval_node_equals(ea->second, eb->second);
+		}
+	}
+
+	return equals;
+}
+
+static void
+_eval_plan_register_func(EvalPlan *plan, FuncNode *node)
+{
+	assert(plan != NULL);
+	assert(node != NULL);
+
+	size_t slot = plan->memos_count;
+
+	for(size_t i = 0; i < plan->funcs_count && slot == plan->memos_count; ++i)
+	{
+		if(_eval_node_equals((Node *)plan->funcs[i].node, (Node *)node))
+		{
+			DEBUGF("eval", "Function call `%s' occurs more than once, sharing memoized result.", node->name);
+			slot = plan->funcs[i].slot;
+		}
+	}
+
+	if(slot == plan->memos_count)
+	{
+		++plan->memos_count;
+	}
+
+	if(plan->funcs_count == plan->funcs_size)
+	{
+		plan->funcs_size = plan->funcs_size ? plan->funcs_size * 2 : 8;
+
+		if(plan->funcs)
+		{
+			plan->funcs = utils_renew(plan->funcs, plan->funcs_size, EvalFuncRef);
+		}
+		else
+		{
+			plan->funcs = utils_new(plan->funcs_size, EvalFuncRef);
+		}
+	}
+
+	plan->funcs[plan->funcs_count].node = node;
+	plan->funcs[plan->funcs_count].slot = slot;
+	++plan->funcs_count;
+}
+
+static void
+_eval_plan_collect_funcs(EvalPlan *plan, Node *node)
+{
+	assert(plan != NULL);
+
+	if(node)
+	{
+		switch(node->type)
+		{
+			case NODE_FUNC:
+				_eval_plan_register_func(plan, (FuncNode *)node);
+				_eval_plan_collect_funcs(plan, ((FuncNode *)node)->args);
+				break;
+
+			case NODE_EXPRESSION:
+				_eval_plan_collect_funcs(plan, ((ExpressionNode *)node)->first);
+				_eval_plan_collect_funcs(plan, ((ExpressionNode *)node)->second);
+				break;
+
+			case NODE_COMPARE:
+				_eval_plan_collect_funcs(plan, ((CompareNode *)node)->first);
+				_eval_plan_collect_funcs(plan, ((CompareNode *)node)->second);
+				break;
+
+			case NODE_NOT:
+				_eval_plan_collect_funcs(plan, ((NotNode *)node)->expr);
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+static void
+_eval_plan_init_memos(EvalPlan *plan, Node *root)
+{
+	assert(plan != NULL);
+	assert(root != NULL);
+
+	_eval_plan_collect_funcs(plan, root);
+
+	TRACEF("eval", "Found %zu function calls, %zu distinct.", plan->funcs_count, plan->memos_count);
+
+	plan->memos = utils_new(plan->memos_count ? plan->memos_count : 1, EvalMemo);
+
+	/* the evaluator looks up the memo slot of each call it invokes */
+	if(plan->funcs_count)
+	{
+		qsort(plan->funcs, plan->funcs_count, sizeof(EvalFuncRef), _eval_compare_func_refs);
+	}
+}
+
+EvalPlan *
+eval_plan_new(Node *root, const Predicates *predicates)
+{
+	assert(root != NULL);
+
+	TRACE("eval", "Creating evaluation plan.");
+
+	EvalPlan *plan = utils_new(1, EvalPlan);
+
+	plan->predicates = predicates;
+
+	_eval_operand_init(&plan->root, root);
+	_eval_plan_init_memos(plan, root);
+
+	return plan;
+}
+
+void
+eval_plan_destroy(EvalPlan *plan)
+{
+	if(plan)
+	{
+		_eval_operand_free(&plan->root);
+		free(plan->funcs);
+		free(plan->memos);
+		free(plan);
+	}
+}
+
+EvalResult
+eval_plan_evaluate(EvalPlan *plan, ExtensionManager *manager, FileInfo *info)
+{
+	assert(plan != NULL);
+	assert(manager != NULL);
+	assert(info != NULL);
+
+	TRACE("eval", "Evaluating syntax tree.");
+
+	EvalContext ctx;
+
+	memset(&ctx, 0, sizeof(EvalContext));
+
+	ctx.extensions = manager;
+	ctx.filename = info->path;
+	ctx.info = info;
+	ctx.plan = plan;
+
+	/* invalidate memoized function results of the previous file */
+	++plan->generation;
+
+	return _eval_operand(&plan->root, &ctx);
+}
@@ -24,6 +24,8 @@
 
 #include "ast.h"
 #include "extension.h"
+#include "predicate.h"
+#include "fileinfo.h"
 
 /**
    @enum EvalResult
@@ -39,6 +41,13 @@ typedef enum
 	EVAL_RESULT_ABORTED
 } EvalResult;
 
+/**
+   @struct EvalPlan
+   @brief Evaluates a filter expression and reorders the operands of "and"
+          and "or" operators by their observed cost and selectivity.
+ */
+typedef struct _EvalPlan EvalPlan;
+
 /**
    @param manager available extensions
    @param node node to evaluate
@@ -49,5 +58,37 @@ typedef enum
  */
 EvalResult evaluate(ExtensionManager *manager, Node *node, const char *filename);
 
+/**
+   @param root root node of a filter expression
+   @param predicates compiled conditions of the filter expression (may be NULL)
+   @return a new EvalPlan
+
+   Creates an EvalPlan from a filter expression. The plan references the
+   nodes of the given tree and the compiled conditions, which must not be
+   freed before the plan.
+ */
+EvalPlan *eval_plan_new(Node *root, const Predicates *predicates);
+
+/**
+   @param plan EvalPlan to destroy
+
+   Frees an EvalPlan.
+ */
+void eval_plan_destroy(EvalPlan *plan);
+
+/**
+   @param plan an EvalPlan
+   @param manager available extensions
+   @param info the found file
+   @return the evaluation result
+
+   Evaluates a filter expression. Conditions are tested in-process, results
+   of identical function calls are memoized while a file is evaluated. The
+   plan measures mean latency and probability of true of each operand and
+   periodically moves cheap and selective operands to the front. Intervals
+   between re-planning grow as statistics settle.
+ */
+EvalResult eval_plan_evaluate(EvalPlan *plan, ExtensionManager *manager, FileInfo *info);
+
 #endif
 
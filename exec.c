@@ -38,8 +38,8 @@ typedef struct
 {
 	Processor padding;
 	int32_t flags;
-	const char *dir;
-	const char *path;
+	FILE *out;
+	FileInfo *info;
 	const ExecArgs *args;
 	FormatParserResult **formats;
 	char **argv;
@@ -49,14 +49,14 @@ typedef struct
 } ExecProcessor;
 /*! @endcond */
 
-static const char *
+static FileInfo *
 _exec_processor_read(Processor *processor)
 {
 	assert(processor != NULL);
 
 	processor->flags &= ~PROCESSOR_FLAG_READABLE;
 
-	return ((ExecProcessor *)processor)->path;
+	return ((ExecProcessor *)processor)->info;
 }
 
 static bool
@@ -86,7 +86,7 @@ _exec_build_argv(ExecProcessor *processor)
 		}
 		else
 		{
-			success = format_write(processor->formats[i], processor->dir, processor->path, processor->fp);
+			success = format_write(processor->formats[i], processor->info, processor->fp);
 		}
 
 		if(success)
@@ -135,6 +135,8 @@ _exec_fork(ExecProcessor *processor)
 	{
 		DEBUGF("exec", "Argument list built successfully, forking and running `%s'.", processor->args->path);
 
+		fflush(processor->out);
+
 		pid_t pid = fork();
 
 		if(pid == -1)
@@ -144,7 +146,11 @@ _exec_fork(ExecProcessor *processor)
 		}
 		else if(pid == 0)
 		{
-			if(execvp(processor->args->path, processor->argv) == -1)
+			if(processor->out != stdout && dup2(fileno(processor->out), STDOUT_FILENO) == -1)
+			{
+				perror("dup2()");
+			}
+			else if(execvp(processor->args->path, processor->argv) == -1)
 			{
 				perror(processor->args->path);
 			}
@@ -178,17 +184,15 @@ _exec_fork(ExecProcessor *processor)
 }
 
 static void
-_exec_processor_write(Processor *processor, const char *dir, const char *path)
+_exec_processor_write(Processor *processor, FileInfo *info)
 {
 	assert(processor != NULL);
-	assert(dir != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	ExecProcessor *exec = (ExecProcessor *)processor;
 
 	processor->flags |= PROCESSOR_FLAG_READABLE;
-	exec->dir = dir;
-	exec->path = path;
+	exec->info = info;
 
 	if(_exec_fork(exec) && !(exec->flags & EXEC_FLAG_IGNORE_ERROR))
 	{
@@ -316,11 +320,12 @@ _exec_processor_parse_args(const ExecArgs *args, FormatParserResult ***formats)
 }
 
 Processor *
-exec_processor_new(const ExecArgs *args, int32_t flags)
+exec_processor_new(const ExecArgs *args, int32_t flags, FILE *out)
 {
 	Processor *processor = NULL;
 
 	assert(args != NULL);
+	assert(out != NULL);
 
 	if(args->argc < SIZE_MAX - 2)
 	{
@@ -339,6 +344,7 @@ exec_processor_new(const ExecArgs *args, int32_t flags)
 			ExecProcessor *exec = (ExecProcessor *)processor;
 
 			exec->flags = flags;
+			exec->out = out;
 			exec->args = args;
 			exec->argv = utils_new(args->argc + 2, char *); // path + arguments + NULL
 			exec->formats = formats;
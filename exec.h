@@ -24,6 +24,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "processor.h"
 #include "exec-args.h"
@@ -43,12 +44,13 @@ typedef enum
 /**
    @param args command and arguments to execute
    @param flags execution flags
+   @param out stream the command's standard output is redirected to
    @return a new Processor
 
    Excecutes a shell command. If the EXEC_FLAG_IGNORE_ERROR is not set
    the processor stops if the commands exits with non-zero value.
  */
-Processor *exec_processor_new(const ExecArgs *args, int32_t flags);
+Processor *exec_processor_new(const ExecArgs *args, int32_t flags, FILE *out);
 
 #endif
 
@@ -0,0 +1,423 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file ext-cache.c
+   @brief Persistent cache for results of pure extension functions.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <pthread.h>
+#include <assert.h>
+
+#include "ext-cache.h"
+#include "log.h"
+#include "utils.h"
+#include "gettext.h"
+
+/*! @cond INTERNAL */
+#define EXT_CACHE_MAGIC    "EFNC"
+#define EXT_CACHE_VERSION  1
+#define EXT_CACHE_CAPACITY (1 << 19)
+#define EXT_CACHE_MAX_PROBES 64
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME        1099511628211ULL
+
+typedef struct
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t capacity;
+	uint32_t probes;
+	uint8_t reserved[44];
+} ExtensionCacheHeader;
+
+typedef struct
+{
+	uint64_t key;
+	uint64_t dev;
+	uint64_t ino;
+	int64_t mtime_sec;
+	int64_t mtime_nsec;
+	int64_t size;
+	int32_t result;
+	uint32_t used;
+} ExtensionCacheSlot;
+
+struct _ExtensionCache
+{
+	pthread_mutex_t mutex;
+	int fd;
+	size_t size;
+	ExtensionCacheHeader *header;
+	ExtensionCacheSlot *slots;
+};
+/*! @endcond */
+
+static uint64_t
+_ext_cache_hash(uint64_t hash, const void *data, size_t len)
+{
+	const uint8_t *ptr = data;
+
+	for(size_t i = 0; i < len; ++i)
+	{
+		hash ^= ptr[i];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static size_t
+_ext_cache_file_size(uint64_t capacity)
+{
+	return sizeof(ExtensionCacheHeader) + capacity * sizeof(ExtensionCacheSlot);
+}
+
+static uint64_t
+_ext_cache_round_capacity(size_t capacity)
+{
+	uint64_t result = 1;
+
+	while(result < capacity)
+	{
+		result <<= 1;
+	}
+
+	return result;
+}
+
+static uint32_t
+_ext_cache_probes(uint64_t capacity)
+{
+	uint32_t probes = 1;
+
+	/* probe sequences grow with the logarithm of the table size, 2^19 slots are probed 16 times */
+	while(capacity > 16 && probes < EXT_CACHE_MAX_PROBES)
+	{
+		capacity >>= 1;
+		++probes;
+	}
+
+	return probes;
+}
+
+static bool
+_ext_cache_init_file(int fd, size_t capacity)
+{
+	ExtensionCacheHeader header;
+	bool success = false;
+
+	memset(&header, 0, sizeof(ExtensionCacheHeader));
+	memcpy(header.magic, EXT_CACHE_MAGIC, sizeof(header.magic));
+	header.version = EXT_CACHE_VERSION;
+	header.capacity = _ext_cache_round_capacity(capacity ? capacity : EXT_CACHE_CAPACITY);
+	header.probes = _ext_cache_probes(header.capacity);
+
+	TRACEF("cache", "Initializing cache file (capacity=%" PRIu64 ", probes=%" PRIu32 ").", header.capacity, header.probes);
+
+	if(ftruncate(fd, _ext_cache_file_size(header.capacity)))
+	{
+		perror("ftruncate()");
+	}
+	else if(pwrite(fd, &header, sizeof(ExtensionCacheHeader), 0) != sizeof(ExtensionCacheHeader))
+	{
+		perror("pwrite()");
+	}
+	else
+	{
+		success = true;
+	}
+
+	return success;
+}
+
+static bool
+_ext_cache_prepare_file(int fd, size_t capacity, size_t *size)
+{
+	struct stat st;
+	bool success = false;
+
+	assert(size != NULL);
+
+	flock(fd, LOCK_EX);
+
+	if(fstat(fd, &st))
+	{
+		perror("fstat()");
+	}
+	else if(!st.st_size)
+	{
+		success = _ext_cache_init_file(fd, capacity);
+	}
+	else
+	{
+		success = true;
+	}
+
+	flock(fd, LOCK_UN);
+
+	if(success)
+	{
+		success = !fstat(fd, &st);
+		*size = st.st_size;
+	}
+
+	return success;
+}
+
+static bool
+_ext_cache_validate_header(const ExtensionCacheHeader *header, size_t size)
+{
+	assert(header != NULL);
+
+	return !memcmp(header->magic, EXT_CACHE_MAGIC, sizeof(header->magic))
+	       && header->version == EXT_CACHE_VERSION
+	       && header->capacity
+	       && !(header->capacity & (header->capacity - 1))
+	       && header->probes && header->probes <= header->capacity
+	       && _ext_cache_file_size(header->capacity) == size;
+}
+
+ExtensionCache *
+ext_cache_open(const char *filename, size_t capacity)
+{
+	ExtensionCache *cache = NULL;
+	size_t size = 0;
+	int fd;
+
+	assert(filename != NULL);
+
+	DEBUGF("cache", "Opening cache file: %s", filename);
+
+	if((fd = open(filename, O_RDWR | O_CREAT | O_CLOEXEC, 0600)) == -1)
+	{
+		fprintf(stderr, _("Couldn't open cache file: %s\n"), filename);
+		perror("open()");
+	}
+	else if(_ext_cache_prepare_file(fd, capacity, &size) && size >= sizeof(ExtensionCacheHeader))
+	{
+		void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+		if(ptr == MAP_FAILED)
+		{
+			perror("mmap()");
+		}
+		else if(!_ext_cache_validate_header(ptr, size))
+		{
+			fprintf(stderr, _("Invalid cache file: %s\n"), filename);
+			munmap(ptr, size);
+		}
+		else
+		{
+			cache = utils_new(1, ExtensionCache);
+
+			pthread_mutex_init(&cache->mutex, NULL);
+			cache->fd = fd;
+			cache->size = size;
+			cache->header = ptr;
+			cache->slots = (ExtensionCacheSlot *)((char *)ptr + sizeof(ExtensionCacheHeader));
+		}
+	}
+
+	if(!cache && fd != -1)
+	{
+		close(fd);
+	}
+
+	return cache;
+}
+
+void
+ext_cache_close(ExtensionCache *cache)
+{
+	if(cache)
+	{
+		TRACE("cache", "Closing cache file.");
+
+		munmap(cache->header, cache->size);
+		close(cache->fd);
+		pthread_mutex_destroy(&cache->mutex);
+		free(cache);
+	}
+}
+
+uint64_t
+ext_cache_module_stamp(const char *filename)
+{
+	struct stat st;
+
+	assert(filename != NULL);
+
+	uint64_t stamp = _ext_cache_hash(FNV_OFFSET_BASIS, filename, strlen(filename) + 1);
+
+	if(!stat(filename, &st))
+	{
+		stamp = _ext_cache_hash(stamp, &st.st_mtim.tv_sec, sizeof(st.st_mtim.tv_sec));
+		stamp = _ext_cache_hash(stamp, &st.st_mtim.tv_nsec, sizeof(st.st_mtim.tv_nsec));
+		stamp = _ext_cache_hash(stamp, &st.st_size, sizeof(st.st_size));
+	}
+	else
+	{
+		WARNINGF("cache", "Couldn't stat module `%s', errno=%d.", filename, errno);
+	}
+
+	return stamp;
+}
+
+uint64_t
+ext_cache_key(uint64_t stamp, const char *name, uint32_t argc, const CallbackArgType *types, void *argv[])
+{
+	assert(name != NULL);
+
+	uint64_t hash = _ext_cache_hash(stamp, name, strlen(name) + 1);
+
+	for(uint32_t i = 0; i < argc; ++i)
+	{
+		hash = _ext_cache_hash(hash, &types[i], sizeof(CallbackArgType));
+
+		if(types[i] == CALLBACK_ARG_TYPE_STRING)
+		{
+			hash = _ext_cache_hash(hash, argv[i], strlen(argv[i]) + 1);
+		}
+		else
+		{
+			hash = _ext_cache_hash(hash, argv[i], sizeof(int32_t));
+		}
+	}
+
+	return hash;
+}
+
+static size_t
+_ext_cache_home_slot(const ExtensionCache *cache, const struct stat *st, uint64_t key)
+{
+	uint64_t hash = key;
+
+	hash = _ext_cache_hash(hash, &st->st_dev, sizeof(st->st_dev));
+	hash = _ext_cache_hash(hash, &st->st_ino, sizeof(st->st_ino));
+
+	return hash & (cache->header->capacity - 1);
+}
+
+static bool
+_ext_cache_slot_matches(const ExtensionCacheSlot *slot, const struct stat *st, uint64_t key)
+{
+	return slot->used && slot->key == key && slot->dev == (uint64_t)st->st_dev && slot->ino == (uint64_t)st->st_ino;
+}
+
+static bool
+_ext_cache_slot_is_valid(const ExtensionCacheSlot *slot, const struct stat *st)
+{
+	return slot->mtime_sec == st->st_mtim.tv_sec
+	       && slot->mtime_nsec == st->st_mtim.tv_nsec
+	       && slot->size == st->st_size;
+}
+
+bool
+ext_cache_lookup(ExtensionCache *cache, const struct stat *st, uint64_t key, int *result)
+{
+	bool found = false;
+	bool done = false;
+
+	assert(cache != NULL);
+	assert(st != NULL);
+	assert(result != NULL);
+
+	size_t index = _ext_cache_home_slot(cache, st, key);
+
+	/* flock() doesn't synchronize threads sharing the same descriptor */
+	pthread_mutex_lock(&cache->mutex);
+	flock(cache->fd, LOCK_SH);
+
+	for(size_t i = 0; i < cache->header->probes && !done; ++i)
+	{
+		const ExtensionCacheSlot *slot = &cache->slots[(index + i) & (cache->header->capacity - 1)];
+
+		if(!slot->used)
+		{
+			done = true;
+		}
+		else if(_ext_cache_slot_matches(slot, st, key))
+		{
+			done = true;
+
+			if(_ext_cache_slot_is_valid(slot, st))
+			{
+				*result = slot->result;
+				found = true;
+			}
+		}
+	}
+
+	flock(cache->fd, LOCK_UN);
+	pthread_mutex_unlock(&cache->mutex);
+
+	TRACEF("cache", "Cache lookup (key=%#" PRIx64 "): %s", key, found ? "hit" : "miss");
+
+	return found;
+}
+
+void
+ext_cache_store(ExtensionCache *cache, const struct stat *st, uint64_t key, int result)
+{
+	ExtensionCacheSlot *slot = NULL;
+
+	assert(cache != NULL);
+	assert(st != NULL);
+
+	size_t index = _ext_cache_home_slot(cache, st, key);
+
+	pthread_mutex_lock(&cache->mutex);
+	flock(cache->fd, LOCK_EX);
+
+	for(size_t i = 0; i < cache->header->probes && !slot; ++i)
+	{
+		ExtensionCacheSlot *candidate = &cache->slots[(index + i) & (cache->header->capacity - 1)];
+
+		if(!candidate->used || _ext_cache_slot_matches(candidate, st, key))
+		{
+			slot = candidate;
+		}
+	}
+
+	if(!slot)
+	{
+		TRACE("cache", "No free slot found, replacing entry at home slot.");
+		slot = &cache->slots[index];
+	}
+
+	slot->key = key;
+	slot->dev = st->st_dev;
+	slot->ino = st->st_ino;
+	slot->mtime_sec = st->st_mtim.tv_sec;
+	slot->mtime_nsec = st->st_mtim.tv_nsec;
+	slot->size = st->st_size;
+	slot->result = result;
+	slot->used = 1;
+
+	flock(cache->fd, LOCK_UN);
+	pthread_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file ext-cache.h
+   @brief Persistent cache for results of pure extension functions.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef EXT_CACHE_H
+#define EXT_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "extension-interface.h"
+
+/**
+   @struct ExtensionCache
+   @brief A memory-mapped hash table storing results of extension functions.
+          Entries are keyed by device, inode, modification time and size of
+          a file and a hash of the module, the function name and its arguments.
+ */
+typedef struct _ExtensionCache ExtensionCache;
+
+/**
+   @param filename location of the cache file
+   @param capacity number of entries of a new cache file, 0 for the default size
+   @return a new ExtensionCache or NULL on failure
+
+   Opens a cache file. The file is created if it doesn't exist. The capacity is
+   rounded up to a power of two, existing files keep the capacity stored in
+   their header.
+ */
+ExtensionCache *ext_cache_open(const char *filename, size_t capacity);
+
+/**
+   @param cache ExtensionCache to close
+
+   Unmaps and closes a cache file.
+ */
+void ext_cache_close(ExtensionCache *cache);
+
+/**
+   @param filename path of an extension module
+   @return a hash value
+
+   Computes a version stamp from the path, modification time and size of an
+   extension module.
+ */
+uint64_t ext_cache_module_stamp(const char *filename);
+
+/**
+   @param stamp version stamp of the module providing the function
+   @param name function name
+   @param argc number of function arguments
+   @param types argument data types
+   @param argv function arguments
+   @return a hash value
+
+   Computes the hash of a function call. Results of a modified module don't
+   match previously stored entries.
+ */
+uint64_t ext_cache_key(uint64_t stamp, const char *name, uint32_t argc, const CallbackArgType *types, void *argv[]);
+
+/**
+   @param cache an ExtensionCache
+   @param st status of the file the function is applied to
+   @param key hash value of the function call
+   @param result location to store the cached result
+   @return true if a valid entry has been found
+
+   Looks up the cached result of a function call. Entries of modified files
+   are ignored.
+ */
+bool ext_cache_lookup(ExtensionCache *cache, const struct stat *st, uint64_t key, int *result);
+
+/**
+   @param cache an ExtensionCache
+   @param st status of the file the function has been applied to
+   @param key hash value of the function call
+   @param result result to store
+
+   Stores the result of a function call. If all probed slots are occupied
+   by other entries the entry at the home slot is replaced.
+ */
+void ext_cache_store(ExtensionCache *cache, const struct stat *st, uint64_t key, int result);
+
+#endif
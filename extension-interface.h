@@ -47,6 +47,24 @@ typedef void(*RegisterExtension)(RegistrationCtx *ctx, const char *name, const c
  */
 typedef void(*RegisterCallback)(RegistrationCtx *ctx, const char *name, uint32_t argc, ...);
 
+/**
+   @param ctx registration context
+   @param name name of a registered function
+
+   Marks a function as pure. The result of a pure function depends only on
+   the file content and the function arguments, so it may be cached.
+ */
+typedef void(*MarkPure)(RegistrationCtx *ctx, const char *name);
+
+/**
+   @param ctx registration context
+   @param name name of a registered function
+
+   Marks a function as reentrant. Reentrant functions may be invoked from
+   several threads at the same time.
+ */
+typedef void(*MarkReentrant)(RegistrationCtx *ctx, const char *name);
+
 /**
  *\enum CallbackArgType
  *\brief Allowed data types for additional callback arguments,
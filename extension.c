@@ -41,6 +41,8 @@ typedef struct
 	char *name;             /* callback name */
 	uint32_t argc;          /* number of optional function arguments */
 	CallbackArgType *types; /* optional function argument data types */
+	bool pure;              /* result depends only on file content and arguments */
+	bool reentrant;         /* function may be invoked concurrently */
 } ExtensionCallback;
 
 typedef enum
@@ -88,6 +90,7 @@ typedef struct
 	ExtensionModuleType type;      /* type id */
 	ExtensionBackendClass backend; /* backend functions */
 	void *handle;                  /* backend handle */
+	uint64_t cache_stamp;          /* version stamp of cached results */
 	AssocArray *callbacks;         /* associative array containing callback names and ExtensionCallback instances */
 } ExtensionModule;
 /*! @endcond */
@@ -246,6 +249,58 @@ _extension_manager_function_discovered(RegistrationCtx *ctx, const char *name, u
 	}
 }
 
+static ExtensionCallback *
+_extension_module_lookup_callback(ExtensionModule *module, const char *name)
+{
+	ExtensionCallback *cb = NULL;
+
+	assert(module != NULL);
+
+	if(name)
+	{
+		const AssocArrayPair *pair = assoc_array_lookup(module->callbacks, name);
+
+		if(pair)
+		{
+			cb = assoc_array_pair_get_value(pair);
+		}
+		else
+		{
+			WARNINGF("extension", "Function `%s' not found.", name);
+		}
+	}
+
+	return cb;
+}
+
+static void
+_extension_manager_function_marked_pure(RegistrationCtx *ctx, const char *name)
+{
+	assert(ctx != NULL);
+
+	ExtensionCallback *cb = _extension_module_lookup_callback((ExtensionModule *)ctx, name);
+
+	if(cb)
+	{
+		TRACEF("extension", "Function marked as pure: %s", name);
+		cb->pure = true;
+	}
+}
+
+static void
+_extension_manager_function_marked_reentrant(RegistrationCtx *ctx, const char *name)
+{
+	assert(ctx != NULL);
+
+	ExtensionCallback *cb = _extension_module_lookup_callback((ExtensionModule *)ctx, name);
+
+	if(cb)
+	{
+		TRACEF("extension", "Function marked as reentrant: %s", name);
+		cb->reentrant = true;
+	}
+}
+
 static void
 _extension_manager_extension_registered(RegistrationCtx *ctx, const char *name, const char *version, const char *description)
 {
@@ -290,7 +345,15 @@ _extension_manager_import_module(ExtensionManager *manager, const char *filename
 		{
 			assoc_array_set(manager->modules, utils_strdup(module->filename), module, true);
 
+			module->cache_stamp = ext_cache_module_stamp(module->filename);
+
 			module->backend.discover(module->handle, _extension_manager_function_discovered, (void *)module);
+			module->backend.discover_pure(module->handle, _extension_manager_function_marked_pure, (void *)module);
+
+			if(module->backend.discover_reentrant)
+			{
+				module->backend.discover_reentrant(module->handle, _extension_manager_function_marked_reentrant, (void *)module);
+			}
 
 			success = true;
 		}
@@ -357,10 +420,32 @@ extension_manager_destroy(ExtensionManager *manager)
 			assoc_array_destroy(manager->modules);
 		}
 
+		ext_cache_close(manager->cache);
 		free(manager);
 	}
 }
 
+bool
+extension_manager_open_cache(ExtensionManager *manager, const char *filename, size_t capacity)
+{
+	assert(manager != NULL);
+	assert(filename != NULL);
+	assert(manager->cache == NULL);
+
+	manager->cache = ext_cache_open(filename, capacity);
+
+	return manager->cache != NULL;
+}
+
+void
+extension_manager_close_cache(ExtensionManager *manager)
+{
+	assert(manager != NULL);
+
+	ext_cache_close(manager->cache);
+	manager->cache = NULL;
+}
+
 bool
 extension_manager_load_directory(ExtensionManager *manager, const char *path, char **err)
 {
@@ -615,6 +700,17 @@ extension_manager_test_callback(const ExtensionManager *manager, const char *nam
 	return result;
 }
 
+bool
+extension_manager_is_reentrant(const ExtensionManager *manager, const char *name)
+{
+	ExtensionCallback *cb = NULL;
+
+	assert(manager != NULL);
+	assert(name != NULL);
+
+	return _extension_manager_find_callback(manager, name, &cb) && cb->reentrant;
+}
+
 ExtensionCallbackStatus
 extension_manager_invoke(const ExtensionManager *manager, const char *name, const char *filename, uint32_t argc, void *argv[], int *result)
 {
@@ -633,10 +729,29 @@ extension_manager_invoke(const ExtensionManager *manager, const char *name, cons
 	{
 		if(cb->argc == argc)
 		{
-			if(module->backend.invoke(module->handle, name, filename, argc, argv, result) == 0)
+			struct stat st;
+			bool cacheable = cb->pure && manager->cache && !stat(filename, &st);
+			uint64_t key = 0;
+
+			if(cacheable)
 			{
+				key = ext_cache_key(module->cache_stamp, name, argc, cb->types, argv);
+			}
+
+			if(cacheable && ext_cache_lookup(manager->cache, &st, key, result))
+			{
+				TRACEF("extension", "Found cached result of function `%s': %d", name, *result);
 				status = EXTENSION_CALLBACK_STATUS_OK;
 			}
+			else if(module->backend.invoke(module->handle, name, filename, argc, argv, result) == 0)
+			{
+				status = EXTENSION_CALLBACK_STATUS_OK;
+
+				if(cacheable)
+				{
+					ext_cache_store(manager->cache, &st, key, *result);
+				}
+			}
 		}
 		else
 		{
@@ -27,6 +27,7 @@
 #include <limits.h>
 
 #include "extension-interface.h"
+#include "ext-cache.h"
 
 /**
    @struct ExtensionBackendClass
@@ -53,6 +54,25 @@ typedef struct _ExtensionBackendClass
 	 */
 	void (*discover)(void *handle, RegisterCallback fn, RegistrationCtx *ctx);
 
+	/**
+	   @param handle backend handle
+	   @param fn function to mark callbacks as pure
+	   @param ctx registration context
+
+	   Discovers pure functions.
+	 */
+	void (*discover_pure)(void *handle, MarkPure fn, RegistrationCtx *ctx);
+
+	/**
+	   @param handle backend handle
+	   @param fn function to mark callbacks as reentrant
+	   @param ctx registration context
+
+	   Discovers reentrant functions. Backends that cannot invoke functions
+	   concurrently set this member to NULL.
+	 */
+	void (*discover_reentrant)(void *handle, MarkReentrant fn, RegistrationCtx *ctx);
+
 	/**
 	   @param handle backend handle
 	   @param name name of the function to invoke
@@ -82,6 +102,8 @@ typedef struct
 {
 	/*! Associative array containing module filenames and extension modules. */
 	AssocArray *modules;
+	/*! Persistent cache for results of pure functions (optional). */
+	ExtensionCache *cache;
 } ExtensionManager;
 
 /**
@@ -145,6 +167,23 @@ bool extension_manager_load_directory(ExtensionManager *manager, const char *pat
  */
 int extension_manager_load_default(ExtensionManager *manager);
 
+/**
+   @param manager an ExtensionManager
+   @param filename location of the cache file
+   @param capacity number of entries of a new cache file, 0 for the default size
+   @return true on success
+
+   Opens a persistent cache for the results of pure functions.
+ */
+bool extension_manager_open_cache(ExtensionManager *manager, const char *filename, size_t capacity);
+
+/**
+   @param manager an ExtensionManager
+
+   Closes the persistent cache opened with extension_manager_open_cache().
+ */
+void extension_manager_close_cache(ExtensionManager *manager);
+
 /**
    @param manager an ExtensionManager
    @param name name of the callback to test
@@ -156,6 +195,15 @@ int extension_manager_load_default(ExtensionManager *manager);
  */
 ExtensionCallbackStatus extension_manager_test_callback(const ExtensionManager *manager, const char *name, uint32_t argc, const CallbackArgType *types);
 
+/**
+   @param manager an ExtensionManager
+   @param name name of a callback
+   @return true if the callback may be invoked from several threads at the same time
+
+   Tests if a callback is reentrant.
+ */
+bool extension_manager_is_reentrant(const ExtensionManager *manager, const char *name);
+
 /**
    @param manager an ExtensionManager
    @param name name of the callback to invoke
@@ -165,7 +213,8 @@ ExtensionCallbackStatus extension_manager_test_callback(const ExtensionManager *
    @param result destination to store the result of the callback
    @return status code
 
-   Executes a callback.
+   Executes a callback. Results of pure functions are looked up in the
+   cache first if a cache has been opened.
  */
 ExtensionCallbackStatus extension_manager_invoke(const ExtensionManager *manager, const char *name, const char *filename, uint32_t argc, void *argv[], int *result);
 
@@ -27,29 +27,20 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <math.h>
+#include <sys/sysmacros.h>
 #include <assert.h>
 
 #include "fileinfo.h"
+#include "stat-batch.h"
 #include "log.h"
 #include "linux.h"
 #include "utils.h"
 #include "gettext.h"
 
-/*! Shared FSMap instance to get the filesystem of a file. */
-static FSMap *_fs_map = NULL;
-
-static void
-_fs_map_free(void)
-{
-	if(_fs_map)
-	{
-		fs_map_destroy(_fs_map);
-	}
-}
-
 static char *
 _file_info_get_dirname(const char *filename)
 {
@@ -211,74 +202,314 @@ _file_info_calc_sparseness(blksize_t blksize, blkcnt_t blocks, off_t size)
 	return sparseness;
 }
 
-void
-file_info_init(FileInfo *info)
+FileInfo *
+file_info_new(const char *cli, bool dup_cli, const char *path)
+{
+	FileInfo *info = NULL;
+
+	assert(cli != NULL);
+	assert(path != NULL);
+
+	if(strlen(cli) < PATH_MAX && strlen(path) < PATH_MAX)
+	{
+		info = utils_new(1, FileInfo);
+
+		info->refs = 1;
+		info->cli = dup_cli ? utils_strdup(cli) : (char *)cli;
+		info->dup_cli = dup_cli;
+		info->path = utils_strdup(path);
+	}
+	else
+	{
+		ERRORF("misc", "Couldn't validate paths: cli=%s, path=%s", cli, path);
+	}
+
+	return info;
+}
+
+FileInfo *
+file_info_ref(FileInfo *info)
 {
 	assert(info != NULL);
+	assert(info->refs > 0);
+
+	++info->refs;
 
-	memset(info, 0, sizeof(FileInfo));
+	return info;
 }
 
 void
-file_info_clear(FileInfo *info)
+file_info_unref(FileInfo *info)
 {
 	if(info)
 	{
-		free(info->path);
+		assert(info->refs > 0);
 
-		if(info->dup_cli)
+		if(!--info->refs)
 		{
-			free(info->cli);
-		}
+			free(info->path);
+			free(info->user);
+			free(info->group);
+			free(info->target);
+
+			if(info->dup_cli)
+			{
+				free(info->cli);
+			}
 
-		file_info_init(info);
+			free(info);
+		}
 	}
 }
 
-bool
-file_info_get(FileInfo *info, const char *cli, bool dup_cli, const char *path)
+void
+file_info_copy_statx(FileInfoStat *sb, const struct statx *stx)
 {
-	bool success = false;
+	assert(sb != NULL);
+	assert(stx != NULL);
+
+	/* device numbers & block size are always returned */
+	sb->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+	sb->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+	sb->st_blksize = stx->stx_blksize;
+
+	if(stx->stx_mask & STATX_TYPE)
+	{
+		sb->st_mode = (sb->st_mode & ~S_IFMT) | (stx->stx_mode & S_IFMT);
+	}
+
+	if(stx->stx_mask & STATX_MODE)
+	{
+		sb->st_mode = (sb->st_mode & S_IFMT) | (stx->stx_mode & ~S_IFMT);
+	}
+
+	if(stx->stx_mask & STATX_NLINK)
+	{
+		sb->st_nlink = stx->stx_nlink;
+	}
+
+	if(stx->stx_mask & STATX_UID)
+	{
+		sb->st_uid = stx->stx_uid;
+	}
+
+	if(stx->stx_mask & STATX_GID)
+	{
+		sb->st_gid = stx->stx_gid;
+	}
+
+	if(stx->stx_mask & STATX_INO)
+	{
+		sb->st_ino = stx->stx_ino;
+	}
+
+	if(stx->stx_mask & STATX_SIZE)
+	{
+		sb->st_size = stx->stx_size;
+	}
 
+	if(stx->stx_mask & STATX_BLOCKS)
+	{
+		sb->st_blocks = stx->stx_blocks;
+	}
+
+	if(stx->stx_mask & STATX_ATIME)
+	{
+		sb->st_atim.tv_sec = stx->stx_atime.tv_sec;
+		sb->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+	}
+
+	if(stx->stx_mask & STATX_MTIME)
+	{
+		sb->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+		sb->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+	}
+
+	if(stx->stx_mask & STATX_CTIME)
+	{
+		sb->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+		sb->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+	}
+}
+
+static void
+_file_info_merge_statx(FileInfo *info, const struct statx *stx)
+{
 	assert(info != NULL);
-	assert(cli != NULL);
-	assert(path != NULL);
+	assert(stx != NULL);
+
+	file_info_copy_statx(&info->sb, stx);
+
+	info->mask |= stx->stx_mask & STATX_BASIC_STATS;
+	info->flags = (info->flags & ~FILE_INFO_FLAG_STAT_FAILED) | FILE_INFO_FLAG_STAT;
+}
 
-	#ifdef _LARGEFILE64_SOURCE
-	struct stat64 sb;
-	int rc = lstat64(path, &sb);
-	#else
-	struct stat sb;
-	int rc = lstat(path, &sb);
-	#endif
+bool
+file_info_stat_fields(FileInfo *info, unsigned int mask)
+{
+	assert(info != NULL);
 
-	if(!rc)
+	if((info->mask & mask) != mask && !(info->flags & FILE_INFO_FLAG_STAT_FAILED))
 	{
-		if(strlen(cli) < PATH_MAX && strlen(path) < PATH_MAX)
+		struct statx stx;
+
+		if(!stat_batch_file(info->path, mask, &stx))
 		{
-			info->cli = dup_cli ? utils_strdup(cli) : (char *)cli;
-			info->dup_cli = dup_cli;
-			info->path = utils_strdup(path);
-			info->sb = sb;
-			success = true;
+			_file_info_merge_statx(info, &stx);
+
+			/* don't ask again for fields the filesystem doesn't provide */
+			info->mask |= mask;
 		}
 		else
 		{
-			ERRORF("misc", "Couldn't validate paths: cli=%s, path=%s", cli, path);
+			info->flags |= FILE_INFO_FLAG_STAT_FAILED;
+
+			ERRORF("misc", "Couldn't retrieve information about %s: '`statx' failed.", info->path);
+			fprintf(stderr, _("Couldn't stat file: %s\n"), info->path);
+			perror("statx()");
 		}
 	}
-	else
+
+	return (info->mask & mask) == mask;
+}
+
+bool
+file_info_stat(FileInfo *info)
+{
+	return file_info_stat_fields(info, STATX_BASIC_STATS);
+}
+
+const FileInfoStat *
+file_info_stat_target(FileInfo *info)
+{
+	assert(info != NULL);
+
+	if(!(info->flags & FILE_INFO_FLAG_TARGET))
 	{
-		ERRORF("misc", "Couldn't retrieve information about %s: '`lstat64' failed.", path);
-		fprintf(stderr, _("Couldn't stat file: %s\n"), path);
+		info->flags |= FILE_INFO_FLAG_TARGET;
+		info->target = utils_new(1, FileInfoStat);
+
 		#ifdef _LARGEFILE64_SOURCE
-		perror("lstat64()");
+		if(stat64(info->path, info->target))
 		#else
-		perror("lstat()");
+		if(stat(info->path, info->target))
 		#endif
+		{
+			TRACEF("misc", "Couldn't dereference `%s', errno=%d.", info->path, errno);
+
+			free(info->target);
+			info->target = NULL;
+		}
 	}
 
-	return success;
+	return info->target;
+}
+
+void
+file_info_set_stat(FileInfo *info, const FileInfoStat *sb)
+{
+	assert(info != NULL);
+	assert(sb != NULL);
+
+	info->sb = *sb;
+	info->mask = STATX_BASIC_STATS;
+	info->flags = (info->flags & ~FILE_INFO_FLAG_STAT_FAILED) | FILE_INFO_FLAG_STAT;
+}
+
+void
+file_info_set_statx(FileInfo *info, const struct statx *stx)
+{
+	assert(info != NULL);
+	assert(stx != NULL);
+
+	_file_info_merge_statx(info, stx);
+}
+
+void
+file_info_set_type(FileInfo *info, mode_t type)
+{
+	assert(info != NULL);
+
+	info->type = type & S_IFMT;
+	info->flags |= FILE_INFO_FLAG_TYPE;
+}
+
+unsigned int
+file_info_field_stat_mask(char field)
+{
+	unsigned int mask = STATX_BASIC_STATS;
+
+	switch(field)
+	{
+		case 'f':
+		case 'P':
+		case 'p':
+		case 'h':
+		case 'H':
+		case 'F':
+		case 'X':
+		case 'N':
+			mask = 0;
+			break;
+
+		case 'g':
+		case 'G':
+			mask = STATX_GID;
+			break;
+
+		case 'u':
+		case 'U':
+			mask = STATX_UID;
+			break;
+
+		case 'l':
+		case 'D': /* the device number is returned with any field */
+			mask = STATX_TYPE;
+			break;
+
+		case 'b':
+		case 'k':
+			mask = STATX_BLOCKS;
+			break;
+
+		case 'i':
+			mask = STATX_INO;
+			break;
+
+		case 'n':
+			mask = STATX_NLINK;
+			break;
+
+		case 's':
+			mask = STATX_SIZE;
+			break;
+
+		case 'S':
+			mask = STATX_SIZE | STATX_BLOCKS;
+			break;
+
+		case 'A':
+		case 'a':
+			mask = STATX_ATIME;
+			break;
+
+		case 'C':
+		case 'c':
+			mask = STATX_CTIME;
+			break;
+
+		case 'T':
+		case 't':
+			mask = STATX_MTIME;
+			break;
+
+		case 'm':
+		case 'M':
+			mask = STATX_TYPE | STATX_MODE;
+			break;
+	}
+
+	return mask;
 }
 
 static char *
@@ -317,6 +548,13 @@ file_info_get_attr(FileInfo *info, FileAttr *attr, char field)
 
 	static const char *empty = "";
 
+	unsigned int mask = file_info_field_stat_mask(field);
+
+	if(mask && !file_info_stat_fields(info, mask))
+	{
+		return false;
+	}
+
 	switch(field)
 	{
 		case 'f': /* File's name with any leading directories removed (only the last element). */
@@ -345,27 +583,35 @@ file_info_get_attr(FileInfo *info, FileAttr *attr, char field)
 			break;
 
 		case 'g': /* File's group name, or numeric group ID if the group has no name. */
-			attr->flags = FILE_ATTR_FLAG_STRING | FILE_ATTR_FLAG_HEAP;
-			attr->value.str = linux_map_gid(info->sb.st_gid);
+			attr->flags = FILE_ATTR_FLAG_STRING;
+
+			if(!info->group)
+			{
+				info->group = linux_map_gid(info->sb.st_gid);
+			}
+
+			attr->value.str = info->group;
 			break;
 
 		case 'u': /* File's user name, or numeric user ID if the group has no name. */
-			attr->flags = FILE_ATTR_FLAG_STRING | FILE_ATTR_FLAG_HEAP;
-			attr->value.str = linux_map_uid(info->sb.st_uid);
+			attr->flags = FILE_ATTR_FLAG_STRING;
+
+			if(!info->user)
+			{
+				info->user = linux_map_uid(info->sb.st_uid);
+			}
+
+			attr->value.str = info->user;
 			break;
 
 		case 'F': /* Type of the filesystem the file is on; this value can be used for -fstype. */
 			attr->flags = FILE_ATTR_FLAG_STRING;
 
-			if(!_fs_map)
-			{
-				_fs_map = fs_map_load();
-				atexit(_fs_map_free);
-			}
+			FSMap *fsmap = fs_map_get_default();
 
-			if(_fs_map)
+			if(fsmap)
 			{
-				attr->value.str = (char *)fs_map_path(_fs_map, info->path);
+				attr->value.str = (char *)fs_map_path(fsmap, info->path);
 			}
 			else
 			{
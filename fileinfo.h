@@ -30,24 +30,63 @@
 
 #include "fs.h"
 
+struct statx;
+
+/**
+   @enum FileInfoFlags
+   @brief Flags which can be set for a FileInfo.
+ */
+typedef enum
+{
+	/*! The stat buffer has been (partially) populated. */
+	FILE_INFO_FLAG_STAT        = 1,
+	/*! Reading file status failed. */
+	FILE_INFO_FLAG_STAT_FAILED = 2,
+	/*! The file type is known without reading the file status. */
+	FILE_INFO_FLAG_TYPE        = 4,
+	/*! The status of the symbolic link target has been read. */
+	FILE_INFO_FLAG_TARGET      = 8
+} FileInfoFlags;
+
+/**
+   @typedef FileInfoStat
+   @brief Stat buffer of a FileInfo.
+ */
+#ifdef _LARGEFILE64_SOURCE
+typedef struct stat64 FileInfoStat;
+#else
+typedef struct stat FileInfoStat;
+#endif
+
 /**
    @struct FileInfo
-   @brief File attributes.
+   @brief Reference-counted file record. The stat buffer and expensive
+          attributes are populated on first access.
  */
 typedef struct
 {
+	/*! Reference counter. */
+	unsigned int refs;
 	/*! Command line argument under which the file was found. */
 	char *cli;
 	/*! Path of the file. */
 	char *path;
 	/*! Indicates if cli string was duplicated. */
 	bool dup_cli;
+	/*! Status flags. */
+	uint8_t flags;
 	/*! File information. */
-	#ifdef _LARGEFILE64_SOURCE
-	struct stat64 sb;
-	#else
-	struct stat sb;
-	#endif
+	FileInfoStat sb;
+	/*! statx fields read into the stat buffer. */
+	unsigned int mask;
+	/*! File type bits (S_IFMT), valid if FILE_INFO_FLAG_TYPE is set. */
+	mode_t type;
+	/*! Cached user name. */
+	char *user;
+	/*! Cached group name. */
+	char *group;
+	/*! Cached status of the symbolic link target (NULL if not available). */
+	FileInfoStat *target;
 } FileInfo;
 
 /**
@@ -93,30 +132,102 @@ typedef struct
 	} value;
 } FileAttr;
 
+/**
+   @param cli command line argument under which the file was found
+   @param dup_cli true to duplicate cli string and free it when the FileInfo is destroyed
+   @param path name of the file
+   @return a new FileInfo instance or NULL on failure
+
+   Creates a FileInfo with a reference count of one. File status is read
+   lazily.
+ */
+FileInfo *file_info_new(const char *cli, bool dup_cli, const char *path);
+
 /**
    @param info a FileInfo instance
+   @return the FileInfo instance
 
-   Initializes a FileInfo instance.
+   Increments the reference counter of a FileInfo.
  */
-void file_info_init(FileInfo *info);
+FileInfo *file_info_ref(FileInfo *info);
 
 /**
    @param info a FileInfo instance
 
-   Resets all fields of a FileInfo instance and frees resources.
+   Decrements the reference counter of a FileInfo and frees it when the
+   counter drops to zero.
  */
-void file_info_clear(FileInfo *info);
+void file_info_unref(FileInfo *info);
 
 /**
    @param info a FileInfo instance
-   @param cli command line argument under which the file was found
-   @param dup_cli true to duplicate cli string and free it when clearing the FileInfo instance
-   @param path name of the file to read attributes from
+   @param mask statx fields to read (e.g. STATX_SIZE | STATX_MTIME)
    @return true on success
 
-   Prepares a FileInfo instance for attribute reading.
+   Reads the given fields of the file status if they haven't been read yet.
+ */
+bool file_info_stat_fields(FileInfo *info, unsigned int mask);
+
+/**
+   @param info a FileInfo instance
+   @return true on success
+
+   Reads the file status if it hasn't been read yet.
+ */
+bool file_info_stat(FileInfo *info);
+
+/**
+   @param info a FileInfo instance
+   @return file status or NULL on failure
+
+   Reads the status of the file, symbolic links are dereferenced. The status
+   is read only once.
+ */
+const FileInfoStat *file_info_stat_target(FileInfo *info);
+
+/**
+   @param info a FileInfo instance
+   @param sb file status to assign
+
+   Assigns a previously read file status, e.g. from an index, so that it
+   isn't read from disk.
+ */
+void file_info_set_stat(FileInfo *info, const FileInfoStat *sb);
+
+/**
+   @param info a FileInfo instance
+   @param stx file status read with statx
+
+   Assigns the fields of a previously read file status, e.g. from a
+   StatBatch.
+ */
+void file_info_set_statx(FileInfo *info, const struct statx *stx);
+
+/**
+   @param sb stat buffer to update
+   @param stx file status read with statx
+
+   Copies the fields found in a statx buffer to a stat buffer.
+ */
+void file_info_copy_statx(FileInfoStat *sb, const struct statx *stx);
+
+/**
+   @param info a FileInfo instance
+   @param type file type bits (S_IFMT)
+
+   Assigns a file type known without reading the file status, e.g. from
+   the d_type field of a directory entry.
+ */
+void file_info_set_type(FileInfo *info, mode_t type);
+
+/**
+   @param field field to test (see efind's printf-syntax)
+   @return statx fields needed to get the file attribute, 0 if it doesn't
+           depend on the file status
+
+   Gets the file status fields a file attribute depends on.
  */
-bool file_info_get(FileInfo *info, const char *cli, bool dup_cli, const char *path);
+unsigned int file_info_field_stat_mask(char field);
 
 /**
    @param info a FileInfo instance
@@ -135,26 +135,41 @@ _sort_string_pop(const char *str, char *field, bool *asc)
 	return rest;
 }
 
+unsigned int
+sort_string_stat_mask(const char *str)
+{
+	unsigned int mask = 0;
+
+	assert(str != NULL);
+
+	if(sort_string_test(str) > 0)
+	{
+		const char *rest = str;
+
+		do
+		{
+			char field;
+			bool asc;
+
+			rest = _sort_string_pop(rest, &field, &asc);
+			mask |= file_info_field_stat_mask(field);
+		} while(rest);
+	}
+
+	return mask;
+}
+
 void
 file_list_init(FileList *list, const char *orderby)
 {
 	assert(list != NULL);
 
-	size_t item_size = sizeof(FileListEntry);
-
 	memset(list, 0, sizeof(FileList));
 
-	slist_init(&list->clis, str_compare, free, NULL);
-
 	list->entries = utils_new(512, FileListEntry *);
 	list->size = 512;
 
-	if(sizeof(FileInfo) > item_size)
-	{
-		item_size = sizeof(FileInfo);
-	}
-
-	list->pool = (Pool *)memory_pool_new(item_size, 1024);
+	list->pool = (Pool *)memory_pool_new(sizeof(FileListEntry), 1024);
 
 	if(orderby)
 	{
@@ -186,6 +201,13 @@ file_list_init(FileList *list, const char *orderby)
 
 					TRACEF("filelist", "Found field '%c', ascending=%d.", list->fields[offset], list->fields_asc[offset]);
 				}
+
+				for(int i = 0; i < count; ++i)
+				{
+					list->stat_mask |= file_info_field_stat_mask(list->fields[i]);
+				}
+
+				DEBUGF("filelist", "Sort fields depend on file status fields %#x.", list->stat_mask);
 			}
 		}
 		else
@@ -195,34 +217,12 @@ file_list_init(FileList *list, const char *orderby)
 	}
 }
 
-static char *
-_file_list_dup_cli(FileList *list, const char *cli)
-{
-	char *dup;
-
-	assert(list != NULL);
-
-	SListItem *search = slist_find(&list->clis, NULL, cli);
-
-	if(search)
-	{
-		dup = (char *)slist_item_get_data(search);
-	}
-	else
-	{
-		dup = utils_strdup(cli);
-		slist_append(&list->clis, dup);
-	}
-
-	return dup;
-}
-
 static void
 _file_list_entry_free(FileListEntry *entry)
 {
-	if(entry && entry->info)
+	if(entry)
 	{
-		file_info_clear(entry->info);
+		file_info_unref(entry->info);
 	}
 }
 
@@ -241,26 +241,22 @@ _file_list_entry_new(FileList *list)
 }
 
 static FileListEntry *
-_file_list_entry_new_from_path(FileList *list, const char *cli, const char *path)
+_file_list_entry_new_from_info(FileList *list, FileInfo *info)
 {
 	FileListEntry *entry = NULL;
 
 	assert(list != NULL);
-	assert(path != NULL);
-
-	FileInfo info;
+	assert(info != NULL);
 
-	file_info_init(&info);
-
-	if(file_info_get(&info, _file_list_dup_cli(list, cli), false, path))
+	/* files are only stat'ed if a sort field needs the file status */
+	if(!list->stat_mask || file_info_stat_fields(info, list->stat_mask))
 	{
 		entry = _file_list_entry_new(list);
-		entry->info = list->pool->alloc(list->pool);
-		memcpy(entry->info, &info, sizeof(FileInfo));
+		entry->info = file_info_ref(info);
 	}
 	else
 	{
-		DEBUGF("fileinfo", "Couldn't read details of file %s.", path);;
+		DEBUGF("fileinfo", "Couldn't read details of file %s.", info->path);
 	}
 
 	return entry;
@@ -273,8 +269,6 @@ file_list_free(FileList *list)
 
 	if(list)
 	{
-		slist_free(&list->clis);
-
 		free(list->fields);
 		free(list->fields_asc);
 
@@ -289,16 +283,16 @@ file_list_free(FileList *list)
 }
 
 bool
-file_list_append(FileList *list, const char *cli, const char *path)
+file_list_append(FileList *list, FileInfo *info)
 {
 	bool success = false;
 
 	assert(list != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	FileListEntry *entry = NULL;
 
-	TRACEF("filelist", "Appending file: %s", path);
+	TRACEF("filelist", "Appending file: %s", info->path);
 
 	if(list->count != SIZE_MAX)
 	{
@@ -320,7 +314,7 @@ file_list_append(FileList *list, const char *cli, const char *path)
 			}
 		}
 
-		entry = _file_list_entry_new_from_path(list, cli, path);
+		entry = _file_list_entry_new_from_info(list, info);
 
 		if(entry)
 		{
@@ -48,14 +48,14 @@ typedef struct
  */
 struct _FileList
 {
-	/*! Command line arguments under which the files were found. */
-	SList clis;
 	/*! Fields the list should be sorted by. */
 	char *fields;
 	/*! Sort directions. */
 	bool *fields_asc;
 	/*! Number of fields specified in the sort string. */
 	int fields_n;
+	/*! statx fields the sort fields depend on. */
+	unsigned int stat_mask;
 	/*! Found files and attributes. */
 	FileListEntry **entries;
 	/*! Number of found files. */
@@ -74,6 +74,14 @@ struct _FileList
   */
 int sort_string_test(const char *str);
 
+/**
+   @param str sort string
+   @return statx fields needed to sort by the given fields
+
+   Gets the file status fields a sort string depends on.
+  */
+unsigned int sort_string_stat_mask(const char *str);
+
 /**
    @param list FileList instance to initialize
    @param orderby sort string
@@ -91,13 +99,13 @@ void file_list_free(FileList *list);
 
 /**
    @param list FileList instance
-   @param cli command line argument under which the files are found
-   @param path path to append to the FileList
+   @param info file to append to the FileList
    @return true on success
 
-   Appends a path to a FileList instance.
+   Appends a file to a FileList instance. The reference counter of the
+   FileInfo is incremented.
   */
-bool file_list_append(FileList *list, const char *cli, const char *path);
+bool file_list_append(FileList *list, FileInfo *info);
 
 /**
    @param list FileList instance
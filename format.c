@@ -268,48 +268,68 @@ _format_write_attr_node(const FormatParserResult *result, const FormatNodeBase *
 }
 
 bool
-format_write(const FormatParserResult *result, const char *arg, const char *filename, FILE *out)
+format_write(const FormatParserResult *result, FileInfo *info, FILE *out)
 {
-	FileInfo info;
-	bool success = false;
+	bool success = true;
 
 	assert(result != NULL);
 	assert(result->success == true);
-	assert(arg != NULL);
-	assert(filename != NULL);
+	assert(info != NULL);
 	assert(out != NULL);
 
-	file_info_init(&info);
+	SListItem *iter = slist_head(result->nodes);
 
-	if(file_info_get(&info, arg, false, filename))
+	while(success && iter)
+	{
+		FormatNodeBase *node = (FormatNodeBase *)slist_item_get_data(iter);
+
+		if(node->type_id == FORMAT_NODE_TEXT)
+		{
+			_format_write_string(((FormatTextNode *)node)->text, node->width, node->precision, node->flags, out);
+		}
+		else if(node->type_id == FORMAT_NODE_ATTR)
+		{
+			success = _format_write_attr_node(result, node, info, out);
+		}
+		else
+		{
+			FATALF("format", "Invalid node type: %#x", node->type_id);
+			success = false;
+		}
+
+		iter = slist_item_next(iter);
+	}
+
+	return success;
+}
+
+unsigned int
+format_stat_mask(const char *fmt)
+{
+	unsigned int mask = 0;
+
+	assert(fmt != NULL);
+
+	FormatParserResult *result = format_parse(fmt);
+
+	if(result->success)
 	{
 		SListItem *iter = slist_head(result->nodes);
-		success = true;
 
-		while(success && iter)
+		while(iter)
 		{
 			FormatNodeBase *node = (FormatNodeBase *)slist_item_get_data(iter);
 
-			if(node->type_id == FORMAT_NODE_TEXT)
-			{
-				_format_write_string(((FormatTextNode *)node)->text, node->width, node->precision, node->flags, out);
-			}
-			else if(node->type_id == FORMAT_NODE_ATTR)
-			{
-				success = _format_write_attr_node(result, node, &info, out);
-			}
-			else
+			if(node->type_id == FORMAT_NODE_ATTR)
 			{
-				FATALF("format", "Invalid node type: %#x", node->type_id);
-				success = false;
+				mask |= file_info_field_stat_mask(((FormatAttrNode *)node)->attr);
 			}
 
 			iter = slist_item_next(iter);
 		}
-
-		file_info_clear(&info);
 	}
 
-	return success;
-}
+	format_parser_result_free(result);
 
+	return mask;
+}
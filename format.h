@@ -23,17 +23,25 @@
 #define FORMAT_H
 
 #include "format-parser.h"
+#include "fileinfo.h"
 
 /**
    @param result a FormatParserResult instance
-   @param arg command line arguments under which the file was found
-   @param filename found file
+   @param info found file
    @param out stream to write output to
    @return true on success
 
    Prints file attributes according to the specified format.
  */
-bool format_write(const FormatParserResult *result, const char *arg, const char *filename, FILE *out);
+bool format_write(const FormatParserResult *result, FileInfo *info, FILE *out);
+
+/**
+   @param fmt format string
+   @return statx fields needed to print the format
+
+   Gets the file status fields a format string depends on.
+ */
+unsigned int format_stat_mask(const char *fmt);
 
 #endif
 
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <mntent.h>
+#include <sys/sysmacros.h>
 #include <assert.h>
 
 #include "fs.h"
@@ -36,6 +37,12 @@
 /*! Name of unknown filesystems. */
 const char *FS_UNKNOWN = "Unknown";
 
+/*! Shared list of available mountpoints. */
+static FSMap *_fs_map_default = NULL;
+
+/*! true if the shared list is freed at exit. */
+static bool _fs_map_default_registered = false;
+
 static int
 _fs_map_compare_entries(const void *a, const void *b)
 {
@@ -45,6 +52,70 @@ _fs_map_compare_entries(const void *a, const void *b)
 	return strcmp((*((MountPoint **)b))->path, (*((MountPoint **)a))->path);
 }
 
+static void
+_fs_unescape(char *str)
+{
+	char *dst = str;
+
+	assert(str != NULL);
+
+	while(*str)
+	{
+		if(str[0] == '\\' && str[1] >= '0' && str[1] <= '3' && str[2] >= '0' && str[2] <= '7' && str[3] >= '0' && str[3] <= '7')
+		{
+			*dst++ = (char)(((str[1] - '0') << 6) | ((str[2] - '0') << 3) | (str[3] - '0'));
+			str += 4;
+		}
+		else
+		{
+			*dst++ = *str++;
+		}
+	}
+
+	*dst = '\0';
+}
+
+static void
+_fs_map_load_devices(FSMap *map)
+{
+	FILE *fp;
+
+	assert(map != NULL);
+
+	if((fp = fopen("/proc/self/mountinfo", "r")))
+	{
+		char *line = NULL;
+		size_t bytes = 0;
+
+		while(getline(&line, &bytes, fp) > 0)
+		{
+			unsigned int major;
+			unsigned int minor;
+			char path[PATH_MAX];
+
+			if(sscanf(line, "%*d %*d %u:%u %*s %4095s", &major, &minor, path) == 3)
+			{
+				_fs_unescape(path);
+
+				for(size_t i = 0; i < map->len; ++i)
+				{
+					if(!strcmp(map->mps[i]->path, path))
+					{
+						map->mps[i]->dev = makedev(major, minor);
+					}
+				}
+			}
+		}
+
+		free(line);
+		fclose(fp);
+	}
+	else
+	{
+		DEBUG("misc", "Couldn't open /proc/self/mountinfo.");
+	}
+}
+
 FSMap *
 fs_map_load(void)
 {
@@ -88,12 +159,16 @@ fs_map_load(void)
 			memset(map->mps[map->len]->path, 0, PATH_MAX);
 			strncpy(map->mps[map->len]->path, ent->mnt_dir, PATH_MAX - 1);
 
+			map->mps[map->len]->dev = 0;
+
 			++map->len;
 			ent = getmntent(fp);
 		}
 
 		endmntent(fp);
 
+		_fs_map_load_devices(map);
+
 		/* sort array by path in descending order */
 		if(map->len)
 		{
@@ -123,6 +198,47 @@ fs_map_destroy(FSMap *map)
 	}
 }
 
+static void
+_fs_map_free_default(void)
+{
+	fs_map_destroy(_fs_map_default);
+	_fs_map_default = NULL;
+}
+
+FSMap *
+fs_map_get_default(void)
+{
+	if(!_fs_map_default)
+	{
+		_fs_map_default = fs_map_load();
+
+		if(_fs_map_default && !_fs_map_default_registered)
+		{
+			atexit(_fs_map_free_default);
+			_fs_map_default_registered = true;
+		}
+	}
+
+	return _fs_map_default;
+}
+
+void
+fs_map_reload_default(void)
+{
+	if(_fs_map_default)
+	{
+		FSMap *map = fs_map_load();
+
+		if(map)
+		{
+			DEBUG("misc", "Mount table changed, reloaded filesystem map.");
+
+			fs_map_destroy(_fs_map_default);
+			_fs_map_default = map;
+		}
+	}
+}
+
 const char *
 fs_map_path(FSMap *map, const char *path)
 {
@@ -155,3 +271,52 @@ fs_map_path(FSMap *map, const char *path)
 	return FS_UNKNOWN;
 }
 
+const char *
+fs_map_dev(const FSMap *map, dev_t dev)
+{
+	const char *fs = NULL;
+
+	assert(map != NULL);
+
+	for(size_t i = 0; i < map->len && !fs; ++i)
+	{
+		if(map->mps[i]->dev == dev)
+		{
+			fs = map->mps[i]->fs;
+		}
+	}
+
+	return fs;
+}
+
+bool
+fs_list_contains(const char *list, const char *fs)
+{
+	bool found = false;
+
+	assert(list != NULL);
+	assert(fs != NULL);
+
+	size_t len = strlen(fs);
+
+	while(*list && !found)
+	{
+		const char *end = strchr(list, ',');
+		size_t n = end ? (size_t)(end - list) : strlen(list);
+
+		found = n == len && !strncmp(list, fs, len);
+		list = end ? end + 1 : list + n;
+	}
+
+	return found;
+}
+
+bool
+fs_is_remote(const char *fs)
+{
+	static const char *remote = "nfs,nfs4,cifs,smb3,smbfs,ncpfs,afs,ceph,9p,lustre,gpfs,glusterfs,fuse.glusterfs,fuse.sshfs,fuse.rclone,fuse.s3fs,davfs";
+
+	assert(fs != NULL);
+
+	return fs_list_contains(remote, fs);
+}
@@ -23,6 +23,7 @@
 #define FS_H
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <limits.h>
 
 /*! Maximum length of a filesystem (e.g. "ext4" or "btrfs"). */
@@ -38,6 +39,8 @@ typedef struct
 	char fs[FS_NAME_MAX];
 	/*! The directory referring to the root of the filesystem. */
 	char path[PATH_MAX];
+	/*! Device ID of the filesystem (0 if unknown). */
+	dev_t dev;
 } MountPoint;
 
 /**
@@ -68,6 +71,20 @@ FSMap *fs_map_load(void);
  */
 void fs_map_destroy(FSMap *map);
 
+/**
+   @return the shared FSMap instance or NULL on failure.
+
+   Gets a shared list of available mountpoints. The list is generated when
+   it's requested the first time and freed at exit.
+ */
+FSMap *fs_map_get_default(void);
+
+/**
+   Generates the shared list of available mountpoints again, e.g. after the
+   mount table has changed. Pointers to the previous list become invalid.
+ */
+void fs_map_reload_default(void);
+
 /**
    @param map a FSMap instance
    @param path a path
@@ -77,5 +94,31 @@ void fs_map_destroy(FSMap *map);
  */
 const char *fs_map_path(FSMap *map, const char *path);
 
+/**
+   @param map a FSMap instance
+   @param dev a device ID
+   @return a static string or NULL if the device ID is unknown
+
+   Gets the filesystem of the mountpoint with the specified device ID.
+ */
+const char *fs_map_dev(const FSMap *map, dev_t dev);
+
+/**
+   @param list comma-separated list of filesystem names
+   @param fs a filesystem name
+   @return true if the list contains the filesystem
+
+   Tests if a comma-separated list contains a filesystem name.
+ */
+bool fs_list_contains(const char *list, const char *fs);
+
+/**
+   @param fs a filesystem name
+   @return true if the filesystem is a network filesystem
+
+   Tests if files of a filesystem are accessed over the network.
+ */
+bool fs_is_remote(const char *fs);
+
 #endif
 
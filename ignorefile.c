@@ -0,0 +1,363 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file ignorefile.c
+   @brief Layered .gitignore/.ignore rules.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fnmatch.h>
+#include <assert.h>
+
+#include "ignorefile.h"
+#include "utils.h"
+#include "log.h"
+
+/*! @cond INTERNAL */
+typedef struct
+{
+	char *pattern;
+	bool negate;
+	bool dir_only;
+	bool anchored;
+} IgnorePattern;
+
+typedef struct
+{
+	char *dir;
+	size_t len;
+	IgnorePattern *patterns;
+	size_t count;
+	size_t size;
+} IgnoreLayer;
+
+struct _IgnoreRules
+{
+	IgnoreLayer *layers;
+	size_t count;
+	size_t size;
+};
+/*! @endcond */
+
+IgnoreRules *
+ignore_rules_new(void)
+{
+	return utils_new(1, IgnoreRules);
+}
+
+static void
+_ignore_layer_free(IgnoreLayer *layer)
+{
+	assert(layer != NULL);
+
+	for(size_t i = 0; i < layer->count; ++i)
+	{
+		free(layer->patterns[i].pattern);
+	}
+
+	free(layer->patterns);
+	free(layer->dir);
+}
+
+void
+ignore_rules_destroy(IgnoreRules *rules)
+{
+	if(rules)
+	{
+		while(rules->count)
+		{
+			ignore_rules_pop(rules);
+		}
+
+		free(rules->layers);
+		free(rules);
+	}
+}
+
+static void
+_ignore_layer_append(IgnoreLayer *layer, char *line)
+{
+	assert(layer != NULL);
+	assert(line != NULL);
+
+	IgnorePattern pattern;
+	size_t len = utils_trim(line);
+
+	memset(&pattern, 0, sizeof(IgnorePattern));
+
+	if(!len || *line == '#')
+	{
+		return;
+	}
+
+	if(*line == '!')
+	{
+		pattern.negate = true;
+		++line;
+		--len;
+	}
+	else if(*line == '\\' && (line[1] == '!' || line[1] == '#'))
+	{
+		++line;
+		--len;
+	}
+
+	if(len && line[len - 1] == '/')
+	{
+		pattern.dir_only = true;
+		line[--len] = '\0';
+	}
+
+	if(strchr(line, '/'))
+	{
+		pattern.anchored = true;
+
+		while(*line == '/')
+		{
+			++line;
+		}
+	}
+
+	if(*line)
+	{
+		if(layer->count == layer->size)
+		{
+			layer->size = layer->size ? layer->size * 2 : 8;
+
+			if(layer->patterns)
+			{
+				layer->patterns = utils_renew(layer->patterns, layer->size, IgnorePattern);
+			}
+			else
+			{
+				layer->patterns = utils_new(layer->size, IgnorePattern);
+			}
+		}
+
+		pattern.pattern = utils_strdup(line);
+		layer->patterns[layer->count++] = pattern;
+	}
+}
+
+static void
+_ignore_layer_load(IgnoreLayer *layer, const char *filename)
+{
+	FILE *fp;
+	char path[PATH_MAX];
+
+	assert(layer != NULL);
+	assert(filename != NULL);
+
+	if(snprintf(path, sizeof(path), "%s/%s", layer->dir, filename) < (int)sizeof(path) && (fp = fopen(path, "r")))
+	{
+		char *line = NULL;
+		size_t bytes = 0;
+
+		TRACEF("ignorefile", "Loading patterns: %s", path);
+
+		while(getline(&line, &bytes, fp) > 0)
+		{
+			_ignore_layer_append(layer, line);
+		}
+
+		free(line);
+		fclose(fp);
+	}
+}
+
+void
+ignore_rules_push(IgnoreRules *rules, const char *dir)
+{
+	assert(rules != NULL);
+	assert(dir != NULL);
+
+	if(rules->count == rules->size)
+	{
+		rules->size = rules->size ? rules->size * 2 : 16;
+
+		if(rules->layers)
+		{
+			rules->layers = utils_renew(rules->layers, rules->size, IgnoreLayer);
+		}
+		else
+		{
+			rules->layers = utils_new(rules->size, IgnoreLayer);
+		}
+	}
+
+	IgnoreLayer *layer = &rules->layers[rules->count++];
+
+	memset(layer, 0, sizeof(IgnoreLayer));
+
+	layer->dir = utils_strdup(dir);
+	layer->len = strlen(dir);
+
+	while(layer->len > 1 && layer->dir[layer->len - 1] == '/')
+	{
+		layer->dir[--layer->len] = '\0';
+	}
+
+	_ignore_layer_load(layer, ".gitignore");
+	_ignore_layer_load(layer, ".ignore");
+}
+
+void
+ignore_rules_pop(IgnoreRules *rules)
+{
+	assert(rules != NULL);
+	assert(rules->count > 0);
+
+	_ignore_layer_free(&rules->layers[--rules->count]);
+}
+
+static bool
+_ignore_glob(const char *pattern, const char *path)
+{
+	assert(pattern != NULL);
+	assert(path != NULL);
+
+	if(!strstr(pattern, "**"))
+	{
+		return !fnmatch(pattern, path, FNM_PATHNAME);
+	}
+
+	if(pattern[0] == '*' && pattern[1] == '*' && (pattern[2] == '/' || pattern[2] == '\0'))
+	{
+		const char *rest = pattern[2] ? pattern + 3 : pattern + 2;
+		bool matches = !*rest;
+
+		const char *p = path;
+
+		while(p && !matches)
+		{
+			if(!(matches = _ignore_glob(rest, p)) && (p = strchr(p, '/')))
+			{
+				++p;
+			}
+		}
+
+		return matches;
+	}
+
+	const char *pslash = strchr(pattern, '/');
+	const char *sslash = strchr(path, '/');
+	bool matches = false;
+
+	if(pslash && sslash && (size_t)(pslash - pattern) < PATH_MAX && (size_t)(sslash - path) < PATH_MAX)
+	{
+		char segment[PATH_MAX];
+		char name[PATH_MAX];
+
+		memcpy(segment, pattern, pslash - pattern);
+		segment[pslash - pattern] = '\0';
+		memcpy(name, path, sslash - path);
+		name[sslash - path] = '\0';
+
+		matches = !fnmatch(segment, name, 0) && _ignore_glob(pslash + 1, sslash + 1);
+	}
+	else if(!pslash && !sslash)
+	{
+		matches = !fnmatch(pattern, path, 0);
+	}
+
+	return matches;
+}
+
+static bool
+_ignore_layer_test(const IgnoreLayer *layer, const char *path, bool is_dir, bool *ignored)
+{
+	bool matches = false;
+
+	assert(layer != NULL);
+	assert(path != NULL);
+	assert(ignored != NULL);
+
+	if(!strncmp(path, layer->dir, layer->len) && (path[layer->len] == '/' || layer->dir[layer->len - 1] == '/'))
+	{
+		const char *rel = path + layer->len;
+		const char *name = strrchr(path, '/');
+
+		while(*rel == '/')
+		{
+			++rel;
+		}
+
+		name = name ? name + 1 : path;
+
+		for(size_t i = layer->count; i > 0 && !matches; --i)
+		{
+			const IgnorePattern *pattern = &layer->patterns[i - 1];
+
+			if(!pattern->dir_only || is_dir)
+			{
+				if(pattern->anchored)
+				{
+					matches = _ignore_glob(pattern->pattern, rel);
+				}
+				else
+				{
+					matches = !fnmatch(pattern->pattern, name, 0);
+				}
+
+				if(matches)
+				{
+					*ignored = !pattern->negate;
+				}
+			}
+		}
+	}
+
+	return matches;
+}
+
+bool
+ignore_rules_matches(const IgnoreRules *rules, const char *path, bool is_dir)
+{
+	bool ignored = false;
+	bool matches = false;
+
+	assert(rules != NULL);
+	assert(path != NULL);
+
+	if(is_dir)
+	{
+		const char *name = strrchr(path, '/');
+
+		/* repositories are skipped implicitly like git does */
+		matches = ignored = !strcmp(name ? name + 1 : path, ".git");
+	}
+
+	for(size_t i = rules->count; i > 0 && !matches; --i)
+	{
+		matches = _ignore_layer_test(&rules->layers[i - 1], path, is_dir, &ignored);
+	}
+
+	if(ignored)
+	{
+		TRACEF("ignorefile", "Ignoring file: %s", path);
+	}
+
+	return ignored;
+}
+
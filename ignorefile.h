@@ -0,0 +1,77 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file ignorefile.h
+   @brief Layered .gitignore/.ignore rules.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef IGNOREFILE_H
+#define IGNOREFILE_H
+
+#include <stdbool.h>
+
+/**
+   @struct IgnoreRules
+   @brief A stack of ignore rules, one layer per visited directory.
+ */
+typedef struct _IgnoreRules IgnoreRules;
+
+/**
+   @return a new IgnoreRules instance
+
+   Creates an empty rule stack.
+ */
+IgnoreRules *ignore_rules_new(void);
+
+/**
+   @param rules IgnoreRules to free
+
+   Frees an IgnoreRules instance.
+ */
+void ignore_rules_destroy(IgnoreRules *rules);
+
+/**
+   @param rules an IgnoreRules instance
+   @param dir a directory
+
+   Loads the patterns found in ".gitignore" and ".ignore" of the given
+   directory and pushes them onto the stack. Patterns of ".ignore" take
+   precedence.
+ */
+void ignore_rules_push(IgnoreRules *rules, const char *dir);
+
+/**
+   @param rules an IgnoreRules instance
+
+   Removes the most recently pushed layer.
+ */
+void ignore_rules_pop(IgnoreRules *rules);
+
+/**
+   @param rules an IgnoreRules instance
+   @param path path of a file located in the most recently pushed directory
+   @param is_dir true if the file is a directory
+   @return true if the file is ignored
+
+   Tests a file against all layers. Like git, the last matching pattern of the
+   deepest layer decides; negated patterns re-include files. Directories named
+   ".git" are always ignored.
+ */
+bool ignore_rules_matches(const IgnoreRules *rules, const char *path, bool is_dir);
+
+#endif
+
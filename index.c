@@ -0,0 +1,1452 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file index.c
+   @brief Persistent file index.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <dirent.h>
+#include <assert.h>
+
+#include "index.h"
+#include "utils.h"
+#include "log.h"
+
+/*! @cond INTERNAL */
+#define INDEX_MAGIC      "EFINDIDX"
+#define INDEX_VERSION    1
+#define INDEX_BLOCK_SIZE 64
+
+enum
+{
+	INDEX_FLAG_FOLLOW               = 1,
+	INDEX_FLAG_ONE_FILE_SYSTEM      = 2,
+	INDEX_FLAG_RESPECT_IGNORE_FILES = 4
+};
+
+/*
+   An index file consists of a header, the indexed starting points, all records
+   and a block table:
+
+   Records are sorted by path with '/' ordered before any other character.
+   Each record stores the length of the prefix shared with the previous path,
+   the remaining suffix and the file status, all numbers encoded as varints.
+   Every INDEX_BLOCK_SIZE records the prefix is reset, the block table holds
+   the offsets of these records to binary search starting points.
+ */
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+	int32_t max_depth;
+	uint32_t block_size;
+	uint64_t count;
+	uint64_t records_offset;
+	uint64_t table_offset;
+} IndexHeader;
+
+typedef struct
+{
+	char *path;
+	FileInfoStat sb;
+} IndexRow;
+
+typedef struct
+{
+	char *path;
+	bool cached;
+} IndexDir;
+
+typedef struct
+{
+	const WalkOptions *opts;
+	IndexRow *rows;
+	size_t count;
+	size_t size;
+	IndexRow *old_rows;
+	size_t *old_ends;
+	size_t old_count;
+	IndexDir *dirs;
+	size_t dirs_count;
+	size_t dirs_size;
+	char **dirty;
+	size_t dirty_count;
+	bool watched;
+	size_t reused;
+	WalkErrorCallback err;
+	void *user_data;
+	bool failed;
+} IndexBuilder;
+
+typedef struct
+{
+	const uint8_t *ptr;
+	const uint8_t *end;
+	char path[PATH_MAX];
+	size_t len;
+	bool failed;
+} IndexReader;
+
+struct _Index
+{
+	uint8_t *data;
+	size_t size;
+	IndexHeader header;
+	uint64_t blocks;
+	char **roots;
+	size_t roots_count;
+	char *skip_fs_types;
+};
+/*! @endcond */
+
+static int
+_index_compare_paths(const char *a, const char *b)
+{
+	assert(a != NULL);
+	assert(b != NULL);
+
+	while(*a && *a == *b)
+	{
+		++a;
+		++b;
+	}
+
+	/* sort '/' before any other character to keep subtrees together */
+	int ca = (*a == '/') ? 1 : (unsigned char)*a;
+	int cb = (*b == '/') ? 1 : (unsigned char)*b;
+
+	return ca - cb;
+}
+
+static int
+_index_compare_rows(const void *a, const void *b)
+{
+	return _index_compare_paths(((const IndexRow *)a)->path, ((const IndexRow *)b)->path);
+}
+
+static bool
+_index_stat(const char *path, bool follow, FileInfoStat *sb)
+{
+	assert(path != NULL);
+	assert(sb != NULL);
+
+	bool success;
+
+	#ifdef _LARGEFILE64_SOURCE
+	success = (follow && !stat64(path, sb)) || !lstat64(path, sb);
+	#else
+	success = (follow && !stat(path, sb)) || !lstat(path, sb);
+	#endif
+
+	return success;
+}
+
+static void
+_index_append_row(IndexBuilder *builder, const char *path, const FileInfoStat *sb)
+{
+	assert(builder != NULL);
+	assert(path != NULL);
+	assert(sb != NULL);
+
+	if(builder->count == builder->size)
+	{
+		builder->size = builder->size ? builder->size * 2 : 1024;
+
+		if(builder->rows)
+		{
+			builder->rows = utils_renew(builder->rows, builder->size, IndexRow);
+		}
+		else
+		{
+			builder->rows = utils_new(builder->size, IndexRow);
+		}
+	}
+
+	builder->rows[builder->count].path = utils_strdup(path);
+	builder->rows[builder->count].sb = *sb;
+	++builder->count;
+}
+
+static void
+_index_add_file(IndexBuilder *builder, const char *path)
+{
+	FileInfoStat sb;
+
+	assert(builder != NULL);
+	assert(path != NULL);
+
+	if(_index_stat(path, builder->opts->follow, &sb))
+	{
+		_index_append_row(builder, path, &sb);
+	}
+	else
+	{
+		if(builder->err)
+		{
+			builder->err(path, errno, builder->user_data);
+		}
+
+		builder->failed = true;
+	}
+}
+
+static WalkAction
+_index_visit(const WalkEntry *entry, void *user_data)
+{
+	assert(entry != NULL);
+	assert(user_data != NULL);
+
+	IndexBuilder *builder = user_data;
+
+	/* the status read in batch by the walker doesn't dereference symbolic links */
+	if(entry->stx && (!builder->opts->follow || !S_ISLNK(entry->stx->stx_mode)))
+	{
+		FileInfoStat sb;
+
+		memset(&sb, 0, sizeof(FileInfoStat));
+		file_info_copy_statx(&sb, entry->stx);
+		_index_append_row(builder, entry->path, &sb);
+	}
+	else
+	{
+		_index_add_file(builder, entry->path);
+	}
+
+	return WALK_CONTINUE;
+}
+
+static void
+_index_walk_error(const char *path, int errnum, void *user_data)
+{
+	IndexBuilder *builder = user_data;
+
+	assert(path != NULL);
+	assert(builder != NULL);
+
+	if(builder->err)
+	{
+		builder->err(path, errnum, builder->user_data);
+	}
+
+	builder->failed = true;
+}
+
+static void
+_index_write_varint(FILE *fp, uint64_t value)
+{
+	assert(fp != NULL);
+
+	while(value >= 0x80)
+	{
+		fputc((int)(value & 0x7f) | 0x80, fp);
+		value >>= 7;
+	}
+
+	fputc((int)value, fp);
+}
+
+static void
+_index_write_signed(FILE *fp, int64_t value)
+{
+	_index_write_varint(fp, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static void
+_index_write_string(FILE *fp, const char *str, size_t len)
+{
+	assert(fp != NULL);
+	assert(str != NULL);
+
+	_index_write_varint(fp, len);
+	fwrite(str, 1, len, fp);
+}
+
+static void
+_index_write_stat(FILE *fp, const FileInfoStat *sb)
+{
+	assert(fp != NULL);
+	assert(sb != NULL);
+
+	_index_write_varint(fp, sb->st_mode);
+	_index_write_varint(fp, sb->st_uid);
+	_index_write_varint(fp, sb->st_gid);
+	_index_write_varint(fp, sb->st_nlink);
+	_index_write_varint(fp, sb->st_size);
+	_index_write_varint(fp, sb->st_blocks);
+	_index_write_varint(fp, sb->st_blksize);
+	_index_write_varint(fp, sb->st_ino);
+	_index_write_varint(fp, sb->st_dev);
+	_index_write_varint(fp, sb->st_rdev);
+	_index_write_signed(fp, sb->st_atim.tv_sec);
+	_index_write_varint(fp, sb->st_atim.tv_nsec);
+	_index_write_signed(fp, sb->st_mtim.tv_sec);
+	_index_write_varint(fp, sb->st_mtim.tv_nsec);
+	_index_write_signed(fp, sb->st_ctim.tv_sec);
+	_index_write_varint(fp, sb->st_ctim.tv_nsec);
+}
+
+static void
+_index_write_roots(FILE *fp, char **roots, size_t count, const WalkOptions *opts)
+{
+	assert(fp != NULL);
+	assert(roots != NULL);
+	assert(opts != NULL);
+
+	_index_write_varint(fp, count);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		_index_write_string(fp, roots[i], strlen(roots[i]));
+	}
+
+	const char *fs_types = opts->skip_fs_types ? opts->skip_fs_types : "";
+
+	_index_write_string(fp, fs_types, strlen(fs_types));
+}
+
+static void
+_index_write_records(FILE *fp, const IndexRow *rows, size_t count, uint64_t *table)
+{
+	assert(fp != NULL);
+	assert(rows != NULL || !count);
+	assert(table != NULL || !count);
+
+	const char *prev = "";
+	uint64_t block = 0;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		size_t prefix = 0;
+
+		if(i % INDEX_BLOCK_SIZE)
+		{
+			while(prev[prefix] && prev[prefix] == rows[i].path[prefix])
+			{
+				++prefix;
+			}
+		}
+		else
+		{
+			table[block++] = (uint64_t)ftello(fp);
+		}
+
+		_index_write_varint(fp, prefix);
+		_index_write_string(fp, rows[i].path + prefix, strlen(rows[i].path + prefix));
+		_index_write_stat(fp, &rows[i].sb);
+
+		prev = rows[i].path;
+	}
+}
+
+static bool
+_index_write(const char *filename, char **roots, size_t roots_count, const IndexRow *rows, size_t count, const WalkOptions *opts)
+{
+	bool success = false;
+
+	assert(filename != NULL);
+	assert(roots != NULL);
+	assert(opts != NULL);
+
+	char tmp[PATH_MAX];
+
+	if(snprintf(tmp, sizeof(tmp), "%s.tmp", filename) >= (int)sizeof(tmp))
+	{
+		errno = ENAMETOOLONG;
+		return false;
+	}
+
+	FILE *fp = fopen(tmp, "wb");
+
+	if(fp)
+	{
+		IndexHeader header;
+		uint64_t blocks = (count + INDEX_BLOCK_SIZE - 1) / INDEX_BLOCK_SIZE;
+		uint64_t *table = blocks ? utils_new(blocks, uint64_t) : NULL;
+
+		memset(&header, 0, sizeof(IndexHeader));
+		memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+		header.version = INDEX_VERSION;
+		header.max_depth = opts->max_depth;
+		header.block_size = INDEX_BLOCK_SIZE;
+		header.count = count;
+
+		if(opts->follow)
+		{
+			header.flags |= INDEX_FLAG_FOLLOW;
+		}
+
+		if(opts->one_file_system)
+		{
+			header.flags |= INDEX_FLAG_ONE_FILE_SYSTEM;
+		}
+
+		if(opts->respect_ignore_files)
+		{
+			header.flags |= INDEX_FLAG_RESPECT_IGNORE_FILES;
+		}
+
+		fwrite(&header, sizeof(IndexHeader), 1, fp);
+		_index_write_roots(fp, roots, roots_count, opts);
+
+		header.records_offset = (uint64_t)ftello(fp);
+		_index_write_records(fp, rows, count, table);
+
+		header.table_offset = (uint64_t)ftello(fp);
+
+		if(blocks)
+		{
+			fwrite(table, sizeof(uint64_t), blocks, fp);
+		}
+
+		if(!fseeko(fp, 0, SEEK_SET))
+		{
+			fwrite(&header, sizeof(IndexHeader), 1, fp);
+		}
+
+		success = !ferror(fp);
+
+		free(table);
+
+		if(fclose(fp))
+		{
+			success = false;
+		}
+
+		if(success && rename(tmp, filename))
+		{
+			success = false;
+		}
+
+		if(!success)
+		{
+			int errnum = errno;
+
+			unlink(tmp);
+			errno = errnum;
+		}
+	}
+
+	return success;
+}
+
+static uint64_t
+_index_read_varint(IndexReader *reader)
+{
+	uint64_t value = 0;
+	int shift = 0;
+
+	assert(reader != NULL);
+
+	while(!reader->failed)
+	{
+		if(reader->ptr == reader->end || shift > 63)
+		{
+			reader->failed = true;
+		}
+		else
+		{
+			uint8_t byte = *reader->ptr++;
+
+			value |= (uint64_t)(byte & 0x7f) << shift;
+			shift += 7;
+
+			if(!(byte & 0x80))
+			{
+				break;
+			}
+		}
+	}
+
+	return value;
+}
+
+static int64_t
+_index_read_signed(IndexReader *reader)
+{
+	uint64_t value = _index_read_varint(reader);
+
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static void
+_index_reader_seek(IndexReader *reader, const Index *index, uint64_t block)
+{
+	assert(reader != NULL);
+	assert(index != NULL);
+	assert(block < index->blocks);
+
+	uint64_t offset;
+
+	memcpy(&offset, index->data + index->header.table_offset + block * sizeof(uint64_t), sizeof(uint64_t));
+
+	reader->ptr = index->data + offset;
+	reader->end = index->data + index->header.table_offset;
+	reader->len = 0;
+	reader->failed = offset < index->header.records_offset || offset > index->header.table_offset;
+}
+
+static void
+_index_read_path(IndexReader *reader)
+{
+	assert(reader != NULL);
+
+	uint64_t prefix = _index_read_varint(reader);
+	uint64_t len = _index_read_varint(reader);
+
+	if(!reader->failed)
+	{
+		if(prefix > reader->len || len >= sizeof(reader->path) - prefix || len > (uint64_t)(reader->end - reader->ptr))
+		{
+			reader->failed = true;
+		}
+		else
+		{
+			memcpy(reader->path + prefix, reader->ptr, len);
+			reader->len = prefix + len;
+			reader->path[reader->len] = '\0';
+			reader->ptr += len;
+		}
+	}
+}
+
+static char *
+_index_read_string(IndexReader *reader)
+{
+	char *str = NULL;
+
+	assert(reader != NULL);
+
+	uint64_t len = _index_read_varint(reader);
+
+	if(!reader->failed)
+	{
+		if(len >= PATH_MAX || len > (uint64_t)(reader->end - reader->ptr))
+		{
+			reader->failed = true;
+		}
+		else
+		{
+			str = utils_new(len + 1, char);
+			memcpy(str, reader->ptr, len);
+			reader->ptr += len;
+		}
+	}
+
+	return str;
+}
+
+static void
+_index_read_stat(IndexReader *reader, FileInfoStat *sb)
+{
+	assert(reader != NULL);
+	assert(sb != NULL);
+
+	memset(sb, 0, sizeof(FileInfoStat));
+
+	sb->st_mode = _index_read_varint(reader);
+	sb->st_uid = _index_read_varint(reader);
+	sb->st_gid = _index_read_varint(reader);
+	sb->st_nlink = _index_read_varint(reader);
+	sb->st_size = _index_read_varint(reader);
+	sb->st_blocks = _index_read_varint(reader);
+	sb->st_blksize = _index_read_varint(reader);
+	sb->st_ino = _index_read_varint(reader);
+	sb->st_dev = _index_read_varint(reader);
+	sb->st_rdev = _index_read_varint(reader);
+	sb->st_atim.tv_sec = _index_read_signed(reader);
+	sb->st_atim.tv_nsec = _index_read_varint(reader);
+	sb->st_mtim.tv_sec = _index_read_signed(reader);
+	sb->st_mtim.tv_nsec = _index_read_varint(reader);
+	sb->st_ctim.tv_sec = _index_read_signed(reader);
+	sb->st_ctim.tv_nsec = _index_read_varint(reader);
+}
+
+static char **
+_index_canonicalize_roots(const SList *dirs, size_t *count, IndexBuilder *builder)
+{
+	assert(dirs != NULL);
+	assert(count != NULL);
+	assert(builder != NULL);
+
+	char **roots = utils_new(slist_count(dirs) + 1, char *);
+	SListItem *item = slist_head(dirs);
+
+	*count = 0;
+
+	while(item)
+	{
+		const char *dir = slist_item_get_data(item);
+		char *root = realpath(dir, NULL);
+
+		if(root)
+		{
+			roots[(*count)++] = root;
+		}
+		else
+		{
+			_index_walk_error(dir, errno, builder);
+		}
+
+		item = slist_item_next(item);
+	}
+
+	return roots;
+}
+
+static size_t
+_index_remove_duplicates(IndexRow *rows, size_t count)
+{
+	size_t n = 0;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(n && !strcmp(rows[n - 1].path, rows[i].path))
+		{
+			free(rows[i].path);
+		}
+		else
+		{
+			rows[n++] = rows[i];
+		}
+	}
+
+	return n;
+}
+
+static bool
+_index_build(const char *filename, char **roots, size_t roots_count, WalkCallback cb, IndexBuilder *builder)
+{
+	assert(filename != NULL);
+	assert(roots != NULL);
+	assert(cb != NULL);
+	assert(builder != NULL);
+
+	for(size_t i = 0; i < roots_count; ++i)
+	{
+		DEBUGF("index", "Indexing directory: %s", roots[i]);
+
+		walk(roots[i], builder->opts, cb, _index_walk_error, builder);
+	}
+
+	DEBUGF("index", "Sorting %zu file(s), %zu record(s) reused.", builder->count, builder->reused);
+
+	if(builder->count)
+	{
+		qsort(builder->rows, builder->count, sizeof(IndexRow), _index_compare_rows);
+		builder->count = _index_remove_duplicates(builder->rows, builder->count);
+	}
+
+	DEBUGF("index", "Writing index: %s", filename);
+
+	if(!_index_write(filename, roots, roots_count, builder->rows, builder->count, builder->opts))
+	{
+		ERRORF("index", "Couldn't write index `%s', errno=%d.", filename, errno);
+
+		if(builder->err)
+		{
+			builder->err(filename, errno, builder->user_data);
+		}
+
+		builder->failed = true;
+	}
+
+	for(size_t i = 0; i < builder->count; ++i)
+	{
+		free(builder->rows[i].path);
+	}
+
+	free(builder->rows);
+
+	return !builder->failed;
+}
+
+bool
+index_build(const char *filename, const SList *dirs, const WalkOptions *opts, WalkErrorCallback err, void *user_data)
+{
+	IndexBuilder builder;
+	size_t roots_count;
+
+	assert(filename != NULL);
+	assert(dirs != NULL);
+	assert(opts != NULL);
+
+	memset(&builder, 0, sizeof(IndexBuilder));
+
+	builder.opts = opts;
+	builder.err = err;
+	builder.user_data = user_data;
+
+	char **roots = _index_canonicalize_roots(dirs, &roots_count, &builder);
+
+	_index_build(filename, roots, roots_count, _index_visit, &builder);
+
+	for(size_t i = 0; i < roots_count; ++i)
+	{
+		free(roots[i]);
+	}
+
+	free(roots);
+
+	return !builder.failed;
+}
+
+static bool
+_index_is_descendant(const char *path, const char *dir, size_t dir_len)
+{
+	assert(path != NULL);
+	assert(dir != NULL);
+
+	bool result;
+
+	if(dir_len == 1 && *dir == '/')
+	{
+		result = *path == '/' && path[1];
+	}
+	else
+	{
+		result = !strncmp(path, dir, dir_len) && path[dir_len] == '/';
+	}
+
+	return result;
+}
+
+static IndexRow *
+_index_load_rows(const Index *index, size_t *count)
+{
+	IndexReader reader;
+	IndexRow *rows = NULL;
+
+	assert(index != NULL);
+	assert(count != NULL);
+
+	*count = 0;
+
+	if(index->header.count)
+	{
+		memset(&reader, 0, sizeof(IndexReader));
+		_index_reader_seek(&reader, index, 0);
+
+		rows = utils_new(index->header.count, IndexRow);
+
+		while(*count < index->header.count && !reader.failed)
+		{
+			_index_read_path(&reader);
+			_index_read_stat(&reader, &rows[*count].sb);
+
+			if(!reader.failed)
+			{
+				rows[*count].path = utils_strdup(reader.path);
+				++(*count);
+			}
+		}
+
+		if(reader.failed)
+		{
+			for(size_t i = 0; i < *count; ++i)
+			{
+				free(rows[i].path);
+			}
+
+			free(rows);
+			rows = NULL;
+		}
+	}
+
+	return rows;
+}
+
+static size_t *
+_index_find_subtree_ends(const IndexRow *rows, size_t count)
+{
+	size_t *ends = utils_new(count + 1, size_t);
+	size_t *stack = utils_new(count + 1, size_t);
+	size_t depth = 0;
+
+	assert(rows != NULL || !count);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		while(depth && !_index_is_descendant(rows[i].path, rows[stack[depth - 1]].path, strlen(rows[stack[depth - 1]].path)))
+		{
+			ends[stack[--depth]] = i;
+		}
+
+		ends[i] = i + 1;
+
+		if(S_ISDIR(rows[i].sb.st_mode))
+		{
+			stack[depth++] = i;
+		}
+	}
+
+	while(depth)
+	{
+		ends[stack[--depth]] = count;
+	}
+
+	free(stack);
+
+	return ends;
+}
+
+static bool
+_index_find_old_row(const IndexBuilder *builder, const char *path, size_t *pos)
+{
+	size_t lo = 0;
+	size_t hi = builder->old_count;
+	bool found = false;
+
+	assert(builder != NULL);
+	assert(path != NULL);
+	assert(pos != NULL);
+
+	while(lo < hi && !found)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = _index_compare_paths(builder->old_rows[mid].path, path);
+
+		if(!cmp)
+		{
+			*pos = mid;
+			found = true;
+		}
+		else if(cmp < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return found;
+}
+
+static bool
+_index_dir_is_unchanged(const FileInfoStat *a, const FileInfoStat *b)
+{
+	assert(a != NULL);
+	assert(b != NULL);
+
+	return S_ISDIR(a->st_mode) && S_ISDIR(b->st_mode)
+	       && a->st_dev == b->st_dev && a->st_ino == b->st_ino
+	       && a->st_mtim.tv_sec == b->st_mtim.tv_sec && a->st_mtim.tv_nsec == b->st_mtim.tv_nsec
+	       && a->st_ctim.tv_sec == b->st_ctim.tv_sec && a->st_ctim.tv_nsec == b->st_ctim.tv_nsec;
+}
+
+static void
+_index_push_dir(IndexBuilder *builder, const char *path, bool cached)
+{
+	assert(builder != NULL);
+	assert(path != NULL);
+
+	if(builder->dirs_count == builder->dirs_size)
+	{
+		builder->dirs_size = builder->dirs_size ? builder->dirs_size * 2 : 64;
+
+		if(builder->dirs)
+		{
+			builder->dirs = utils_renew(builder->dirs, builder->dirs_size, IndexDir);
+		}
+		else
+		{
+			builder->dirs = utils_new(builder->dirs_size, IndexDir);
+		}
+	}
+
+	builder->dirs[builder->dirs_count].path = utils_strdup(path);
+	builder->dirs[builder->dirs_count].cached = cached;
+	++builder->dirs_count;
+}
+
+static void
+_index_pop_dirs(IndexBuilder *builder, size_t count)
+{
+	assert(builder != NULL);
+	assert(count <= builder->dirs_count);
+
+	while(builder->dirs_count > count)
+	{
+		free(builder->dirs[--builder->dirs_count].path);
+	}
+}
+
+static bool
+_index_parent_is_cached(IndexBuilder *builder, const char *path)
+{
+	assert(builder != NULL);
+	assert(path != NULL);
+
+	/* directories are visited depth-first, leave all directories which aren't ancestors */
+	while(builder->dirs_count)
+	{
+		const char *dir = builder->dirs[builder->dirs_count - 1].path;
+
+		if(_index_is_descendant(path, dir, strlen(dir)))
+		{
+			break;
+		}
+
+		_index_pop_dirs(builder, builder->dirs_count - 1);
+	}
+
+	return builder->dirs_count && builder->dirs[builder->dirs_count - 1].cached;
+}
+
+static int
+_index_compare_strings(const void *a, const void *b)
+{
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static bool
+_index_is_dirty(const IndexBuilder *builder, const char *path)
+{
+	assert(builder != NULL);
+	assert(path != NULL);
+
+	return builder->dirty_count && bsearch(&path, builder->dirty, builder->dirty_count, sizeof(char *), _index_compare_strings);
+}
+
+static WalkAction
+_index_refresh_visit(const WalkEntry *entry, void *user_data)
+{
+	IndexBuilder *builder = user_data;
+	size_t pos;
+
+	assert(entry != NULL);
+	assert(builder != NULL);
+
+	/* watched directories which haven't been reported as changed don't need to be read */
+	bool cached = _index_parent_is_cached(builder, entry->path)
+	              && (!entry->is_dir || (builder->watched && !_index_is_dirty(builder, entry->path)));
+
+	if(cached && _index_find_old_row(builder, entry->path, &pos))
+	{
+		_index_append_row(builder, entry->path, &builder->old_rows[pos].sb);
+		++builder->reused;
+	}
+	else
+	{
+		_index_add_file(builder, entry->path);
+	}
+
+	return WALK_CONTINUE;
+}
+
+static bool
+_index_refresh_list(const char *path, WalkListing *listing, void *user_data)
+{
+	IndexBuilder *builder = user_data;
+	size_t pos;
+	bool cached = false;
+
+	assert(path != NULL);
+	assert(listing != NULL);
+	assert(builder != NULL);
+
+	if(builder->watched)
+	{
+		cached = _index_find_old_row(builder, path, &pos)
+		         && S_ISDIR(builder->old_rows[pos].sb.st_mode)
+		         && !_index_is_dirty(builder, path);
+	}
+	else
+	{
+		/* the directory has just been visited, so its current status is the last row */
+		cached = builder->count && !strcmp(builder->rows[builder->count - 1].path, path)
+		         && _index_find_old_row(builder, path, &pos)
+		         && _index_dir_is_unchanged(&builder->old_rows[pos].sb, &builder->rows[builder->count - 1].sb);
+	}
+
+	if(cached)
+	{
+		size_t offset = strlen(path);
+
+		if(offset > 1)
+		{
+			++offset;
+		}
+
+		for(size_t i = pos + 1; i < builder->old_ends[pos]; i = builder->old_ends[i])
+		{
+			walk_listing_append(listing, builder->old_rows[i].path + offset, IFTODT(builder->old_rows[i].sb.st_mode));
+		}
+	}
+
+	TRACEF("index", "Directory `%s' changed: %d", path, !cached);
+
+	_index_parent_is_cached(builder, path);
+	_index_push_dir(builder, path, cached);
+
+	return cached;
+}
+
+static bool
+_index_refresh(const char *filename, bool deep_scan, char **dirty, size_t dirty_count, bool watched, WalkErrorCallback err, void *user_data)
+{
+	IndexBuilder builder;
+	WalkOptions opts;
+
+	assert(filename != NULL);
+
+	Index *index = index_open(filename);
+
+	if(!index)
+	{
+		if(err)
+		{
+			err(filename, errno, user_data);
+		}
+
+		return false;
+	}
+
+	memset(&builder, 0, sizeof(IndexBuilder));
+
+	index_get_walk_options(index, &opts);
+
+	builder.opts = &opts;
+	builder.dirty = dirty;
+	builder.dirty_count = dirty_count;
+	builder.watched = watched;
+	builder.err = err;
+	builder.user_data = user_data;
+
+	if(deep_scan)
+	{
+		DEBUG("index", "Rescanning all indexed files.");
+
+		_index_build(filename, index->roots, index->roots_count, _index_visit, &builder);
+	}
+	else
+	{
+		builder.old_rows = _index_load_rows(index, &builder.old_count);
+
+		if(builder.old_rows || !index->header.count)
+		{
+			builder.old_ends = _index_find_subtree_ends(builder.old_rows, builder.old_count);
+			opts.list = _index_refresh_list;
+
+			_index_build(filename, index->roots, index->roots_count, _index_refresh_visit, &builder);
+		}
+		else
+		{
+			ERRORF("index", "Index `%s' is corrupt.", filename);
+
+			if(err)
+			{
+				err(filename, EINVAL, user_data);
+			}
+
+			builder.failed = true;
+		}
+
+		for(size_t i = 0; i < builder.old_count; ++i)
+		{
+			free(builder.old_rows[i].path);
+		}
+
+		free(builder.old_rows);
+		free(builder.old_ends);
+		_index_pop_dirs(&builder, 0);
+		free(builder.dirs);
+	}
+
+	index_close(index);
+
+	return !builder.failed;
+}
+
+bool
+index_refresh(const char *filename, bool deep_scan, WalkErrorCallback err, void *user_data)
+{
+	assert(filename != NULL);
+
+	return _index_refresh(filename, deep_scan, NULL, 0, false, err, user_data);
+}
+
+bool
+index_update(const char *filename, char *const *dirs, size_t count, WalkErrorCallback err, void *user_data)
+{
+	assert(filename != NULL);
+	assert(dirs != NULL || !count);
+
+	char **dirty = utils_new(count + 1, char *);
+
+	if(count)
+	{
+		memcpy(dirty, dirs, sizeof(char *) * count);
+		qsort(dirty, count, sizeof(char *), _index_compare_strings);
+	}
+
+	DEBUGF("index", "Updating %zu changed director(ies).", count);
+
+	bool success = _index_refresh(filename, false, dirty, count, true, err, user_data);
+
+	free(dirty);
+
+	return success;
+}
+
+static bool
+_index_read_roots(Index *index)
+{
+	IndexReader reader;
+
+	assert(index != NULL);
+
+	memset(&reader, 0, sizeof(IndexReader));
+
+	reader.ptr = index->data + sizeof(IndexHeader);
+	reader.end = index->data + index->header.records_offset;
+	reader.failed = index->header.records_offset < sizeof(IndexHeader);
+
+	uint64_t count = _index_read_varint(&reader);
+
+	if(!reader.failed && count <= (uint64_t)(reader.end - reader.ptr))
+	{
+		index->roots = utils_new(count + 1, char *);
+
+		while(index->roots_count < count && !reader.failed)
+		{
+			char *root = _index_read_string(&reader);
+
+			if(root)
+			{
+				index->roots[index->roots_count++] = root;
+			}
+		}
+
+		index->skip_fs_types = _index_read_string(&reader);
+	}
+
+	return !reader.failed && index->skip_fs_types;
+}
+
+Index *
+index_open(const char *filename)
+{
+	Index *index = NULL;
+
+	assert(filename != NULL);
+
+	int fd = open(filename, O_RDONLY);
+
+	if(fd != -1)
+	{
+		struct stat sb;
+
+		if(fstat(fd, &sb))
+		{
+			ERRORF("index", "Couldn't stat index `%s', errno=%d.", filename, errno);
+		}
+		else if((size_t)sb.st_size < sizeof(IndexHeader))
+		{
+			ERRORF("index", "Invalid index file: %s", filename);
+			errno = EINVAL;
+		}
+		else
+		{
+			void *data = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if(data != MAP_FAILED)
+			{
+				index = utils_new(1, Index);
+				index->data = data;
+				index->size = sb.st_size;
+
+				memcpy(&index->header, data, sizeof(IndexHeader));
+
+				index->blocks = index->header.block_size ? (index->header.count + index->header.block_size - 1) / index->header.block_size : 0;
+
+				if(memcmp(index->header.magic, INDEX_MAGIC, sizeof(index->header.magic))
+				   || index->header.version != INDEX_VERSION
+				   || !index->header.block_size
+				   || index->header.records_offset > index->header.table_offset
+				   || index->header.table_offset > index->size
+				   || (index->size - index->header.table_offset) / sizeof(uint64_t) < index->blocks)
+				{
+					ERRORF("index", "Invalid index file: %s", filename);
+					index_close(index);
+					index = NULL;
+					errno = EINVAL;
+				}
+				else if(!_index_read_roots(index))
+				{
+					ERRORF("index", "Couldn't read starting points from index: %s", filename);
+					index_close(index);
+					index = NULL;
+					errno = EINVAL;
+				}
+			}
+		}
+
+		close(fd);
+	}
+
+	return index;
+}
+
+void
+index_get_walk_options(const Index *index, WalkOptions *opts)
+{
+	assert(index != NULL);
+	assert(opts != NULL);
+
+	memset(opts, 0, sizeof(WalkOptions));
+
+	opts->max_depth = index->header.max_depth;
+	opts->follow = (index->header.flags & INDEX_FLAG_FOLLOW) != 0;
+	opts->one_file_system = (index->header.flags & INDEX_FLAG_ONE_FILE_SYSTEM) != 0;
+	opts->respect_ignore_files = (index->header.flags & INDEX_FLAG_RESPECT_IGNORE_FILES) != 0;
+	opts->skip_fs_types = *index->skip_fs_types ? index->skip_fs_types : NULL;
+}
+
+char *const *
+index_get_roots(const Index *index, size_t *count)
+{
+	assert(index != NULL);
+	assert(count != NULL);
+
+	*count = index->roots_count;
+
+	return index->roots;
+}
+
+void
+index_close(Index *index)
+{
+	if(index)
+	{
+		for(size_t i = 0; i < index->roots_count; ++i)
+		{
+			free(index->roots[i]);
+		}
+
+		free(index->roots);
+		free(index->skip_fs_types);
+		munmap(index->data, index->size);
+		free(index);
+	}
+}
+
+static uint64_t
+_index_find_block(const Index *index, const char *path, IndexReader *reader)
+{
+	uint64_t lo = 0;
+	uint64_t hi = index->blocks;
+
+	assert(index != NULL);
+	assert(path != NULL);
+	assert(reader != NULL);
+
+	/* find the last block starting with a path less than or equal to the given one */
+	while(lo < hi && !reader->failed)
+	{
+		uint64_t mid = lo + (hi - lo) / 2;
+
+		_index_reader_seek(reader, index, mid);
+		_index_read_path(reader);
+
+		if(_index_compare_paths(reader->path, path) <= 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	return lo ? lo - 1 : 0;
+}
+
+static void
+_index_strip_trailing_slashes(char *path)
+{
+	assert(path != NULL);
+
+	size_t len = strlen(path);
+
+	while(len > 1 && path[len - 1] == '/')
+	{
+		path[--len] = '\0';
+	}
+}
+
+static int32_t
+_index_depth(const char *rel)
+{
+	int32_t depth = 0;
+
+	assert(rel != NULL);
+
+	for(; *rel; ++rel)
+	{
+		if(*rel == '/')
+		{
+			++depth;
+		}
+	}
+
+	return depth;
+}
+
+bool
+index_query(Index *index, const char *path, int32_t max_depth, IndexCallback cb, void *user_data)
+{
+	IndexReader reader;
+	char root[PATH_MAX];
+	char prefix[PATH_MAX];
+	char out[PATH_MAX];
+	char skip[PATH_MAX];
+	size_t skip_len = 0;
+	bool stop = false;
+
+	assert(index != NULL);
+	assert(path != NULL);
+	assert(cb != NULL);
+
+	if(!realpath(path, root))
+	{
+		if(strlen(path) >= sizeof(root))
+		{
+			return true;
+		}
+
+		strcpy(root, path);
+		_index_strip_trailing_slashes(root);
+	}
+
+	/* found paths start with the given starting point instead of the canonical one */
+	strcpy(prefix, path);
+	_index_strip_trailing_slashes(prefix);
+
+	if(!strcmp(prefix, "/"))
+	{
+		*prefix = '\0';
+	}
+
+	size_t root_len = strcmp(root, "/") ? strlen(root) : 0;
+
+	TRACEF("index", "Querying index: path=%s, root=%s", path, root);
+
+	if(!index->blocks)
+	{
+		return true;
+	}
+
+	memset(&reader, 0, sizeof(IndexReader));
+
+	uint64_t block = _index_find_block(index, root, &reader);
+
+	_index_reader_seek(&reader, index, block);
+
+	for(uint64_t i = block * index->header.block_size; i < index->header.count && !stop && !reader.failed; ++i)
+	{
+		FileInfoStat sb;
+
+		_index_read_path(&reader);
+		_index_read_stat(&reader, &sb);
+
+		if(reader.failed)
+		{
+			break;
+		}
+
+		if(strncmp(reader.path, root, root_len) || (reader.path[root_len] && reader.path[root_len] != '/'))
+		{
+			stop = _index_compare_paths(reader.path, root) > 0;
+			continue;
+		}
+
+		if(skip_len)
+		{
+			if(!strncmp(reader.path, skip, skip_len) && reader.path[skip_len] == '/')
+			{
+				continue;
+			}
+
+			skip_len = 0;
+		}
+
+		IndexEntry entry;
+		bool is_root = !strcmp(reader.path, root);
+
+		entry.depth = is_root ? 0 : _index_depth(reader.path + root_len);
+
+		if(max_depth >= 0 && entry.depth > max_depth)
+		{
+			continue;
+		}
+
+		if(is_root)
+		{
+			entry.path = path;
+		}
+		else if(snprintf(out, sizeof(out), "%s%s", prefix, reader.path + root_len) < (int)sizeof(out))
+		{
+			entry.path = out;
+		}
+		else
+		{
+			continue;
+		}
+
+		entry.sb = &sb;
+
+		WalkAction action = cb(&entry, user_data);
+
+		if(action == WALK_STOP)
+		{
+			stop = true;
+		}
+		else if(action == WALK_SKIP && !root_len && is_root)
+		{
+			stop = true;
+		}
+		else if(action == WALK_SKIP && S_ISDIR(sb.st_mode))
+		{
+			memcpy(skip, reader.path, reader.len + 1);
+			skip_len = reader.len;
+		}
+	}
+
+	if(reader.failed)
+	{
+		ERROR("index", "Index is corrupt.");
+	}
+
+	return !reader.failed;
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file index.h
+   @brief Persistent file index.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef INDEX_H
+#define INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <datatypes.h>
+
+#include "fileinfo.h"
+#include "walk.h"
+
+/**
+   @struct IndexEntry
+   @brief A file found in an index.
+ */
+typedef struct
+{
+	/*! Path of the file below the queried starting point. */
+	const char *path;
+	/*! Depth relative to the starting point. */
+	int32_t depth;
+	/*! Indexed file status. */
+	const FileInfoStat *sb;
+} IndexEntry;
+
+/**
+   @typedef IndexCallback
+   @brief Function called for each file found in an index in pre-order.
+ */
+typedef WalkAction (*IndexCallback)(const IndexEntry *entry, void *user_data);
+
+/**
+   @struct Index
+   @brief An opened index file.
+ */
+typedef struct _Index Index;
+
+/**
+   @param filename index file to write
+   @param dirs list of directories to index
+   @param opts walker options
+   @param err function called for each failure
+   @param user_data user data
+   @return false if the index couldn't be written or a file couldn't be accessed
+
+   Walks the given directories and writes the paths and file status of all found
+   files to an index. Paths are stored canonicalized and sorted, so each subtree
+   occupies a contiguous range of records. The index file is replaced atomically.
+ */
+bool index_build(const char *filename, const SList *dirs, const WalkOptions *opts, WalkErrorCallback err, void *user_data);
+
+/**
+   @param filename index file to refresh
+   @param deep_scan true to read the status of all indexed files
+   @param err function called for each failure
+   @param user_data user data
+   @return false if the index couldn't be written or a file couldn't be accessed
+
+   Refreshes an index with the starting points and options it was built with.
+   Directories whose modification and status change times haven't changed are
+   not read again, the indexed status of their files is kept. Only files of
+   changed directories are read. A deep scan re-reads the status of all files.
+ */
+bool index_refresh(const char *filename, bool deep_scan, WalkErrorCallback err, void *user_data);
+
+/**
+   @param filename index file to update
+   @param dirs changed directories
+   @param count number of changed directories
+   @param err function called for each failure
+   @param user_data user data
+   @return false if the index couldn't be written or a file couldn't be accessed
+
+   Updates an index with reported changes, e.g. from a filesystem watcher.
+   Only the given directories are read again, the indexed entries and status
+   of all other directories are kept without accessing them.
+ */
+bool index_update(const char *filename, char *const *dirs, size_t count, WalkErrorCallback err, void *user_data);
+
+/**
+   @param filename index file to open
+   @return a new Index or NULL on failure
+
+   Opens an index file.
+ */
+Index *index_open(const char *filename);
+
+/**
+   @param index an Index
+   @param opts location to store the walker options to
+
+   Gets the walker options an index was built with.
+ */
+void index_get_walk_options(const Index *index, WalkOptions *opts);
+
+/**
+   @param index an Index
+   @param count location to store the number of starting points to
+   @return canonical starting points
+
+   Gets the starting points an index was built with.
+ */
+char *const *index_get_roots(const Index *index, size_t *count);
+
+/**
+   @param index Index to close
+
+   Closes an index file.
+ */
+void index_close(Index *index);
+
+/**
+   @param index an Index
+   @param path starting point
+   @param max_depth directory search level limitation, negative for no limitation
+   @param cb function called for each found file
+   @param user_data user data
+   @return false if the index is corrupt
+
+   Lists all indexed files found below the given starting point like the walker does.
+   Returned paths start with the given starting point.
+ */
+bool index_query(Index *index, const char *path, int32_t max_depth, IndexCallback cb, void *user_data);
+
+#endif
+
@@ -0,0 +1,567 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file indexd.c
+   @brief Keep a file index up to date and serve queries.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <assert.h>
+#include <datatypes.h>
+
+#include "indexd.h"
+#include "index.h"
+#include "walk.h"
+#include "utils.h"
+#include "log.h"
+#include "gettext.h"
+
+/*! @cond INTERNAL */
+/* milliseconds to wait for further changes before the index is updated */
+#define INDEXD_DELAY         250
+/* maximum milliseconds changes are delayed */
+#define INDEXD_MAX_DELAY     2000
+
+#define INDEXD_WATCH_MASK    (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_ATTRIB \
+                              | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR)
+
+typedef struct
+{
+	const char *filename;
+	int fd;
+	WalkOptions opts;
+	AssocArray *watches;
+	AssocArray *dirty;
+	bool rescan;
+	bool exhausted;
+	pid_t updater;
+	int updater_fd;
+	bool rewatch;
+	int64_t first_change;
+	int64_t last_change;
+} IndexDaemon;
+/*! @endcond */
+
+static int64_t
+_indexd_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void
+_indexd_error(const char *path, int errnum, void *user_data)
+{
+	assert(path != NULL);
+
+	/* files often disappear before changes are processed */
+	DEBUGF("indexd", "Couldn't access `%s', errno=%d.", path, errnum);
+}
+
+static void
+_indexd_add_watch(IndexDaemon *daemon, const char *path)
+{
+	assert(daemon != NULL);
+	assert(path != NULL);
+
+	uint32_t mask = INDEXD_WATCH_MASK;
+
+	if(!daemon->opts.follow)
+	{
+		mask |= IN_DONT_FOLLOW;
+	}
+
+	int wd = inotify_add_watch(daemon->fd, path, mask);
+
+	if(wd != -1)
+	{
+		TRACEF("indexd", "Watching directory `%s' (wd=%d).", path, wd);
+		assoc_array_set(daemon->watches, (void *)(intptr_t)wd, utils_strdup(path), true);
+	}
+	else if(errno == ENOSPC && !daemon->exhausted)
+	{
+		WARNING("indexd", "Inotify watch limit reached.");
+		fprintf(stderr, _("Couldn't watch all directories, consider raising fs.inotify.max_user_watches.\n"));
+		daemon->exhausted = true;
+	}
+}
+
+static WalkAction
+_indexd_watch_indexed_dir(const IndexEntry *entry, void *user_data)
+{
+	assert(entry != NULL);
+
+	if(S_ISDIR(entry->sb->st_mode))
+	{
+		_indexd_add_watch(user_data, entry->path);
+	}
+
+	return WALK_CONTINUE;
+}
+
+static bool
+_indexd_watch_index(IndexDaemon *daemon)
+{
+	bool success = false;
+
+	assert(daemon != NULL);
+
+	Index *index = index_open(daemon->filename);
+
+	if(index)
+	{
+		size_t count;
+		char *const *roots = index_get_roots(index, &count);
+
+		index_get_walk_options(index, &daemon->opts);
+
+		success = true;
+
+		for(size_t i = 0; i < count && success; ++i)
+		{
+			success = index_query(index, roots[i], -1, _indexd_watch_indexed_dir, daemon);
+		}
+
+		/* the walker options point to the index */
+		daemon->opts.skip_fs_types = NULL;
+
+		index_close(index);
+
+		DEBUGF("indexd", "Watching %zu director(ies).", assoc_array_count(daemon->watches));
+	}
+
+	return success;
+}
+
+static WalkAction
+_indexd_watch_new_dir(const WalkEntry *entry, void *user_data)
+{
+	assert(entry != NULL);
+
+	if(entry->is_dir)
+	{
+		_indexd_add_watch(user_data, entry->path);
+	}
+
+	return WALK_CONTINUE;
+}
+
+static void
+_indexd_mark_dirty(IndexDaemon *daemon, const char *path)
+{
+	assert(daemon != NULL);
+	assert(path != NULL);
+
+	if(!assoc_array_key_exists(daemon->dirty, path))
+	{
+		TRACEF("indexd", "Directory changed: %s", path);
+		assoc_array_set(daemon->dirty, utils_strdup(path), NULL, true);
+	}
+}
+
+static void
+_indexd_mark_parent_dirty(IndexDaemon *daemon, const char *path)
+{
+	char parent[PATH_MAX];
+
+	assert(daemon != NULL);
+	assert(path != NULL);
+
+	if(strlen(path) < sizeof(parent))
+	{
+		strcpy(parent, path);
+
+		char *offset = strrchr(parent, '/');
+
+		if(offset)
+		{
+			offset[offset == parent] = '\0';
+			_indexd_mark_dirty(daemon, parent);
+		}
+	}
+}
+
+static void
+_indexd_process_event(IndexDaemon *daemon, const struct inotify_event *event)
+{
+	assert(daemon != NULL);
+	assert(event != NULL);
+
+	if(event->mask & IN_Q_OVERFLOW)
+	{
+		WARNING("indexd", "Inotify event queue overflowed.");
+		daemon->rescan = true;
+	}
+	else
+	{
+		AssocArrayPair *pair = assoc_array_lookup(daemon->watches, (void *)(intptr_t)event->wd);
+
+		if(pair)
+		{
+			char *path = assoc_array_pair_get_value(pair);
+
+			if(event->mask & IN_IGNORED)
+			{
+				TRACEF("indexd", "Watch removed: %s", path);
+				assoc_array_remove(daemon->watches, (void *)(intptr_t)event->wd);
+			}
+			else if(event->len)
+			{
+				_indexd_mark_dirty(daemon, path);
+
+				if((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+				{
+					char child[PATH_MAX];
+
+					if(utils_path_join(path, event->name, child, sizeof(child)))
+					{
+						walk(child, &daemon->opts, _indexd_watch_new_dir, NULL, daemon);
+					}
+				}
+			}
+			else
+			{
+				/* the watched directory itself changed */
+				_indexd_mark_dirty(daemon, path);
+				_indexd_mark_parent_dirty(daemon, path);
+			}
+		}
+	}
+}
+
+static void
+_indexd_read_events(IndexDaemon *daemon)
+{
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t len;
+
+	assert(daemon != NULL);
+
+	while((len = read(daemon->fd, buffer, sizeof(buffer))) > 0)
+	{
+		const char *ptr = buffer;
+
+		while(ptr < buffer + len)
+		{
+			const struct inotify_event *event = (const struct inotify_event *)ptr;
+
+			_indexd_process_event(daemon, event);
+			ptr += sizeof(struct inotify_event) + event->len;
+		}
+
+		int64_t now = _indexd_now();
+
+		if(!daemon->first_change)
+		{
+			daemon->first_change = now;
+		}
+
+		daemon->last_change = now;
+	}
+}
+
+static bool
+_indexd_write_changes(IndexDaemon *daemon, bool refresh)
+{
+	bool success;
+
+	assert(daemon != NULL);
+
+	if(refresh)
+	{
+		INFO("indexd", "Refreshing indexed directories.");
+
+		/* changes may have been lost, read all directories with a new modification time */
+		success = index_refresh(daemon->filename, false, _indexd_error, NULL);
+	}
+	else
+	{
+		size_t count = assoc_array_count(daemon->dirty);
+		char **dirs = utils_new(count + 1, char *);
+		AssocArrayIter iter;
+		size_t i = 0;
+
+		assoc_array_iter_init(daemon->dirty, &iter);
+
+		while(assoc_array_iter_next(&iter) && i < count)
+		{
+			dirs[i++] = assoc_array_iter_get_key(&iter);
+		}
+
+		success = index_update(daemon->filename, dirs, i, _indexd_error, NULL);
+
+		free(dirs);
+	}
+
+	return success;
+}
+
+static void
+_indexd_updater_finished(IndexDaemon *daemon)
+{
+	char status = 0;
+
+	assert(daemon != NULL);
+	assert(daemon->updater_fd != -1);
+
+	if(read(daemon->updater_fd, &status, 1) != 1)
+	{
+		WARNINGF("indexd", "Updater process %ld failed.", (long)daemon->updater);
+	}
+
+	close(daemon->updater_fd);
+	waitpid(daemon->updater, NULL, WNOHANG);
+
+	DEBUGF("indexd", "Updater process %ld finished, status=%d.", (long)daemon->updater, status);
+
+	daemon->updater = 0;
+	daemon->updater_fd = -1;
+
+	if(status && daemon->rewatch)
+	{
+		_indexd_watch_index(daemon);
+	}
+
+	daemon->rewatch = false;
+}
+
+static void
+_indexd_apply_changes(IndexDaemon *daemon)
+{
+	int fds[2];
+
+	assert(daemon != NULL);
+	assert(daemon->updater_fd == -1);
+
+	/* the index is rewritten in a child process, requests are served from the old file meanwhile */
+	fflush(stdout);
+	fflush(stderr);
+
+	pid_t pid = -1;
+
+	if(!pipe2(fds, O_CLOEXEC))
+	{
+		pid = fork();
+
+		if(pid == 0)
+		{
+			close(fds[0]);
+
+			char status = _indexd_write_changes(daemon, daemon->rescan);
+
+			if(write(fds[1], &status, 1) != 1)
+			{
+				_exit(EXIT_FAILURE);
+			}
+
+			_exit(EXIT_SUCCESS);
+		}
+
+		close(fds[1]);
+
+		if(pid == -1)
+		{
+			close(fds[0]);
+		}
+	}
+
+	if(pid > 0)
+	{
+		DEBUGF("indexd", "Updating index in child process %ld.", (long)pid);
+
+		daemon->updater = pid;
+		daemon->updater_fd = fds[0];
+		daemon->rewatch = daemon->rescan;
+	}
+	else
+	{
+		ERRORF("indexd", "Couldn't start updater process, errno=%d.", errno);
+
+		if(_indexd_write_changes(daemon, daemon->rescan) && daemon->rescan)
+		{
+			_indexd_watch_index(daemon);
+		}
+	}
+
+	assoc_array_clear(daemon->dirty);
+	daemon->rescan = false;
+	daemon->first_change = 0;
+	daemon->last_change = 0;
+}
+
+static int
+_indexd_get_timeout(const IndexDaemon *daemon)
+{
+	int timeout = -1;
+
+	assert(daemon != NULL);
+
+	/* changes are collected until the running update has been written */
+	if(daemon->first_change && daemon->updater_fd == -1)
+	{
+		int64_t now = _indexd_now();
+		int64_t delay = daemon->last_change + INDEXD_DELAY - now;
+		int64_t max_delay = daemon->first_change + INDEXD_MAX_DELAY - now;
+
+		timeout = (int)(delay < max_delay ? delay : max_delay);
+
+		if(timeout < 0)
+		{
+			timeout = 0;
+		}
+	}
+
+	return timeout;
+}
+
+static void
+_indexd_run_loop(IndexDaemon *daemon, Server *server, ServerHandler handler, void *user_data)
+{
+	assert(daemon != NULL);
+	assert(server != NULL);
+	assert(handler != NULL);
+
+	while(!server_stop_requested())
+	{
+		struct pollfd fds[3];
+
+		fds[0].fd = server_get_fd(server);
+		fds[0].events = POLLIN;
+		fds[1].fd = daemon->fd;
+		fds[1].events = POLLIN;
+		fds[2].fd = daemon->updater_fd;
+		fds[2].events = POLLIN;
+
+		int rc = poll(fds, 3, _indexd_get_timeout(daemon));
+
+		if(rc > 0)
+		{
+			if(fds[1].revents & POLLIN)
+			{
+				_indexd_read_events(daemon);
+			}
+
+			if(fds[2].revents & (POLLIN | POLLHUP))
+			{
+				_indexd_updater_finished(daemon);
+			}
+
+			if(fds[0].revents & POLLIN)
+			{
+				server_accept(server, handler, user_data);
+			}
+		}
+		else if(rc == -1 && errno != EINTR)
+		{
+			ERRORF("indexd", "`poll' failed, errno=%d.", errno);
+			break;
+		}
+
+		if(daemon->first_change && daemon->updater_fd == -1 && !_indexd_get_timeout(daemon))
+		{
+			_indexd_apply_changes(daemon);
+		}
+	}
+}
+
+bool
+index_daemon_run(const char *filename, const char *socket, ServerHandler handler, void *user_data)
+{
+	IndexDaemon daemon;
+	bool success = false;
+
+	assert(filename != NULL);
+	assert(socket != NULL);
+	assert(handler != NULL);
+
+	memset(&daemon, 0, sizeof(IndexDaemon));
+
+	daemon.filename = filename;
+	daemon.updater_fd = -1;
+	daemon.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if(daemon.fd == -1)
+	{
+		perror("inotify_init1()");
+		return false;
+	}
+
+	daemon.watches = assoc_array_new(direct_compare, NULL, free);
+	daemon.dirty = assoc_array_new(str_compare, free, NULL);
+
+	server_install_signal_handlers();
+
+	INFOF("indexd", "Refreshing index: %s", filename);
+
+	/* catch up with changes made while the daemon wasn't running */
+	index_refresh(filename, false, _indexd_error, NULL);
+
+	if(_indexd_watch_index(&daemon))
+	{
+		Server *server = server_new(socket);
+
+		if(server)
+		{
+			INFOF("indexd", "Serving index `%s' on socket `%s'.", filename, socket);
+
+			_indexd_run_loop(&daemon, server, handler, user_data);
+			server_destroy(server);
+
+			success = true;
+		}
+		else
+		{
+			fprintf(stderr, _("Couldn't listen on socket `%s': %s\n"), socket, strerror(errno));
+		}
+	}
+	else
+	{
+		fprintf(stderr, _("Couldn't open index `%s', please build it first.\n"), filename);
+	}
+
+	if(daemon.updater_fd != -1)
+	{
+		/* don't leave a partially written index behind */
+		waitpid(daemon.updater, NULL, 0);
+		close(daemon.updater_fd);
+	}
+
+	assoc_array_destroy(daemon.watches);
+	assoc_array_destroy(daemon.dirty);
+	close(daemon.fd);
+
+	return success;
+}
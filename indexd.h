@@ -0,0 +1,45 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file indexd.h
+   @brief Keep a file index up to date and serve queries.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef INDEXD_H
+#define INDEXD_H
+
+#include <stdbool.h>
+
+#include "server.h"
+
+/**
+   @param filename index file to keep up to date
+   @param socket location of the socket to serve requests on
+   @param handler function handling requests
+   @param user_data user data
+   @return false on failure
+
+   Refreshes the index, watches all indexed directories with inotify and serves
+   requests until SIGINT or SIGTERM is received. Reported changes are collected
+   and written to the index by a child process after a short delay, requests
+   are answered from the previous index meanwhile. If the event queue overflows
+   all directories with a changed modification time are read again.
+ */
+bool index_daemon_run(const char *filename, const char *socket, ServerHandler handler, void *user_data);
+
+#endif
+
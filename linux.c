@@ -20,18 +20,35 @@
    @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
+#include <pthread.h>
 #include <sys/types.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
 #include <grp.h>
 #include <pwd.h>
 #include <math.h>
 #include <limits.h>
+#include <unistd.h>
+#include <poll.h>
 #include <assert.h>
+#include <datatypes.h>
 
 #include "linux.h"
 #include "utils.h"
 #include "log.h"
 
+/*! @cond INTERNAL */
+#define LINUX_IOPRIO_CLASS_SHIFT 13
+#define LINUX_IOPRIO_CLASS_BE    2
+#define LINUX_IOPRIO_CLASS_IDLE  3
+#define LINUX_IOPRIO_WHO_PROCESS 1
+#define LINUX_IOPRIO_BE_LOWEST   7
+/*! @endcond */
+
 static char *
 _utoa(unsigned int u)
 {
@@ -50,11 +67,34 @@ _utoa(unsigned int u)
 	return str;
 }
 
-char *
-linux_map_gid(gid_t gid)
+/*! Cached group names. */
+static AssocArray *_linux_groups = NULL;
+
+/*! Cached user names. */
+static AssocArray *_linux_users = NULL;
+
+/*! Mutex protecting the name caches. */
+static pthread_mutex_t _linux_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+_linux_free_caches(void)
+{
+	if(_linux_groups)
+	{
+		assoc_array_destroy(_linux_groups);
+	}
+
+	if(_linux_users)
+	{
+		assoc_array_destroy(_linux_users);
+	}
+}
+
+static char *
+_linux_lookup_group(unsigned int gid)
 {
 	char *name = NULL;
-	const struct group *grp = getgrgid(gid);
+	const struct group *grp = getgrgid((gid_t)gid);
 	
 	if(grp && grp->gr_name && *grp->gr_name)
 	{
@@ -68,11 +108,11 @@ linux_map_gid(gid_t gid)
 	return name;
 }
 
-char *
-linux_map_uid(uid_t uid)
+static char *
+_linux_lookup_user(unsigned int uid)
 {
 	char *name = NULL;
-	const struct passwd *pw = getpwuid(uid);
+	const struct passwd *pw = getpwuid((uid_t)uid);
 	
 	if(pw && pw->pw_name && *pw->pw_name)
 	{
@@ -86,3 +126,230 @@ linux_map_uid(uid_t uid)
 	return name;
 }
 
+/* has to be called with locked mutex */
+static AssocArray *
+_linux_get_cache(AssocArray **cache)
+{
+	assert(cache != NULL);
+
+	if(!*cache)
+	{
+		if(!_linux_groups && !_linux_users)
+		{
+			atexit(_linux_free_caches);
+		}
+
+		*cache = assoc_array_new(direct_compare, NULL, free);
+	}
+
+	return *cache;
+}
+
+static void *
+_linux_id_key(unsigned int id)
+{
+	/* keys must not be NULL */
+	return (void *)((uintptr_t)id + 1);
+}
+
+static char *
+_linux_map_id(AssocArray **cache, unsigned int id, char *(*lookup)(unsigned int))
+{
+	assert(cache != NULL);
+	assert(lookup != NULL);
+
+	pthread_mutex_lock(&_linux_mutex);
+
+	void *key = _linux_id_key(id);
+	AssocArrayPair *pair = assoc_array_lookup(_linux_get_cache(cache), key);
+	char *name;
+
+	if(pair)
+	{
+		name = assoc_array_pair_get_value(pair);
+	}
+	else
+	{
+		name = lookup(id);
+		assoc_array_set(*cache, key, name, false);
+	}
+
+	name = utils_strdup(name);
+
+	pthread_mutex_unlock(&_linux_mutex);
+
+	return name;
+}
+
+char *
+linux_map_gid(gid_t gid)
+{
+	return _linux_map_id(&_linux_groups, (unsigned int)gid, _linux_lookup_group);
+}
+
+char *
+linux_map_uid(uid_t uid)
+{
+	return _linux_map_id(&_linux_users, (unsigned int)uid, _linux_lookup_user);
+}
+
+/* has to be called with locked mutex */
+static void
+_linux_cache_name(AssocArray **cache, unsigned int id, const char *name)
+{
+	assert(cache != NULL);
+
+	void *key = _linux_id_key(id);
+
+	/* the first entry of an id is returned by getpwuid() & getgrgid() */
+	if(name && *name && !assoc_array_lookup(_linux_get_cache(cache), key))
+	{
+		assoc_array_set(*cache, key, utils_strdup(name), false);
+	}
+}
+
+void
+linux_load_names(void)
+{
+	const struct passwd *pw;
+	const struct group *grp;
+
+	pthread_mutex_lock(&_linux_mutex);
+
+	setpwent();
+
+	while((pw = getpwent()))
+	{
+		_linux_cache_name(&_linux_users, (unsigned int)pw->pw_uid, pw->pw_name);
+	}
+
+	endpwent();
+	setgrent();
+
+	while((grp = getgrent()))
+	{
+		_linux_cache_name(&_linux_groups, (unsigned int)grp->gr_gid, grp->gr_name);
+	}
+
+	endgrent();
+
+	pthread_mutex_unlock(&_linux_mutex);
+}
+
+static bool
+_linux_read_flag(const char *path, bool *flag)
+{
+	bool success = false;
+
+	assert(path != NULL);
+	assert(flag != NULL);
+
+	FILE *fp = fopen(path, "r");
+
+	if(fp)
+	{
+		int c = fgetc(fp);
+
+		if(c == '0' || c == '1')
+		{
+			*flag = c == '1';
+			success = true;
+		}
+
+		fclose(fp);
+	}
+
+	return success;
+}
+
+bool
+linux_dev_is_rotational(dev_t dev)
+{
+	char path[PATH_MAX];
+	bool rotational = false;
+
+	snprintf(path, PATH_MAX, "/sys/dev/block/%u:%u/queue/rotational", major(dev), minor(dev));
+
+	if(!_linux_read_flag(path, &rotational))
+	{
+		/* partitions don't have a queue, test the parent device */
+		snprintf(path, PATH_MAX, "/sys/dev/block/%u:%u/../queue/rotational", major(dev), minor(dev));
+		_linux_read_flag(path, &rotational);
+	}
+
+	TRACEF("linux", "Device %u:%u is rotational: %d", major(dev), minor(dev), rotational);
+
+	return rotational;
+}
+
+dev_t
+linux_dev_disk(dev_t dev)
+{
+	char path[PATH_MAX];
+	dev_t disk = dev;
+
+	snprintf(path, PATH_MAX, "/sys/dev/block/%u:%u/partition", major(dev), minor(dev));
+
+	if(!access(path, F_OK))
+	{
+		snprintf(path, PATH_MAX, "/sys/dev/block/%u:%u/../dev", major(dev), minor(dev));
+
+		FILE *fp = fopen(path, "r");
+
+		if(fp)
+		{
+			unsigned int maj, min;
+
+			if(fscanf(fp, "%u:%u", &maj, &min) == 2)
+			{
+				disk = makedev(maj, min);
+			}
+
+			fclose(fp);
+		}
+	}
+
+	TRACEF("linux", "Device %u:%u belongs to disk %u:%u.", major(dev), minor(dev), major(disk), minor(disk));
+
+	return disk;
+}
+
+bool
+linux_set_io_class(LinuxIOClass io_class)
+{
+	bool success = true;
+	int prio = 0;
+
+	if(io_class == LINUX_IO_CLASS_BEST_EFFORT)
+	{
+		prio = (LINUX_IOPRIO_CLASS_BE << LINUX_IOPRIO_CLASS_SHIFT) | LINUX_IOPRIO_BE_LOWEST;
+	}
+	else if(io_class == LINUX_IO_CLASS_IDLE)
+	{
+		prio = LINUX_IOPRIO_CLASS_IDLE << LINUX_IOPRIO_CLASS_SHIFT;
+	}
+
+	if(prio)
+	{
+		DEBUGF("linux", "Setting I/O priority to %#x.", prio);
+
+		success = syscall(SYS_ioprio_set, LINUX_IOPRIO_WHO_PROCESS, 0, prio) == 0;
+	}
+
+	return success;
+}
+
+bool
+linux_pipe_is_broken(int fd)
+{
+	struct pollfd pfd;
+
+	assert(fd >= 0);
+
+	pfd.fd = fd;
+	pfd.events = 0;
+	pfd.revents = 0;
+
+	/* POLLERR is reported if the read end of a pipe has been closed */
+	return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLERR);
+}
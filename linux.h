@@ -22,13 +22,28 @@
 #ifndef LINUX_H
 #define LINUX_H
 
+#include <stdbool.h>
 #include <sys/types.h>
 
+/**
+   @enum LinuxIOClass
+   @brief I/O scheduling classes.
+ */
+typedef enum
+{
+	/*! Keep the I/O priority of the parent process. */
+	LINUX_IO_CLASS_DEFAULT,
+	/*! Lowest priority of the best-effort class. */
+	LINUX_IO_CLASS_BEST_EFFORT,
+	/*! Get disk time only when no other process needs the disk. */
+	LINUX_IO_CLASS_IDLE
+} LinuxIOClass;
+
 /**
    @param gid a group id
    @return a newly-allocated string
 
-   Maps a group id to the corresponding group name.
+   Maps a group id to the corresponding group name. Names are cached.
  */
 char *linux_map_gid(gid_t gid);
 
@@ -36,9 +51,50 @@ char *linux_map_gid(gid_t gid);
    @param uid a user id
    @return a newly-allocated string
 
-   Maps a user id to the corresponding user name.
+   Maps a user id to the corresponding user name. Names are cached.
  */
 char *linux_map_uid(uid_t uid);
 
+/**
+   Reads all user and group names the system database enumerates into the
+   caches used by linux_map_uid() and linux_map_gid().
+ */
+void linux_load_names(void);
+
+/**
+   @param dev a device ID
+   @return true if the device is a rotational disk
+
+   Reads the rotational flag of a block device (or of the disk a partition
+   belongs to) from sysfs. Unknown devices aren't rotational.
+ */
+bool linux_dev_is_rotational(dev_t dev);
+
+/**
+   @param dev a device ID
+   @return ID of the disk the device belongs to
+
+   Maps a partition to the disk it's located on. Other devices (e.g. whole
+   disks or filesystems without a block device) are returned unchanged.
+ */
+dev_t linux_dev_disk(dev_t dev);
+
+/**
+   @param io_class I/O scheduling class
+   @return true on success
+
+   Sets the I/O scheduling class of the calling process. Threads and child
+   processes created afterwards inherit the class.
+ */
+bool linux_set_io_class(LinuxIOClass io_class);
+
+/**
+   @param fd write end of a pipe
+   @return true if the read end of the pipe has been closed
+
+   Tests if data written to a pipe can still be read.
+ */
+bool linux_pipe_is_broken(int fd);
+
 #endif
 
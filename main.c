@@ -28,10 +28,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <locale.h>
 #include <assert.h>
 #include <datatypes.h>
@@ -41,6 +43,7 @@
 #include "pathbuilder.h"
 #include "exec.h"
 #include "search.h"
+#include "device-sched.h"
 #include "parser.h"
 #include "utils.h"
 #include "extension.h"
@@ -50,15 +53,37 @@
 #include "range.h"
 #include "print.h"
 #include "sort.h"
+#include "filelist.h"
+#include "format.h"
+#include "tee.h"
+#include "index.h"
+#include "indexd.h"
+#include "server.h"
+#include "fs.h"
+#include "linux.h"
 
 /*! @cond INTERNAL */
+/*! Exit status of a search that has been stopped by its timeout. */
+#define EXIT_TIMEOUT 124
+
+typedef struct
+{
+	const Options *opts;
+	FILE **outputs;
+} ChainArgs;
+
 typedef struct
 {
-	const char *dir;
-	ProcessorChain *chain;
-} FoundArg;
+	const char *printf;
+	const SList *exec;
+	int32_t exec_flags;
+	FILE *out;
+} OutputArgs;
 /*! @endcond */
 
+/*! Extensions preloaded by the query server and the index daemon. */
+static ExtensionManager *_extensions = NULL;
+
 static void
 _print_ignorelist(void)
 {
@@ -132,11 +157,34 @@ _print_help(const char *name)
 	printf(_("  -d, --dir path                 directory to search (multiple directories are possible)\n"));
 	printf(_("  -L, --follow <yes|no>          follow symbolic links\n"));
 	printf(_("  --regex-type type              set regular expression type; see manpage\n"));
+	printf(_("  --cache-file file              cache results of pure extension functions in file\n"));
+	printf(_("  --cache-size number            number of entries of a new cache file\n"));
+	printf(_("  --result-cache dir             cache search results of unchanged directories in dir\n"));
+	printf(_("  --inflight number              evaluate up to number files concurrently\n"));
+	printf(_("  --device-concurrency number    search up to number directories per disk concurrently\n"));
+	printf(_("  --respect-ignore-files <yes|no> skip files listed in .gitignore/.ignore files\n"));
 	printf(_("  --printf format                print format on standard output; see manpage\n"));
 	printf(_("  --exec command ;               execute command\n"));
 	printf(_("  --exec-ignore-errors <yes|no>  don't stop if command exits with non-zero result\n"));
 	printf(_("  --order-by fields              fields to order search result by; see manpage\n"));
+	printf(_("  --output file                  write output of the current branch to file\n"));
+	printf(_("  --tee                          start an additional output branch\n"));
 	printf(_("  --max-depth levels             maximum search depth\n"));
+	printf(_("  --one-file-system <yes|no>     don't descend directories on other filesystems\n"));
+	printf(_("  --skip-fs-types list           skip mountpoints of the given filesystems\n"));
+	printf(_("  --inode-order <auto|yes|no>    read file status of directory entries in inode order\n"));
+	printf(_("  --io-rate number               limit I/O operations per second\n"));
+	printf(_("  --max-inflight number          maximum number of I/O requests in flight\n"));
+	printf(_("  --io-class <idle|best-effort>  set I/O scheduling class\n"));
+	printf(_("  --timeout duration             stop searching after duration\n"));
+	printf(_("  --index <build|refresh|query|daemon>\n"));
+	printf(_("                                 build/refresh file index, search index instead of filesystem\n"));
+	printf(_("                                 or keep index up to date and serve searches\n"));
+	printf(_("  --index-file file              file index to build, refresh or query\n"));
+	printf(_("  --deep-scan <yes|no>           re-read the status of all files when refreshing the index\n"));
+	printf(_("  --socket file                  socket of the index daemon or query server\n"));
+	printf(_("  --connect                      send search to the index daemon or query server\n"));
+	printf(_("  --serve file                   serve searches on the given socket\n"));
 	printf(_("  --skip number                  number of files to skip\n"));
 	printf(_("  --limit number                 maximum number of files to process\n"));
 	printf(_("  -p, --print                    don't search files but print expression to stdout\n"));
@@ -148,6 +196,92 @@ _print_help(const char *name)
 	printf(_("  -h, --help                     display this help and exit\n"));
 }
 
+static bool
+_get_index_file(const Options *opts, char *path, size_t path_len)
+{
+	bool success = false;
+
+	assert(opts != NULL);
+	assert(path != NULL);
+
+	if(opts->index_file)
+	{
+		if(strlen(opts->index_file) < path_len)
+		{
+			strcpy(path, opts->index_file);
+			success = true;
+		}
+	}
+	else
+	{
+		success = path_builder_index(path, path_len);
+	}
+
+	return success;
+}
+
+static unsigned int
+_get_exec_stat_mask(const SList *exec)
+{
+	unsigned int mask = 0;
+
+	assert(exec != NULL);
+
+	SListItem *item = slist_head(exec);
+
+	while(item)
+	{
+		const ExecArgs *args = (ExecArgs *)slist_item_get_data(item);
+
+		for(size_t i = 0; i < args->argc; ++i)
+		{
+			mask |= format_stat_mask(args->argv[i]);
+		}
+
+		item = slist_item_next(item);
+	}
+
+	return mask;
+}
+
+static unsigned int
+_get_output_stat_mask(const Options *opts)
+{
+	unsigned int mask = 0;
+
+	assert(opts != NULL);
+
+	if(opts->orderby)
+	{
+		mask |= sort_string_stat_mask(opts->orderby);
+	}
+
+	if(opts->printf)
+	{
+		mask |= format_stat_mask(opts->printf);
+	}
+
+	mask |= _get_exec_stat_mask(&opts->exec);
+
+	SListItem *item = slist_head(&opts->tees);
+
+	while(item)
+	{
+		const TeeOptions *tee = (TeeOptions *)slist_item_get_data(item);
+
+		if(tee->printf)
+		{
+			mask |= format_stat_mask(tee->printf);
+		}
+
+		mask |= _get_exec_stat_mask(&tee->exec);
+
+		item = slist_item_next(item);
+	}
+
+	return mask;
+}
+
 static void
 _build_search_options(const Options *opts, SearchOptions *sopts)
 {
@@ -163,6 +297,47 @@ _build_search_options(const Options *opts, SearchOptions *sopts)
 	{
 		sopts->regex_type = utils_strdup(opts->regex_type);
 	}
+
+	if(opts->cache_file)
+	{
+		sopts->cache_file = utils_strdup(opts->cache_file);
+	}
+
+	sopts->cache_size = (size_t)opts->cache_size;
+	sopts->inflight = (size_t)opts->inflight;
+	sopts->timeout = opts->timeout;
+	sopts->output_fd = -1;
+	sopts->respect_ignore_files = opts->respect_ignore_files;
+	sopts->one_file_system = opts->one_file_system;
+	sopts->inode_order = opts->inode_order;
+	sopts->max_inflight = (size_t)opts->max_inflight;
+
+	if(opts->io_rate > 0)
+	{
+		sopts->rate_limit = rate_limit_new((unsigned int)opts->io_rate);
+	}
+
+	if(opts->skip_fs_types)
+	{
+		sopts->skip_fs_types = utils_strdup(opts->skip_fs_types);
+	}
+
+	if(opts->result_cache)
+	{
+		sopts->result_cache = utils_strdup(opts->result_cache);
+	}
+
+	sopts->extensions = _extensions;
+
+	if(opts->index_query)
+	{
+		char path[PATH_MAX];
+
+		if(_get_index_file(opts, path, PATH_MAX))
+		{
+			sopts->index_file = utils_strdup(path);
+		}
+	}
 }
 
 static int32_t
@@ -213,16 +388,14 @@ _print_expr(const Options *opts)
 }
 
 static bool
-_file_cb(const char *path, void *user_data)
+_file_cb(FileInfo *info, void *user_data)
 {
-	FoundArg *arg = (FoundArg *)user_data;
+	ProcessorChain *chain = (ProcessorChain *)user_data;
 
-	assert(path != NULL);
-	assert(arg != NULL);
-	assert(arg->chain != NULL);
-	assert(arg->dir != NULL);
+	assert(info != NULL);
+	assert(chain != NULL);
 
-	return processor_chain_write(arg->chain, arg->dir, path) != PROCESSOR_CHAIN_CONTINUE;
+	return processor_chain_write(chain, info) != PROCESSOR_CHAIN_CONTINUE;
 }
 
 static bool
@@ -237,220 +410,741 @@ _error_cb(const char *msg, void *user_data)
 	return false;
 }
 
-static bool
-_search_dirs(const Options *opts, const SearchOptions *sopts, Callback cb, ProcessorChain *chain)
+/*! @cond INTERNAL */
+typedef struct
+{
+	const Options *opts;
+	const SearchOptions *sopts;
+} SearchDirArgs;
+/*! @endcond */
+
+static int
+_search_dir_list(const char *const *paths, size_t count, FoundFileCallback found_file, void *found_data, void *user_data)
+{
+	const SearchDirArgs *args = (const SearchDirArgs *)user_data;
+
+	assert(paths != NULL);
+	assert(args != NULL);
+
+	return search_dirs(paths, count, args->opts->expr, _get_translation_flags(args->opts), args->sopts, found_file, _error_cb, found_data);
+}
+
+static int
+_search_dirs(const Options *opts, const SearchOptions *sopts, FoundFileCallback cb, ProcessorChain *chain)
 {
 	SListItem *item;
-	FoundArg arg;
-	bool success = true;
+	SearchDirArgs args;
+	int result = EXIT_FAILURE;
 
 	assert(opts != NULL);
 	assert(sopts != NULL);
 	assert(cb != NULL);
 	assert(chain != NULL);
 
-	arg.chain = chain;
-	arg.dir = NULL;
+	DeviceSched *sched = device_sched_new((size_t)opts->device_concurrency);
+
+	if(sopts->output_fd >= 0)
+	{
+		device_sched_watch_output(sched, sopts->output_fd);
+	}
 
 	item = slist_head(&opts->dirs);
 
-	while(item && success)
+	while(item)
 	{
 		const char *path = (const char *)slist_item_get_data(item);
 
-		assert(path != NULL);
+		assert(path != NULL);
+
+		device_sched_add(sched, path);
+
+		item = slist_item_next(item);
+	}
+
+	args.opts = opts;
+	args.sopts = sopts;
+
+	int ret = device_sched_run(sched, _search_dir_list, &args, cb, chain);
+
+	if(!ret || ret == SEARCH_TIMED_OUT)
+	{
+		/* files found before the timeout are still sorted & printed */
+		if(!slist_count(&opts->dirs) || processor_chain_complete(chain) == PROCESSOR_CHAIN_COMPLETED)
+		{
+			result = EXIT_SUCCESS;
+		}
+
+		if(ret == SEARCH_TIMED_OUT)
+		{
+			fprintf(stderr, _("Search timed out.\n"));
+			result = EXIT_TIMEOUT;
+		}
+	}
+
+	device_sched_destroy(sched);
+
+	return result;
+}
+
+static void
+_prepend_sort_processor(ProcessorChainBuilder *builder)
+{
+	assert(builder != NULL);
+	assert(builder->user_data != NULL);
+
+	const Options *opts = ((ChainArgs *)builder->user_data)->opts;
+
+	if(opts->orderby)
+	{
+		TRACE("action", "Prepending sort processor.");
+
+		Processor *sort = sort_processor_new(opts->orderby);
+
+		if(!processor_chain_builder_try_prepend(builder, sort))
+		{
+			fprintf(stderr, _("Couldn't parse sort string.\n"));
+		}
+	}
+}
+
+static void
+_prepend_skip_processor(ProcessorChainBuilder *builder)
+{
+	assert(builder != NULL);
+	assert(builder->user_data != NULL);
+
+	const Options *opts = ((ChainArgs *)builder->user_data)->opts;
+
+	if(opts->skip > 0)
+	{
+		TRACE("action", "Prepending skip processor.");
+
+		Processor *skip = skip_processor_new(opts->skip);
+
+		processor_chain_builder_try_prepend(builder, skip);
+	}
+}
+
+static void
+_prepend_limit_processor(ProcessorChainBuilder *builder)
+{
+	assert(builder != NULL);
+	assert(builder->user_data != NULL);
+
+	const Options *opts = ((ChainArgs *)builder->user_data)->opts;
+
+	if(opts->limit >= 0)
+	{
+		TRACE("action", "Prepending limit processor.");
+
+		Processor *limit = limit_processor_new(opts->limit);
+
+		processor_chain_builder_try_prepend(builder, limit);
+	}
+}
+
+static void
+_prepend_print_processor(ProcessorChainBuilder *builder, const OutputArgs *args)
+{
+	assert(builder != NULL);
+	assert(args != NULL);
+
+	if(args->printf)
+	{
+		TRACE("action", "Prepending print-format processor.");
+
+		Processor *format = print_format_processor_new(args->printf, args->out);
+
+		if(!processor_chain_builder_try_prepend(builder, format))
+		{
+			fprintf(stderr, _("Couldn't parse format string: %s\n"), args->printf);
+		}
+	}
+	else if(slist_count(args->exec) == 0)
+	{
+		TRACE("action", "Prepending print processor.");
+
+		Processor *print = print_processor_new(args->out);
+
+		processor_chain_builder_try_prepend(builder, print);
+	}
+}
+
+static void
+_prepend_exec_processors(ProcessorChainBuilder *builder, const OutputArgs *args)
+{
+	assert(builder != NULL);
+	assert(args != NULL);
+
+	SListItem *item = slist_head(args->exec);
+	bool success = true;
+
+	while(item && success)
+	{
+		TRACE("action", "Prepending exec processor.");
+
+		const ExecArgs *exec_args = (ExecArgs *)slist_item_get_data(item);
+
+		Processor *processor = exec_processor_new(exec_args, args->exec_flags, args->out);
+
+		success = processor_chain_builder_try_prepend(builder, processor);
+
+		item = slist_item_next(item);
+	}
+}
+
+static void
+_prepend_output_branch(ProcessorChainBuilder *builder, const OutputArgs *args)
+{
+	assert(builder != NULL);
+	assert(args != NULL);
+
+	_prepend_exec_processors(builder, args);
+
+	if(!builder->failed)
+	{
+		_prepend_print_processor(builder, args);
+	}
+}
+
+static int32_t
+_get_exec_flags(const Options *opts)
+{
+	assert(opts != NULL);
+
+	return opts->exec_ignore_errors ? EXEC_FLAG_IGNORE_ERROR : EXEC_FLAG_NONE;
+}
+
+static void
+_output_args_init(OutputArgs *args, const Options *opts, const TeeOptions *tee, FILE *out)
+{
+	assert(args != NULL);
+	assert(opts != NULL);
+	assert(out != NULL);
+
+	args->printf = tee ? tee->printf : opts->printf;
+	args->exec = tee ? &tee->exec : &opts->exec;
+	args->exec_flags = _get_exec_flags(opts);
+	args->out = out;
+}
+
+static void
+_prepend_tee_processor(ProcessorChainBuilder *builder)
+{
+	assert(builder != NULL);
+	assert(builder->user_data != NULL);
+
+	const ChainArgs *chain_args = (ChainArgs *)builder->user_data;
+	const Options *opts = chain_args->opts;
+	size_t count = slist_count(&opts->tees) + 1;
+	ProcessorChain **chains = utils_new(count, ProcessorChain *);
+	SListItem *item = slist_head(&opts->tees);
+	bool success = true;
+
+	TRACEF("action", "Building %zu output branches.", count);
+
+	for(size_t i = 0; i < count && success; ++i)
+	{
+		ProcessorChainBuilder branch;
+		OutputArgs args;
+		const TeeOptions *tee = NULL;
+
+		if(i)
+		{
+			tee = (TeeOptions *)slist_item_get_data(item);
+			item = slist_item_next(item);
+		}
+
+		_output_args_init(&args, opts, tee, chain_args->outputs[i]);
+
+		processor_chain_builder_init(&branch, NULL);
+		_prepend_output_branch(&branch, &args);
+
+		chains[i] = processor_chain_builder_get_chain(&branch);
+		success = !branch.failed;
+	}
+
+	if(success)
+	{
+		TRACE("action", "Prepending tee processor.");
+
+		processor_chain_builder_try_prepend(builder, tee_processor_new(chains, count));
+	}
+	else
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			processor_chain_destroy(chains[i]);
+		}
+
+		free(chains);
+		processor_chain_builder_fail(builder);
+	}
+}
+
+static void
+_prepend_output_processors(ProcessorChainBuilder *builder)
+{
+	assert(builder != NULL);
+	assert(builder->user_data != NULL);
+
+	const ChainArgs *chain_args = (ChainArgs *)builder->user_data;
+
+	if(slist_count(&chain_args->opts->tees))
+	{
+		_prepend_tee_processor(builder);
+	}
+	else
+	{
+		OutputArgs args;
+
+		_output_args_init(&args, chain_args->opts, NULL, *chain_args->outputs);
+		_prepend_output_branch(builder, &args);
+	}
+}
+
+static ProcessorChain *
+_build_processor_chain(const ChainArgs *args)
+{
+	assert(args != NULL);
+
+	ProcessorChainBuilder builder;
+
+	processor_chain_builder_init(&builder, args);
+
+	processor_chain_builder_do(&builder,
+	                           _prepend_output_processors,
+	                           _prepend_limit_processor,
+	                           _prepend_skip_processor,
+	                           _prepend_sort_processor,
+	                           PROCESSOR_CHAIN_BUILDER_NULL_FN);
+
+	return processor_chain_builder_get_chain(&builder);
+}
+
+static bool
+_close_outputs(FILE **outputs, size_t count)
+{
+	bool success = true;
+
+	assert(outputs != NULL);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(outputs[i] && outputs[i] != stdout)
+		{
+			if(fclose(outputs[i]))
+			{
+				perror("fclose()");
+				success = false;
+			}
+		}
+	}
+
+	free(outputs);
+
+	return success;
+}
+
+static FILE *
+_open_output(const char *path)
+{
+	FILE *out = stdout;
+
+	if(path)
+	{
+		TRACEF("action", "Opening output file: %s", path);
+
+		out = fopen(path, "w");
+
+		if(!out)
+		{
+			fprintf(stderr, _("Couldn't open output file: %s\n"), path);
+			perror("fopen()");
+		}
+	}
+
+	return out;
+}
+
+static FILE **
+_open_outputs(const Options *opts, size_t *count)
+{
+	assert(opts != NULL);
+	assert(count != NULL);
+
+	*count = slist_count(&opts->tees) + 1;
+
+	FILE **outputs = utils_new(*count, FILE *);
+	SListItem *item = slist_head(&opts->tees);
+	bool success;
+
+	success = (*outputs = _open_output(opts->output)) != NULL;
+
+	for(size_t i = 1; i < *count && success; ++i)
+	{
+		const TeeOptions *tee = (TeeOptions *)slist_item_get_data(item);
+
+		success = (outputs[i] = _open_output(tee->output)) != NULL;
+		item = slist_item_next(item);
+	}
+
+	if(!success)
+	{
+		_close_outputs(outputs, *count);
+		outputs = NULL;
+	}
+
+	return outputs;
+}
+
+static void
+_sigpipe_handler(int signum)
+{
+	/* writes to the closed pipe fail with EPIPE instead of terminating efind */
+}
+
+static int
+_get_output_pipe(const Options *opts, FILE *out)
+{
+	struct stat sb;
+	int fd = -1;
+
+	assert(opts != NULL);
+	assert(out != NULL);
+
+	/* commands may still need to run after the pipe has been closed */
+	if(!slist_count(&opts->tees) && !slist_count(&opts->exec))
+	{
+		if(!fstat(fileno(out), &sb) && S_ISFIFO(sb.st_mode))
+		{
+			struct sigaction sa;
+
+			memset(&sa, 0, sizeof(struct sigaction));
+			sa.sa_handler = _sigpipe_handler;
+			sigemptyset(&sa.sa_mask);
+
+			if(!sigaction(SIGPIPE, &sa, NULL))
+			{
+				fd = fileno(out);
+			}
+		}
+	}
+
+	return fd;
+}
+
+static int
+_exec_find(const Options *opts)
+{
+	SearchOptions sopts;
+	ChainArgs args;
+	size_t count = 0;
+	int result = EXIT_FAILURE;
+
+	assert(opts != NULL);
+	assert(opts->expr != NULL);
+
+	TRACE("action", "Preparing file search.");
+
+	args.opts = opts;
+	args.outputs = _open_outputs(opts, &count);
+
+	if(args.outputs)
+	{
+		ProcessorChain *chain = _build_processor_chain(&args);
+
+		if(chain)
+		{
+			_build_search_options(opts, &sopts);
+
+			/* format strings have been validated when building the chain */
+			sopts.stat_mask = _get_output_stat_mask(opts);
+			sopts.output_fd = _get_output_pipe(opts, *args.outputs);
 
-		TRACEF("action", "Searching directory: \"%s\"", path);
+			result = _search_dirs(opts, &sopts, _file_cb, chain);
+
+			if(sopts.output_fd >= 0 && linux_pipe_is_broken(sopts.output_fd))
+			{
+				DEBUG("action", "Output has been closed.");
+				result = EXIT_SUCCESS;
+			}
 
-		arg.dir = path;
+			TRACE("action", "Cleaning up file search.");
 
-		if(path)
-		{
-			success = search_files(path, opts->expr, _get_translation_flags(opts), sopts, cb, _error_cb, &arg) >= 0;
+			search_options_free(&sopts);
+			processor_chain_destroy(chain);
 		}
-		else
+
+		if(!_close_outputs(args.outputs, count))
 		{
-			success = false;
+			result = EXIT_FAILURE;
 		}
-
-		item = slist_item_next(item);
 	}
 
-	if(success && arg.dir)
-	{
-		success = processor_chain_complete(chain, arg.dir) == PROCESSOR_CHAIN_COMPLETED;
-	}
+	DEBUGF("action", "Action %#x finished with result=%d.", ACTION_EXEC, result);
 
-	return success;
+	return result;
 }
 
 static void
-_prepend_sort_processor(ProcessorChainBuilder *builder)
+_index_error_cb(const char *path, int errnum, void *user_data)
 {
-	assert(builder != NULL);
-	assert(builder->user_data != NULL);
+	assert(path != NULL);
 
-	const Options *opts = (Options *)builder->user_data;
+	fprintf(stderr, _("Couldn't access `%s': %s\n"), path, strerror(errnum));
+}
 
-	if(opts->orderby)
-	{
-		TRACE("action", "Prepending sort processor.");
+static void
+_create_parent_dir(const char *path)
+{
+	char dir[PATH_MAX];
 
-		Processor *sort = sort_processor_new(opts->orderby);
+	assert(path != NULL);
 
-		if(!processor_chain_builder_try_prepend(builder, sort))
+	strcpy(dir, path);
+
+	char *offset = strrchr(dir, '/');
+
+	if(offset && offset != dir)
+	{
+		*offset = '\0';
+
+		if(mkdir(dir, 0700) && errno != EEXIST)
 		{
-			fprintf(stderr, _("Couldn't parse sort string.\n"));
+			WARNINGF("action", "Couldn't create directory `%s', errno=%d.", dir, errno);
 		}
 	}
 }
 
-static void
-_prepend_skip_processor(ProcessorChainBuilder *builder)
+static bool
+_build_index(const Options *opts)
 {
-	assert(builder != NULL);
-	assert(builder->user_data != NULL);
+	char path[PATH_MAX];
+	bool success = false;
+
+	assert(opts != NULL);
 
-	const Options *opts = (Options *)builder->user_data;
+	TRACE("action", "Building file index.");
 
-	if(opts->skip > 0)
+	if(_get_index_file(opts, path, PATH_MAX))
 	{
-		TRACE("action", "Prepending skip processor.");
+		WalkOptions walk_opts;
 
-		Processor *skip = skip_processor_new(opts->skip);
+		if(!opts->index_file)
+		{
+			_create_parent_dir(path);
+		}
 
-		processor_chain_builder_try_prepend(builder, skip);
+		walk_opts.max_depth = opts->max_depth;
+		walk_opts.follow = opts->follow;
+		walk_opts.respect_ignore_files = opts->respect_ignore_files;
+		walk_opts.one_file_system = opts->one_file_system;
+		walk_opts.skip_fs_types = opts->skip_fs_types;
+		walk_opts.list = NULL;
+		walk_opts.stat_mask = STATX_BASIC_STATS;
+		walk_opts.inode_order = opts->inode_order;
+		walk_opts.rate_limit = opts->io_rate > 0 ? rate_limit_new((unsigned int)opts->io_rate) : NULL;
+		walk_opts.max_inflight = (unsigned int)opts->max_inflight;
+
+		success = index_build(path, &opts->dirs, &walk_opts, _index_error_cb, NULL);
+
+		rate_limit_destroy(walk_opts.rate_limit);
+	}
+	else
+	{
+		fprintf(stderr, _("Couldn't detect location of file index.\n"));
 	}
+
+	DEBUGF("action", "Action %#x finished with result=%d.", ACTION_BUILD_INDEX, success);
+
+	return success;
 }
 
-static void
-_prepend_limit_processor(ProcessorChainBuilder *builder)
+static bool
+_refresh_index(const Options *opts)
 {
-	assert(builder != NULL);
-	assert(builder->user_data != NULL);
+	char path[PATH_MAX];
+	bool success = false;
 
-	const Options *opts = (Options *)builder->user_data;
+	assert(opts != NULL);
 
-	if(opts->limit >= 0)
+	TRACE("action", "Refreshing file index.");
+
+	if(_get_index_file(opts, path, PATH_MAX))
 	{
-		TRACE("action", "Prepending limit processor.");
+		success = index_refresh(path, opts->deep_scan, _index_error_cb, NULL);
+	}
+	else
+	{
+		fprintf(stderr, _("Couldn't detect location of file index.\n"));
+	}
 
-		Processor *limit = limit_processor_new(opts->limit);
+	DEBUGF("action", "Action %#x finished with result=%d.", ACTION_REFRESH_INDEX, success);
 
-		processor_chain_builder_try_prepend(builder, limit);
-	}
+	return success;
 }
 
-static void
-_prepend_print_processor(ProcessorChainBuilder *builder)
+static bool
+_get_socket(const Options *opts, char *path, size_t path_len)
 {
-	assert(builder != NULL);
-	assert(builder->user_data != NULL);
+	bool success = false;
 
-	const Options *opts = (Options *)builder->user_data;
+	assert(opts != NULL);
+	assert(path != NULL);
 
-	if(opts->printf)
+	if(opts->socket)
 	{
-		TRACE("action", "Prepending print-format processor.");
-
-		Processor *format = print_format_processor_new(opts->printf);
-
-		if(!processor_chain_builder_try_prepend(builder, format))
+		if(strlen(opts->socket) < path_len)
 		{
-			fprintf(stderr, _("Couldn't parse format string: %s\n"), opts->printf);
+			strcpy(path, opts->socket);
+			success = true;
 		}
 	}
-	else if(slist_count(&opts->exec) == 0)
+	else
 	{
-		TRACE("action", "Prepending print processor.");
-
-		Processor *print = print_processor_new();
-
-		processor_chain_builder_try_prepend(builder, print);
+		success = path_builder_socket(path, path_len);
 	}
+
+	return success;
 }
 
-static int32_t
-_get_exec_flags(const Options *opts)
+static int _serve_request(int argc, char *argv[], void *user_data);
+
+static void
+_preload(void)
 {
-	assert(opts != NULL);
+	TRACE("action", "Preloading extensions, user database, mountpoints and INI files.");
 
-	return opts->exec_ignore_errors ? EXEC_FLAG_IGNORE_ERROR : EXEC_FLAG_NONE;
+	/* forked requests share everything loaded here */
+	_extensions = extension_manager_new();
+	extension_manager_load_default(_extensions);
+
+	linux_load_names();
+	free(linux_map_uid(getuid()));
+	free(linux_map_gid(getgid()));
+
+	fs_map_get_default();
+	options_cache_ini();
 }
 
 static void
-_prepend_exec_processors(ProcessorChainBuilder *builder)
+_unload(void)
 {
-	assert(builder != NULL);
-	assert(builder->user_data != NULL);
+	extension_manager_destroy(_extensions);
+	_extensions = NULL;
 
-	const Options *opts = (Options *)builder->user_data;
-	SListItem *item = slist_head(&opts->exec);
-	bool success = true;
+	options_free_ini_cache();
+}
 
-	while(item && success)
-	{
-		TRACE("action", "Prepending exec processor.");
+static bool
+_run_index_daemon(const Options *opts)
+{
+	char path[PATH_MAX];
+	char socket[PATH_MAX];
+	bool success = false;
 
-		const ExecArgs *args = (ExecArgs *)slist_item_get_data(item);
-		int32_t flags = _get_exec_flags(opts);
+	assert(opts != NULL);
 
-		Processor *processor = exec_processor_new(args, flags);
+	TRACE("action", "Starting index daemon.");
 
-		success = processor_chain_builder_try_prepend(builder, processor);
+	if(_get_index_file(opts, path, PATH_MAX) && _get_socket(opts, socket, PATH_MAX))
+	{
+		if(!opts->socket)
+		{
+			_create_parent_dir(socket);
+		}
 
-		item = slist_item_next(item);
+		_preload();
+		success = index_daemon_run(path, socket, _serve_request, path);
+		_unload();
+	}
+	else
+	{
+		fprintf(stderr, _("Couldn't detect location of file index.\n"));
 	}
+
+	DEBUGF("action", "Action %#x finished with result=%d.", ACTION_INDEX_DAEMON, success);
+
+	return success;
 }
 
-static ProcessorChain *
-_build_processor_chain(const Options *opts)
+static bool
+_run_server(const Options *opts)
 {
+	bool success = false;
+
 	assert(opts != NULL);
+	assert(opts->socket != NULL);
 
-	ProcessorChainBuilder builder;
+	TRACE("action", "Starting query server.");
 
-	processor_chain_builder_init(&builder, opts);
+	Server *server = server_new(opts->socket);
 
-	processor_chain_builder_do(&builder,
-	                           _prepend_exec_processors,
-	                           _prepend_print_processor,
-	                           _prepend_limit_processor,
-	                           _prepend_skip_processor,
-	                           _prepend_sort_processor,
-	                           PROCESSOR_CHAIN_BUILDER_NULL_FN);
+	if(server)
+	{
+		_preload();
 
-	return processor_chain_builder_get_chain(&builder);
+		INFOF("action", "Serving searches on socket `%s'.", opts->socket);
+
+		success = server_run(server, _serve_request, NULL);
+
+		server_destroy(server);
+		_unload();
+	}
+	else
+	{
+		fprintf(stderr, _("Couldn't listen on socket `%s': %s\n"), opts->socket, strerror(errno));
+	}
+
+	DEBUGF("action", "Action %#x finished with result=%d.", ACTION_SERVE, success);
+
+	return success;
 }
 
-static bool
-_exec_find(const Options *opts)
+static int
+_connect(int argc, char *argv[], const Options *opts)
 {
-	SearchOptions sopts;
-	bool success = false;
+	char socket[PATH_MAX];
+	int result = EXIT_FAILURE;
 
+	assert(argc >= 1);
+	assert(argv != NULL);
 	assert(opts != NULL);
-	assert(opts->expr != NULL);
-
-	TRACE("action", "Preparing file search.");
 
-	ProcessorChain *chain = _build_processor_chain(opts);
+	TRACE("action", "Sending search to index daemon.");
 
-	if(chain)
+	if(_get_socket(opts, socket, PATH_MAX))
 	{
-		_build_search_options(opts, &sopts);
+		char **argv_c = utils_new(argc + 1, char *);
+		int argc_c = 0;
+
+		for(int i = 0; i < argc; ++i)
+		{
+			if(strcmp(argv[i], "--connect"))
+			{
+				argv_c[argc_c++] = argv[i];
+			}
+		}
 
-		success = _search_dirs(opts, &sopts, _file_cb, chain);
+		result = server_connect(socket, argc_c, argv_c);
 
-		TRACE("action", "Cleaning up file search.");
+		if(result == -1)
+		{
+			fprintf(stderr, _("Couldn't connect to index daemon: %s\n"), socket);
+			result = EXIT_FAILURE;
+		}
 
-		search_options_free(&sopts);
-		processor_chain_destroy(chain);
+		free(argv_c);
+	}
+	else
+	{
+		fprintf(stderr, _("Couldn't detect location of index daemon socket.\n"));
 	}
 
-	DEBUGF("action", "Action %#x finished with result=%d.", ACTION_EXEC, success);
+	DEBUGF("action", "Action %#x finished with result=%d.", ACTION_CONNECT, result);
 
-	return success;
+	return result;
 }
 
 static int
@@ -463,10 +1157,7 @@ _run_action(Action action, int argc, char **argv, const Options *opts)
 	switch(action)
 	{
 		case ACTION_EXEC:
-			if(_exec_find(opts))
-			{
-				result = EXIT_SUCCESS;
-			}
+			result = _exec_find(opts);
 			break;
 
 		case ACTION_PRINT:
@@ -496,6 +1187,38 @@ _run_action(Action action, int argc, char **argv, const Options *opts)
 			result = EXIT_SUCCESS;
 			break;
 
+		case ACTION_BUILD_INDEX:
+			if(_build_index(opts))
+			{
+				result = EXIT_SUCCESS;
+			}
+			break;
+
+		case ACTION_REFRESH_INDEX:
+			if(_refresh_index(opts))
+			{
+				result = EXIT_SUCCESS;
+			}
+			break;
+
+		case ACTION_INDEX_DAEMON:
+			if(_run_index_daemon(opts))
+			{
+				result = EXIT_SUCCESS;
+			}
+			break;
+
+		case ACTION_CONNECT:
+			result = _connect(argc, argv, opts);
+			break;
+
+		case ACTION_SERVE:
+			if(_run_server(opts))
+			{
+				result = EXIT_SUCCESS;
+			}
+			break;
+
 		default:
 			result = EXIT_FAILURE;
 	}
@@ -748,12 +1471,15 @@ _options_init(Options *opts)
 
 	slist_init(&opts->dirs, str_compare, free, NULL);
 	slist_init(&opts->exec, direct_compare, (FreeFunc)exec_args_destroy, NULL);
+	slist_init(&opts->tees, direct_compare, (FreeFunc)tee_options_destroy, NULL);
 
 	opts->flags = FLAG_STDIN;
 	opts->max_depth = -1;
 	opts->log_color = true;
 	opts->skip = -1;
 	opts->limit = -1;
+	opts->inflight = 1;
+	opts->device_concurrency = 0;
 }
 
 static void
@@ -763,6 +1489,7 @@ _options_free(Options *opts)
 
 	slist_free(&opts->dirs);
 	slist_free(&opts->exec);
+	slist_free(&opts->tees);
 
 	if(opts->expr)
 	{
@@ -774,11 +1501,41 @@ _options_free(Options *opts)
 		free(opts->regex_type);
 	}
 
+	if(opts->cache_file)
+	{
+		free(opts->cache_file);
+	}
+
+	if(opts->skip_fs_types)
+	{
+		free(opts->skip_fs_types);
+	}
+
+	if(opts->index_file)
+	{
+		free(opts->index_file);
+	}
+
+	if(opts->socket)
+	{
+		free(opts->socket);
+	}
+
+	if(opts->result_cache)
+	{
+		free(opts->result_cache);
+	}
+
 	if(opts->printf)
 	{
 		free(opts->printf);
 	}
 
+	if(opts->output)
+	{
+		free(opts->output);
+	}
+
 	if(opts->orderby)
 	{
 		free(opts->orderby);
@@ -798,6 +1555,18 @@ _set_log_options(const Options *opts)
 	log_enable_color(opts->log_color);
 }
 
+static void
+_set_io_class(const Options *opts)
+{
+	assert(opts != NULL);
+
+	/* find and concurrent searches inherit the I/O priority */
+	if(opts->io_class != LINUX_IO_CLASS_DEFAULT && !linux_set_io_class(opts->io_class))
+	{
+		perror("ioprio_set()");
+	}
+}
+
 static void
 _set_locale(void)
 {
@@ -809,6 +1578,47 @@ _set_locale(void)
 #define ACTION_IS_PROCESSING_EXPRESSION(action) action == ACTION_EXEC || action == ACTION_PRINT
 /*! @endcond */
 
+static int
+_serve_request(int argc, char *argv[], void *user_data)
+{
+	Options opts;
+	int result = EXIT_FAILURE;
+
+	assert(argc >= 1);
+	assert(argv != NULL);
+
+	_options_init(&opts);
+
+	Action action = _read_options(argc, argv, &opts);
+
+	if(ACTION_IS_PROCESSING_EXPRESSION(action))
+	{
+		/* the index daemon answers searches from the index it keeps up to date */
+		if(user_data)
+		{
+			opts.index_query = true;
+			utils_copy_string(user_data, &opts.index_file);
+		}
+
+		if(_prepare_processing(&opts))
+		{
+			result = _run_action(action, argc, argv, &opts);
+		}
+	}
+	else if(action == ACTION_PRINT_HELP || action == ACTION_PRINT_VERSION)
+	{
+		result = _run_action(action, argc, argv, &opts);
+	}
+	else if(action != ACTION_ABORT)
+	{
+		fprintf(stderr, _("Action isn't supported by the server.\n"));
+	}
+
+	_options_free(&opts);
+
+	return result;
+}
+
 /**
    @param argc number of arguments
    @param argv argument vector
@@ -831,6 +1641,7 @@ main(int argc, char *argv[])
 	if(action != ACTION_ABORT)
 	{
 		_set_log_options(&opts);
+		_set_io_class(&opts);
 
 		INFOF("startup", "%s started successfully.", *argv);
 
@@ -842,6 +1653,10 @@ main(int argc, char *argv[])
 		{
 			run = _prepare_processing(&opts);
 		}
+		else if(action == ACTION_BUILD_INDEX)
+		{
+			run = _append_missing_homedir(&opts) && _test_search_dirs_are_valid(&opts);
+		}
 
 		if(run)
 		{
@@ -0,0 +1,475 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file optimize.c
+   @brief Optimize abstract syntax trees before translation.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "optimize.h"
+#include "log.h"
+#include "utils.h"
+
+/*! @cond INTERNAL */
+typedef enum
+{
+	COST_CONSTANT = 0,
+	COST_NAME,
+	COST_REGEX,
+	COST_TYPE,
+	COST_STAT,
+	COST_FLAG,
+	COST_NSS,
+	COST_FILESYSTEM
+} Cost;
+
+typedef struct
+{
+	Node **nodes;
+	size_t count;
+	size_t size;
+} OperandList;
+/*! @endcond */
+
+static Node *_optimize_node(Pool *pool, Node *node);
+
+static bool
+_optimize_is_true(const Node *node)
+{
+	assert(node != NULL);
+
+	return node->type == NODE_TRUE;
+}
+
+static bool
+_optimize_is_false(const Node *node)
+{
+	assert(node != NULL);
+
+	return node->type == NODE_NOT && ((NotNode *)node)->expr->type == NODE_TRUE;
+}
+
+static Node *
+_optimize_false_node_new(Pool *pool, const YYLTYPE *locp)
+{
+	return ast_not_node_new(pool, locp, ast_true_node_new(pool, locp));
+}
+
+static bool
+_optimize_value_equals(const ValueNode *a, const ValueNode *b)
+{
+	bool equals = false;
+
+	assert(a != NULL);
+	assert(b != NULL);
+
+	if(a->vtype == b->vtype)
+	{
+		switch(a->vtype)
+		{
+			case VALUE_STRING:
+				equals = !strcmp(a->value.svalue, b->value.svalue);
+				break;
+
+			case VALUE_TIME:
+			case VALUE_SIZE:
+				equals = a->value.pair.a == b->value.pair.a && a->value.pair.b == b->value.pair.b;
+				break;
+
+			default:
+				equals = a->value.ivalue == b->value.ivalue;
+		}
+	}
+
+	return equals;
+}
+
+static bool
+_optimize_node_equals(const Node *a, const Node *b)
+{
+	bool equals = false;
+
+	assert(a != NULL);
+	assert(b != NULL);
+
+	if(a->type == b->type)
+	{
+		switch(a->type)
+		{
+			case NODE_TRUE:
+				equals = true;
+				break;
+
+			case NODE_VALUE:
+				equals = _optimize_value_equals((ValueNode *)a, (ValueNode *)b);
+				break;
+
+			case NODE_CONDITION:
+				equals = ((ConditionNode *)a)->prop == ((ConditionNode *)b)->prop
+				         && ((ConditionNode *)a)->cmp == ((ConditionNode *)b)->cmp
+				         && _optimize_value_equals(((ConditionNode *)a)->value, ((ConditionNode *)b)->value);
+				break;
+
+			case NODE_NOT:
+				equals = _optimize_node_equals(((NotNode *)a)->expr, ((NotNode *)b)->expr);
+				break;
+
+			case NODE_EXPRESSION:
+				equals = ((ExpressionNode *)a)->op == ((ExpressionNode *)b)->op
+				         && _optimize_node_equals(((ExpressionNode *)a)->first, ((ExpressionNode *)b)->first)
+				         && _optimize_node_equals(((ExpressionNode *)a)->second, ((ExpressionNode *)b)->second);
+				break;
+
+			default:
+				/* functions may have side effects, never treat them as equal */
+				break;
+		}
+	}
+
+	return equals;
+}
+
+static Cost
+_optimize_condition_cost(const ConditionNode *node)
+{
+	Cost cost = COST_STAT;
+
+	assert(node != NULL);
+
+	switch(node->prop)
+	{
+		case PROP_NAME:
+		case PROP_INAME:
+		case PROP_PATH:
+		case PROP_IPATH:
+			cost = COST_NAME;
+			break;
+
+		case PROP_REGEX:
+		case PROP_IREGEX:
+			cost = COST_REGEX;
+			break;
+
+		case PROP_TYPE:
+			cost = COST_TYPE;
+			break;
+
+		case PROP_USER:
+		case PROP_GROUP:
+			cost = COST_NSS;
+			break;
+
+		case PROP_FILESYSTEM:
+			cost = COST_FILESYSTEM;
+			break;
+
+		default:
+			break;
+	}
+
+	return cost;
+}
+
+static unsigned int
+_optimize_node_cost(const Node *node)
+{
+	unsigned int cost = COST_STAT;
+
+	assert(node != NULL);
+
+	switch(node->type)
+	{
+		case NODE_TRUE:
+			cost = COST_CONSTANT;
+			break;
+
+		case NODE_VALUE:
+			cost = COST_FLAG;
+			break;
+
+		case NODE_CONDITION:
+			cost = _optimize_condition_cost((ConditionNode *)node);
+			break;
+
+		case NODE_NOT:
+			cost = _optimize_node_cost(((NotNode *)node)->expr);
+			break;
+
+		case NODE_EXPRESSION:
+			cost = _optimize_node_cost(((ExpressionNode *)node)->first)
+			       + _optimize_node_cost(((ExpressionNode *)node)->second);
+			break;
+
+		default:
+			break;
+	}
+
+	return cost;
+}
+
+static Node *
+_optimize_condition(Pool *pool, ConditionNode *node)
+{
+	Node *result = (Node *)node;
+
+	assert(pool != NULL);
+	assert(node != NULL);
+
+	/* file sizes are never negative */
+	if(node->prop == PROP_SIZE
+	   && (node->value->vtype == VALUE_NUMERIC || node->value->vtype == VALUE_SIZE))
+	{
+		int size = node->value->vtype == VALUE_NUMERIC ? node->value->value.ivalue : node->value->value.pair.a;
+
+		if(!size && node->cmp == CMP_GT_EQ)
+		{
+			TRACE("optimize", "Folding condition \"size >= 0\" to true.");
+			result = ast_true_node_new(pool, &node->padding.loc);
+		}
+		else if(!size && node->cmp == CMP_LT)
+		{
+			TRACE("optimize", "Folding condition \"size < 0\" to false.");
+			result = _optimize_false_node_new(pool, &node->padding.loc);
+		}
+	}
+
+	return result;
+}
+
+static Node *
+_optimize_not(Pool *pool, NotNode *node)
+{
+	Node *result = (Node *)node;
+
+	assert(pool != NULL);
+	assert(node != NULL);
+
+	node->expr = _optimize_node(pool, node->expr);
+
+	if(node->expr->type == NODE_NOT)
+	{
+		TRACE("optimize", "Removing double negation.");
+		result = ((NotNode *)node->expr)->expr;
+	}
+
+	return result;
+}
+
+static void
+_optimize_operand_list_init(OperandList *list)
+{
+	assert(list != NULL);
+
+	list->count = 0;
+	list->size = 8;
+	list->nodes = utils_new(list->size, Node *);
+}
+
+static void
+_optimize_operand_list_free(OperandList *list)
+{
+	assert(list != NULL);
+
+	free(list->nodes);
+}
+
+static void
+_optimize_operand_list_append(OperandList *list, Node *node)
+{
+	assert(list != NULL);
+	assert(node != NULL);
+
+	for(size_t i = 0; i < list->count; ++i)
+	{
+		if(_optimize_node_equals(list->nodes[i], node))
+		{
+			TRACE("optimize", "Removing duplicate operand.");
+			return;
+		}
+	}
+
+	if(list->count == list->size)
+	{
+		list->size *= 2;
+		list->nodes = utils_renew(list->nodes, list->size, Node *);
+	}
+
+	list->nodes[list->count++] = node;
+}
+
+static void
+_optimize_collect_operands(Pool *pool, Node *node, OperatorType op, OperandList *list)
+{
+	assert(pool != NULL);
+	assert(node != NULL);
+	assert(list != NULL);
+
+	if(node->type == NODE_EXPRESSION && ((ExpressionNode *)node)->op == op)
+	{
+		_optimize_collect_operands(pool, ((ExpressionNode *)node)->first, op, list);
+		_optimize_collect_operands(pool, ((ExpressionNode *)node)->second, op, list);
+	}
+	else
+	{
+		Node *child = _optimize_node(pool, node);
+
+		/* optimized child may have become a chain of the same operator */
+		if(child->type == NODE_EXPRESSION && ((ExpressionNode *)child)->op == op)
+		{
+			_optimize_collect_operands(pool, child, op, list);
+		}
+		else
+		{
+			_optimize_operand_list_append(list, child);
+		}
+	}
+}
+
+static void
+_optimize_sort_operands(OperandList *list)
+{
+	assert(list != NULL);
+
+	/* stable insertion sort, operand lists are short */
+	for(size_t i = 1; i < list->count; ++i)
+	{
+		Node *node = list->nodes[i];
+		unsigned int cost = _optimize_node_cost(node);
+		size_t j = i;
+
+		while(j > 0 && _optimize_node_cost(list->nodes[j - 1]) > cost)
+		{
+			list->nodes[j] = list->nodes[j - 1];
+			--j;
+		}
+
+		list->nodes[j] = node;
+	}
+}
+
+static Node *
+_optimize_expression(Pool *pool, ExpressionNode *node)
+{
+	OperandList list;
+	Node *result = NULL;
+
+	assert(pool != NULL);
+	assert(node != NULL);
+
+	if(node->op != OP_AND && node->op != OP_OR)
+	{
+		return (Node *)node;
+	}
+
+	_optimize_operand_list_init(&list);
+	_optimize_collect_operands(pool, (Node *)node, node->op, &list);
+
+	/* fold constants: drop neutral elements, stop at absorbing ones */
+	size_t count = 0;
+
+	for(size_t i = 0; i < list.count && !result; ++i)
+	{
+		Node *operand = list.nodes[i];
+
+		if(node->op == OP_AND ? _optimize_is_false(operand) : _optimize_is_true(operand))
+		{
+			TRACE("optimize", "Folding expression to constant.");
+			result = operand;
+		}
+		else if(!(node->op == OP_AND ? _optimize_is_true(operand) : _optimize_is_false(operand)))
+		{
+			list.nodes[count++] = operand;
+		}
+	}
+
+	if(!result)
+	{
+		list.count = count;
+
+		if(!count)
+		{
+			result = node->op == OP_AND
+			         ? ast_true_node_new(pool, &node->padding.loc)
+			         : _optimize_false_node_new(pool, &node->padding.loc);
+		}
+		else
+		{
+			_optimize_sort_operands(&list);
+
+			result = list.nodes[0];
+
+			for(size_t i = 1; i < list.count; ++i)
+			{
+				result = ast_expr_node_new(pool, &node->padding.loc, result, node->op, list.nodes[i]);
+			}
+		}
+	}
+
+	_optimize_operand_list_free(&list);
+
+	return result;
+}
+
+static Node *
+_optimize_node(Pool *pool, Node *node)
+{
+	Node *result = node;
+
+	assert(pool != NULL);
+	assert(node != NULL);
+
+	switch(node->type)
+	{
+		case NODE_EXPRESSION:
+			result = _optimize_expression(pool, (ExpressionNode *)node);
+			break;
+
+		case NODE_NOT:
+			result = _optimize_not(pool, (NotNode *)node);
+			break;
+
+		case NODE_CONDITION:
+			result = _optimize_condition(pool, (ConditionNode *)node);
+			break;
+
+		default:
+			break;
+	}
+
+	return result;
+}
+
+Node *
+optimize(Pool *pool, Node *root)
+{
+	Node *result = root;
+
+	assert(pool != NULL);
+
+	if(root)
+	{
+		TRACE("optimize", "Optimizing expression tree.");
+
+		result = _optimize_node(pool, root);
+	}
+
+	return result;
+}
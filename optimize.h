@@ -0,0 +1,43 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file optimize.h
+   @brief Optimize abstract syntax trees before translation.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include <datatypes.h>
+
+#include "ast.h"
+
+/**
+   @param pool Pool used to allocate new nodes
+   @param root root node of an expression tree
+   @return root node of the optimized expression tree
+
+   Flattens chains of the same operator, removes duplicate operands,
+   folds constants and double negations and reorders the operands of
+   "and" and "or" operators by their estimated evaluation cost. Cheap
+   name tests are moved to the front, tests requiring a stat() call,
+   a user/group lookup or the mount table to the end. Nodes are modified
+   in place, new nodes are allocated from the given Pool.
+ */
+Node *optimize(Pool *pool, Node *root);
+
+#endif
@@ -22,6 +22,7 @@
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include "efind.h"
@@ -29,6 +30,44 @@
 #include "utils.h"
 #include "gettext.h"
 
+TeeOptions *
+tee_options_new(void)
+{
+	TeeOptions *opts = utils_new(1, TeeOptions);
+
+	slist_init(&opts->exec, direct_compare, (FreeFunc)exec_args_destroy, NULL);
+
+	return opts;
+}
+
+void
+tee_options_destroy(TeeOptions *opts)
+{
+	if(opts)
+	{
+		slist_free(&opts->exec);
+		free(opts->printf);
+		free(opts->output);
+		free(opts);
+	}
+}
+
+static TeeOptions *
+_get_opt_next_tee(Options *opts, SListItem **item)
+{
+	assert(opts != NULL);
+	assert(item != NULL);
+
+	*item = *item ? slist_item_next(*item) : slist_head(&opts->tees);
+
+	if(!*item)
+	{
+		*item = slist_append(&opts->tees, tee_options_new());
+	}
+
+	return (TeeOptions *)slist_item_get_data(*item);
+}
+
 static void
 _get_opt_append_single_search_dir(char *argv[], Options *opts)
 {
@@ -68,6 +107,21 @@ _get_opt_append_multiple_search_dirs(char *argv[], int offset, Options *opts)
 	}
 }
 
+static void
+_get_opt_append_index_dirs_from_argv(char *argv[], int offset, Options *opts)
+{
+	assert(argv != NULL);
+	assert(opts != NULL);
+
+	for(int i = 1; i <= offset; ++i)
+	{
+		if(!slist_contains(&opts->dirs, argv[i]))
+		{
+			slist_append(&opts->dirs, utils_strdup(argv[i]));
+		}
+	}
+}
+
 static void
 _get_opt_append_search_dirs_and_expr_from_argv(char *argv[], int offset, Options *opts)
 {
@@ -139,7 +193,7 @@ _get_opt_copy_argv(int argc, char *argv[], int offset)
 }
 
 static Action
-_get_opt(int argc, char *argv[], int offset, Options *opts)
+_get_opt(int argc, char *argv[], int offset, Options *opts, SList *execs)
 {
 	enum
 	{
@@ -151,6 +205,28 @@ _get_opt(int argc, char *argv[], int offset, Options *opts)
 		PRINTF,
 		EXEC_IGNORE_ERRORS,
 		ORDER_BY,
+		OUTPUT,
+		TEE,
+		EXEC,
+		CACHE_FILE,
+		CACHE_SIZE,
+		INFLIGHT,
+		DEVICE_CONCURRENCY,
+		RESPECT_IGNORE_FILES,
+		ONE_FILE_SYSTEM,
+		SKIP_FS_TYPES,
+		INDEX,
+		INDEX_FILE,
+		DEEP_SCAN,
+		SOCKET,
+		CONNECT,
+		SERVE,
+		RESULT_CACHE,
+		INODE_ORDER,
+		IO_RATE,
+		MAX_INFLIGHT,
+		IO_CLASS,
+		TIMEOUT,
 		PRINT_EXTENSIONS,
 		PRINT_IGNORELIST,
 		LOG_LEVEL,
@@ -171,6 +247,28 @@ _get_opt(int argc, char *argv[], int offset, Options *opts)
 		{ "printf", required_argument, 0, PRINTF },
 		{ "exec-ignore-errors", optional_argument, 0, EXEC_IGNORE_ERRORS },
 		{ "order-by", required_argument, 0, ORDER_BY },
+		{ "output", required_argument, 0, OUTPUT },
+		{ "tee", no_argument, 0, TEE },
+		{ "exec", no_argument, 0, EXEC },
+		{ "cache-file", required_argument, 0, CACHE_FILE },
+		{ "cache-size", required_argument, 0, CACHE_SIZE },
+		{ "inflight", required_argument, 0, INFLIGHT },
+		{ "device-concurrency", required_argument, 0, DEVICE_CONCURRENCY },
+		{ "respect-ignore-files", optional_argument, 0, RESPECT_IGNORE_FILES },
+		{ "one-file-system", optional_argument, 0, ONE_FILE_SYSTEM },
+		{ "skip-fs-types", required_argument, 0, SKIP_FS_TYPES },
+		{ "index", required_argument, 0, INDEX },
+		{ "index-file", required_argument, 0, INDEX_FILE },
+		{ "deep-scan", optional_argument, 0, DEEP_SCAN },
+		{ "socket", required_argument, 0, SOCKET },
+		{ "connect", no_argument, 0, CONNECT },
+		{ "serve", required_argument, 0, SERVE },
+		{ "result-cache", required_argument, 0, RESULT_CACHE },
+		{ "inode-order", required_argument, 0, INODE_ORDER },
+		{ "io-rate", required_argument, 0, IO_RATE },
+		{ "max-inflight", required_argument, 0, MAX_INFLIGHT },
+		{ "io-class", required_argument, 0, IO_CLASS },
+		{ "timeout", required_argument, 0, TIMEOUT },
 		{ "print-extensions", no_argument, 0, PRINT_EXTENSIONS },
 		{ "print-ignore-list", no_argument, 0, PRINT_IGNORELIST },
 		{ "log-level", required_argument, 0, LOG_LEVEL },
@@ -181,11 +279,13 @@ _get_opt(int argc, char *argv[], int offset, Options *opts)
 	};
 
 	Action action = ACTION_EXEC;
+	bool connect = false;
 
 	assert(argc >= 1);
 	assert(argv != NULL);
 	assert(offset < argc);
 	assert(opts != NULL);
+	assert(execs != NULL);
 
 	char **argv_ptr = argv;
 	char **argv_heap = _get_opt_copy_argv(argc, argv, offset);
@@ -196,6 +296,11 @@ _get_opt(int argc, char *argv[], int offset, Options *opts)
 	}
 
 	int index = 0;
+	SListItem *tee_item = NULL;
+	TeeOptions *tee = NULL;
+
+	/* options may be parsed more than once, e.g. by the index daemon */
+	optind = 0;
 
 	while(action != ACTION_ABORT)
 	{
@@ -299,8 +404,226 @@ _get_opt(int argc, char *argv[], int offset, Options *opts)
 				utils_copy_string(optarg, &opts->regex_type);
 				break;
 
+			case CACHE_FILE:
+				utils_copy_string(optarg, &opts->cache_file);
+				break;
+
+			case CACHE_SIZE:
+				{
+					long int size;
+
+					if(utils_parse_integer(optarg, 1, INT32_MAX, &size))
+					{
+						opts->cache_size = (int32_t)size;
+					}
+					else
+					{
+						fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "cache-size");
+						action = ACTION_ABORT;
+					}
+				}
+				break;
+
+			case INFLIGHT:
+				{
+					long int inflight;
+
+					if(utils_parse_integer(optarg, 1, 256, &inflight))
+					{
+						opts->inflight = (int32_t)inflight;
+					}
+					else
+					{
+						fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "inflight");
+						action = ACTION_ABORT;
+					}
+				}
+				break;
+
+			case DEVICE_CONCURRENCY:
+				{
+					long int concurrency;
+
+					if(utils_parse_integer(optarg, 0, 256, &concurrency))
+					{
+						opts->device_concurrency = (int32_t)concurrency;
+					}
+					else
+					{
+						fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "device-concurrency");
+						action = ACTION_ABORT;
+					}
+				}
+				break;
+
+			case RESPECT_IGNORE_FILES:
+				if(optarg == NULL)
+				{
+					opts->respect_ignore_files = true;
+				}
+				else if(!utils_parse_bool(optarg, &opts->respect_ignore_files))
+				{
+					fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "respect-ignore-files");
+					action = ACTION_ABORT;
+				}
+				break;
+
+			case ONE_FILE_SYSTEM:
+				if(optarg == NULL)
+				{
+					opts->one_file_system = true;
+				}
+				else if(!utils_parse_bool(optarg, &opts->one_file_system))
+				{
+					fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "one-file-system");
+					action = ACTION_ABORT;
+				}
+				break;
+
+			case SKIP_FS_TYPES:
+				utils_copy_string(optarg, &opts->skip_fs_types);
+				break;
+
+			case INDEX:
+				if(!strcmp(optarg, "build"))
+				{
+					action = ACTION_BUILD_INDEX;
+				}
+				else if(!strcmp(optarg, "refresh"))
+				{
+					action = ACTION_REFRESH_INDEX;
+				}
+				else if(!strcmp(optarg, "query"))
+				{
+					opts->index_query = true;
+				}
+				else if(!strcmp(optarg, "daemon"))
+				{
+					action = ACTION_INDEX_DAEMON;
+				}
+				else
+				{
+					fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "index");
+					action = ACTION_ABORT;
+				}
+				break;
+
+			case INDEX_FILE:
+				utils_copy_string(optarg, &opts->index_file);
+				break;
+
+			case DEEP_SCAN:
+				if(optarg == NULL)
+				{
+					opts->deep_scan = true;
+				}
+				else if(!utils_parse_bool(optarg, &opts->deep_scan))
+				{
+					fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "deep-scan");
+					action = ACTION_ABORT;
+				}
+				break;
+
+			case SOCKET:
+				utils_copy_string(optarg, &opts->socket);
+				break;
+
+			case CONNECT:
+				connect = true;
+				break;
+
+			case RESULT_CACHE:
+				utils_copy_string(optarg, &opts->result_cache);
+				break;
+
+			case INODE_ORDER:
+				if(!options_parse_inode_order(optarg, &opts->inode_order))
+				{
+					fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "inode-order");
+					action = ACTION_ABORT;
+				}
+				break;
+
+			case IO_RATE:
+				{
+					long int rate;
+
+					if(utils_parse_integer(optarg, 0, INT32_MAX, &rate))
+					{
+						opts->io_rate = (int32_t)rate;
+					}
+					else
+					{
+						fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "io-rate");
+						action = ACTION_ABORT;
+					}
+				}
+				break;
+
+			case MAX_INFLIGHT:
+				{
+					long int inflight;
+
+					if(utils_parse_integer(optarg, 1, 4096, &inflight))
+					{
+						opts->max_inflight = (int32_t)inflight;
+					}
+					else
+					{
+						fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "max-inflight");
+						action = ACTION_ABORT;
+					}
+				}
+				break;
+
+			case IO_CLASS:
+				if(!options_parse_io_class(optarg, &opts->io_class))
+				{
+					fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "io-class");
+					action = ACTION_ABORT;
+				}
+				break;
+
+			case TIMEOUT:
+				if(!utils_parse_duration(optarg, &opts->timeout))
+				{
+					fprintf(stderr, _("Argument of option `%s' is malformed.\n"), "timeout");
+					action = ACTION_ABORT;
+				}
+				break;
+
+			case SERVE:
+				utils_copy_string(optarg, &opts->socket);
+				action = ACTION_SERVE;
+				break;
+
 			case PRINTF:
-				utils_copy_string(optarg, &opts->printf);
+				utils_copy_string(optarg, tee ? &tee->printf : &opts->printf);
+				break;
+
+			case OUTPUT:
+				utils_copy_string(optarg, tee ? &tee->output : &opts->output);
+				break;
+
+			case TEE:
+				tee = _get_opt_next_tee(opts, &tee_item);
+				break;
+
+			case EXEC:
+				{
+					/* the arguments have been stolen before, in order of appearance */
+					ExecArgs *args = slist_pop(execs);
+
+					if(args)
+					{
+						slist_append(tee ? &tee->exec : &opts->exec, args);
+					}
+					else
+					{
+						fprintf(stderr, _("Invalid --exec option, argument list is empty.\n"));
+						action = ACTION_ABORT;
+					}
+				}
 				break;
 
 			case ORDER_BY:
@@ -320,6 +643,23 @@ _get_opt(int argc, char *argv[], int offset, Options *opts)
 		}
 	}
 
+	if(connect && action != ACTION_ABORT)
+	{
+		action = ACTION_CONNECT;
+	}
+
+	if(action == ACTION_BUILD_INDEX)
+	{
+		/* directories to index may follow the options */
+		for(int i = optind; i < argc - offset; ++i)
+		{
+			if(!slist_contains(&opts->dirs, argv_ptr[i]))
+			{
+				slist_append(&opts->dirs, utils_strdup(argv_ptr[i]));
+			}
+		}
+	}
+
 	if(argv_heap)
 	{
 		for(int i = 0; i < argc - offset; ++i)
@@ -373,7 +713,7 @@ _get_opt_free_argv(int argc, char ***argv)
 }
 
 static bool
-_get_opt_steal_exec_args(int argc, char *argv[], int *new_argc, char ***new_argv, Options *opts)
+_get_opt_steal_exec_args(int argc, char *argv[], int *new_argc, char ***new_argv, SList *execs)
 {
 	bool success = true;
 
@@ -381,7 +721,7 @@ _get_opt_steal_exec_args(int argc, char *argv[], int *new_argc, char ***new_argv
 	assert(argv != NULL);
 	assert(new_argc != NULL);
 	assert(new_argv != NULL);
-	assert(opts != NULL);
+	assert(execs != NULL);
 
 	*new_argv = (char **)utils_malloc(sizeof(char *) * argc);
 	*new_argc = 0;
@@ -407,7 +747,7 @@ _get_opt_steal_exec_args(int argc, char *argv[], int *new_argc, char ***new_argv
 						exec_args_append(args, argv[offset]);
 					}
 
-					slist_append(&opts->exec, args);
+					slist_append(execs, args);
 				}
 				else
 				{
@@ -415,13 +755,15 @@ _get_opt_steal_exec_args(int argc, char *argv[], int *new_argc, char ***new_argv
 				}
 			}
 		}
-		else if(!strcmp(argv[i], "--exec"))
-		{
-			open = true;
-			start = i + 1;
-		}
 		else
 		{
+			/* --exec is kept, getopt assigns the stolen arguments to the current output branch */
+			if(!strcmp(argv[i], "--exec"))
+			{
+				open = true;
+				start = i + 1;
+			}
+
 			(*new_argv)[*new_argc] = utils_strdup(argv[i]);
 			++(*new_argc);
 		}
@@ -457,14 +799,21 @@ options_getopt(Options *opts, int argc, char *argv[])
 
 	int no_exec_argc = 0;
 	char **no_exec_argv = NULL;
+	SList execs;
 
-	if(_get_opt_steal_exec_args(argc, argv, &no_exec_argc, &no_exec_argv, opts))
+	slist_init(&execs, direct_compare, (FreeFunc)exec_args_destroy, NULL);
+
+	if(_get_opt_steal_exec_args(argc, argv, &no_exec_argc, &no_exec_argv, &execs))
 	{
 		int offset = _get_opt_index_of_first_option(no_exec_argc, no_exec_argv);
 
-		action = _get_opt(no_exec_argc, no_exec_argv, offset, opts);
+		action = _get_opt(no_exec_argc, no_exec_argv, offset, opts, &execs);
 
-		if(action != ACTION_ABORT)
+		if(action == ACTION_BUILD_INDEX)
+		{
+			_get_opt_append_index_dirs_from_argv(no_exec_argv, offset, opts);
+		}
+		else if(action != ACTION_ABORT)
 		{
 			_get_opt_append_search_dirs_and_expr_from_argv(no_exec_argv, offset, opts);
 		}
@@ -472,6 +821,56 @@ options_getopt(Options *opts, int argc, char *argv[])
 		_get_opt_free_argv(no_exec_argc, &no_exec_argv);
 	}
 
+	slist_free(&execs);
+
 	return action;
 }
 
+bool
+options_parse_inode_order(const char *value, WalkInodeOrder *dst)
+{
+	bool success = true;
+	bool sort;
+
+	assert(value != NULL);
+	assert(dst != NULL);
+
+	if(!strcmp(value, "auto"))
+	{
+		*dst = WALK_INODE_ORDER_AUTO;
+	}
+	else if(utils_parse_bool(value, &sort))
+	{
+		*dst = sort ? WALK_INODE_ORDER_YES : WALK_INODE_ORDER_NO;
+	}
+	else
+	{
+		success = false;
+	}
+
+	return success;
+}
+
+bool
+options_parse_io_class(const char *value, LinuxIOClass *dst)
+{
+	bool success = true;
+
+	assert(value != NULL);
+	assert(dst != NULL);
+
+	if(!strcmp(value, "idle"))
+	{
+		*dst = LINUX_IO_CLASS_IDLE;
+	}
+	else if(!strcmp(value, "best-effort"))
+	{
+		*dst = LINUX_IO_CLASS_BEST_EFFORT;
+	}
+	else
+	{
+		success = false;
+	}
+
+	return success;
+}
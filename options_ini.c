@@ -105,6 +105,91 @@ _ini_handle_general_section(Options *opts, const char *name, const char *value)
 	{
 		utils_parse_bool(value, &opts->exec_ignore_errors);
 	}
+	else if(!strcmp(name, "cache-file"))
+	{
+		utils_copy_string(value, &opts->cache_file);
+	}
+	else if(!strcmp(name, "cache-size"))
+	{
+		long int size;
+
+		if(utils_parse_integer(value, 1, INT32_MAX, &size))
+		{
+			opts->cache_size = (int32_t)size;
+		}
+	}
+	else if(!strcmp(name, "inflight"))
+	{
+		long int inflight;
+
+		if(utils_parse_integer(value, 1, 256, &inflight))
+		{
+			opts->inflight = (int32_t)inflight;
+		}
+	}
+	else if(!strcmp(name, "device-concurrency"))
+	{
+		long int concurrency;
+
+		if(utils_parse_integer(value, 0, 256, &concurrency))
+		{
+			opts->device_concurrency = (int32_t)concurrency;
+		}
+	}
+	else if(!strcmp(name, "respect-ignore-files"))
+	{
+		utils_parse_bool(value, &opts->respect_ignore_files);
+	}
+	else if(!strcmp(name, "one-file-system"))
+	{
+		utils_parse_bool(value, &opts->one_file_system);
+	}
+	else if(!strcmp(name, "skip-fs-types"))
+	{
+		utils_copy_string(value, &opts->skip_fs_types);
+	}
+	else if(!strcmp(name, "index-file"))
+	{
+		utils_copy_string(value, &opts->index_file);
+	}
+	else if(!strcmp(name, "socket"))
+	{
+		utils_copy_string(value, &opts->socket);
+	}
+	else if(!strcmp(name, "result-cache"))
+	{
+		utils_copy_string(value, &opts->result_cache);
+	}
+	else if(!strcmp(name, "inode-order"))
+	{
+		options_parse_inode_order(value, &opts->inode_order);
+	}
+	else if(!strcmp(name, "io-rate"))
+	{
+		long int rate;
+
+		if(utils_parse_integer(value, 0, INT32_MAX, &rate))
+		{
+			opts->io_rate = (int32_t)rate;
+		}
+	}
+	else if(!strcmp(name, "max-inflight"))
+	{
+		long int inflight;
+
+		if(utils_parse_integer(value, 1, 4096, &inflight))
+		{
+			opts->max_inflight = (int32_t)inflight;
+		}
+	}
+	else if(!strcmp(name, "io-class"))
+	{
+		options_parse_io_class(value, &opts->io_class);
+	}
+	else if(!strcmp(name, "timeout"))
+	{
+		utils_parse_duration(value, &opts->timeout);
+	}
 }
 
 static int
@@ -129,16 +214,36 @@ _ini_handler(void *user_data, const char *section, const char *name, const char
 	return 1;
 }
 
-void
-options_load_ini(Options *opts)
+/*! @cond INTERNAL */
+typedef struct
+{
+	char *section;
+	char *name;
+	char *value;
+} IniEntry;
+
+typedef int (*IniHandler)(void *user_data, const char *section, const char *name, const char *value);
+/*! @endcond */
+
+/*! Entries of the INI files read by options_cache_ini(). */
+static IniEntry *_ini_entries = NULL;
+
+/*! Number of cached INI entries. */
+static size_t _ini_count = 0;
+
+/*! Indicates if the INI files have been cached. */
+static bool _ini_cached = false;
+
+static void
+_ini_parse_files(IniHandler handler, void *user_data)
 {
 	char path[PATH_MAX];
 
-	assert(opts != NULL);
+	assert(handler != NULL);
 
 	if(path_builder_global_ini(path, PATH_MAX))
 	{
-		int line = ini_parse(path, _ini_handler, opts);
+		int line = ini_parse(path, handler, user_data);
 
 		if(line > 0)
 		{
@@ -148,7 +253,7 @@ options_load_ini(Options *opts)
 
 	if(path_builder_local_ini(path, PATH_MAX))
 	{
-		int line = ini_parse(path, _ini_handler, opts);
+		int line = ini_parse(path, handler, user_data);
 
 		if(line > 0)
 		{
@@ -157,3 +262,66 @@ options_load_ini(Options *opts)
 	}
 }
 
+static int
+_ini_store_entry(void *user_data, const char *section, const char *name, const char *value)
+{
+	assert(section != NULL);
+	assert(name != NULL);
+	assert(value != NULL);
+
+	_ini_entries = _ini_count ? utils_renew(_ini_entries, _ini_count + 1, IniEntry) : utils_new(1, IniEntry);
+
+	_ini_entries[_ini_count].section = utils_strdup(section);
+	_ini_entries[_ini_count].name = utils_strdup(name);
+	_ini_entries[_ini_count].value = utils_strdup(value);
+	++_ini_count;
+
+	return 1;
+}
+
+void
+options_load_ini(Options *opts)
+{
+	assert(opts != NULL);
+
+	if(_ini_cached)
+	{
+		for(size_t i = 0; i < _ini_count; ++i)
+		{
+			_ini_handler(opts, _ini_entries[i].section, _ini_entries[i].name, _ini_entries[i].value);
+		}
+	}
+	else
+	{
+		_ini_parse_files(_ini_handler, opts);
+	}
+}
+
+void
+options_cache_ini(void)
+{
+	if(!_ini_cached)
+	{
+		TRACE("options", "Caching INI files.");
+
+		_ini_parse_files(_ini_store_entry, NULL);
+		_ini_cached = true;
+	}
+}
+
+void
+options_free_ini_cache(void)
+{
+	for(size_t i = 0; i < _ini_count; ++i)
+	{
+		free(_ini_entries[i].section);
+		free(_ini_entries[i].name);
+		free(_ini_entries[i].value);
+	}
+
+	free(_ini_entries);
+
+	_ini_entries = NULL;
+	_ini_count = 0;
+	_ini_cached = false;
+}
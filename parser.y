@@ -62,6 +62,24 @@ yyerror(YYLTYPE *locp, void *scanner, void **root, const char *str)
 	}
 }
 
+/*! @cond INTERNAL */
+typedef struct
+{
+	/* leading find expressions, grouped from the left */
+	Node *exprs;
+	/* operator following the leading find expressions or the first function call */
+	OperatorType op;
+	/* terms following the first function call, grouped from the right */
+	Node *filter_exprs;
+	/* location of the last operand of filter_exprs */
+	Node **tail;
+	/* true if the operators following exprs aren't all equal to op */
+	bool mixed;
+	/* true if no find expression follows the first function call */
+	bool filter_only;
+} ParserChain;
+/*! @endcond */
+
 static size_t
 _parser_get_alloc_item_size(void)
 {
@@ -97,9 +115,131 @@ _parser_get_alloc_item_size(void)
 		size = sizeof(CompareNode);
 	}
 
+	if(sizeof(ParserChain) > size)
+	{
+		size = sizeof(ParserChain);
+	}
+
 	return size;
 }
 
+static ParserChain *
+_parser_chain_new(Pool *pool, Node *node)
+{
+	assert(pool != NULL);
+	assert(node != NULL);
+
+	ParserChain *chain = pool->alloc(pool);
+
+	memset(chain, 0, sizeof(ParserChain));
+
+	if(ast_is_find_expression(node))
+	{
+		chain->exprs = node;
+	}
+	else
+	{
+		chain->filter_exprs = node;
+		chain->tail = &chain->filter_exprs;
+		chain->filter_only = true;
+	}
+
+	return chain;
+}
+
+static ParserChain *
+_parser_chain_append(Pool *pool, const YYLTYPE *locp, ParserChain *chain, OperatorType op, Node *node)
+{
+	assert(pool != NULL);
+	assert(chain != NULL);
+	assert(node != NULL);
+
+	if(!chain->filter_exprs && ast_is_find_expression(node))
+	{
+		chain->exprs = ast_expr_node_new(pool, locp, chain->exprs, op, node);
+	}
+	else if(!chain->filter_exprs)
+	{
+		chain->op = op;
+		chain->filter_exprs = node;
+		chain->tail = &chain->filter_exprs;
+		chain->filter_only = true;
+	}
+	else
+	{
+		if(!chain->exprs && chain->tail == &chain->filter_exprs)
+		{
+			chain->op = op;
+		}
+		else if(op != chain->op)
+		{
+			chain->mixed = true;
+		}
+
+		if(ast_is_find_expression(node))
+		{
+			chain->filter_only = false;
+		}
+
+		*chain->tail = ast_expr_node_new(pool, locp, *chain->tail, op, node);
+		chain->tail = &((ExpressionNode *)*chain->tail)->second;
+	}
+
+	return chain;
+}
+
+/* Chains of find expressions are grouped from the left, function calls
+   and the terms following them from the right. Both groupings have to
+   agree unless the chain has the form "find expressions and functions". */
+static bool
+_parser_chain_is_ambiguous(const ParserChain *chain)
+{
+	assert(chain != NULL);
+
+	return chain->mixed && !(chain->filter_only && (!chain->exprs || chain->op == OP_AND));
+}
+
+static Node *
+_parser_chain_to_node(Pool *pool, const YYLTYPE *locp, const ParserChain *chain)
+{
+	assert(pool != NULL);
+	assert(chain != NULL);
+
+	Node *node = chain->exprs;
+
+	if(chain->exprs && chain->filter_exprs)
+	{
+		node = ast_expr_node_new(pool, locp, chain->exprs, chain->op, chain->filter_exprs);
+	}
+	else if(chain->filter_exprs)
+	{
+		node = chain->filter_exprs;
+	}
+
+	return node;
+}
+
+static RootNode *
+_parser_root_new(Pool *pool, const YYLTYPE *locp, Node *node)
+{
+	assert(pool != NULL);
+	assert(node != NULL);
+
+	RootNode *root;
+
+	/* the planner moves operands of the top-level "and" chain to find */
+	if(ast_is_find_expression(node))
+	{
+		root = ast_root_node_new(pool, locp, node, NULL);
+	}
+	else
+	{
+		root = ast_root_node_new(pool, locp, NULL, node);
+	}
+
+	return root;
+}
+
 ParserResult *
 parse_string(const char *str)
 {
@@ -172,6 +312,7 @@ void parser_result_free(ParserResult *result)
 %token TOKEN_CMP
 %token TOKEN_OPERATOR
 %token TOKEN_NOT_OPERATOR
+%token TOKEN_PRUNE
 %token TOKEN_PROPERTY
 %token TOKEN_FLAG
 %token TOKEN_COMMA
@@ -182,38 +323,42 @@ void parser_result_free(ParserResult *result)
 %token <ivalue> TOKEN_UNIT
 %token <ivalue> TOKEN_TYPE
 
-%left TOKEN_OPERATOR
-
 %type <root> query
-%type <node> value cond term exprs flag post_exprs post_expr post_term fn_name fn_call fn_arg fn_args
+%type <node> value cond flag chain item post_term fn_name fn_call fn_arg fn_args
 %type <ivalue> property number interval unit compare operator
 
 %%
 query:
-    exprs                                       { *root = ast_root_node_new(POOL(scanner), &@1, $1, NULL); }
-    | post_exprs                                { *root = ast_root_node_new(POOL(scanner), &@1, NULL, $1); }
-    | exprs operator post_exprs                 { if($2 == OP_AND)
-                                                  {
-                                                    *root = ast_root_node_new(POOL(scanner), &@1, $1, $3);
-                                                  }
-                                                  else
+    chain                                       { if(_parser_chain_is_ambiguous($1))
                                                   {
-                                                    yyerror(&@1, scanner, NULL, _("Please use custom functions after the \"and\" operator"));
+                                                    yyerror(&@1, scanner, NULL, _("Please use parentheses to group operators following a function call"));
                                                     YYABORT;
                                                   }
+
+                                                  *root = _parser_root_new(POOL(scanner), &@1, _parser_chain_to_node(POOL(scanner), &@1, $1));
                                                 }
     ;
 
-exprs:
-    exprs operator term                         { $$ = ast_expr_node_new(POOL(scanner), &@1, $1, $2, $3); }
-    | term                                      { $$ = $1; }
+chain:
+    item                                        { $$ = _parser_chain_new(POOL(scanner), $1); }
+    | chain operator item                       { $$ = _parser_chain_append(POOL(scanner), &@1, $1, $2, $3); }
     ;
 
-term:
-    TOKEN_LPAREN exprs TOKEN_RPAREN             { $$ = $2; }
+item:
+    TOKEN_LPAREN chain TOKEN_RPAREN             { if(_parser_chain_is_ambiguous($2))
+                                                  {
+                                                    yyerror(&@2, scanner, NULL, _("Please use parentheses to group operators following a function call"));
+                                                    YYABORT;
+                                                  }
+
+                                                  $$ = _parser_chain_to_node(POOL(scanner), &@1, $2);
+                                                }
     | cond                                      { $$ = $1; }
     | flag                                      { $$ = $1; }
-    | TOKEN_NOT_OPERATOR term                   { $$ = ast_not_node_new(POOL(scanner), &@1, $2); }
+    | TOKEN_NOT_OPERATOR item                   { $$ = ast_not_node_new(POOL(scanner), &@1, $2); }
+    | TOKEN_PRUNE item                          { $$ = ast_prune_node_new(POOL(scanner), &@1, $2); }
+    | post_term                                 { $$ = ast_compare_node_new(POOL(scanner), &@1, $1, CMP_EQ, ast_true_node_new(POOL(scanner), &@1)); }
+    | post_term compare post_term               { $$ = ast_compare_node_new(POOL(scanner), &@1, $1, $2, $3); }
     ;
 
 cond:
@@ -236,18 +381,6 @@ value:
     | TOKEN_TYPE                                { $$ = ast_value_node_new_type(POOL(scanner), &@1, yylval.ivalue); }
     ;
 
-post_exprs:
-    post_expr                                   { $$ = $1; }
-    | post_expr operator post_exprs             { $$ = ast_expr_node_new(POOL(scanner), &@1, $1, $2, $3); }
-    ;
-
-post_expr:
-    post_term                                   { $$ = ast_compare_node_new(POOL(scanner), &@1, $1, CMP_EQ, ast_true_node_new(POOL(scanner), &@1)); }
-    | post_term compare post_term               { $$ = ast_compare_node_new(POOL(scanner), &@1, $1, $2, $3); }
-    | TOKEN_LPAREN post_exprs TOKEN_RPAREN      { $$ = $2; }
-    | TOKEN_NOT_OPERATOR post_expr              { $$ = ast_not_node_new(POOL(scanner), &@1, $2); }
-    ;
-
 post_term:
     fn_call                                     { $$ = $1; }
     | number                                    { $$ = ast_value_node_new_int(POOL(scanner), &@1, yylval.ivalue); }
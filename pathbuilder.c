@@ -97,3 +97,19 @@ path_builder_ignorelist(char *path, size_t path_len)
 	return _path_build_local(".efind/ignore-list", path, path_len);
 }
 
+bool
+path_builder_index(char *path, size_t path_len)
+{
+	assert(path != NULL);
+
+	return _path_build_local(".efind/index", path, path_len);
+}
+
+bool
+path_builder_socket(char *path, size_t path_len)
+{
+	assert(path != NULL);
+
+	return _path_build_local(".efind/socket", path, path_len);
+}
+
@@ -78,5 +78,23 @@ bool path_builder_obsolete_ignorelist(char *path, size_t path_len);
  */
 bool path_builder_ignorelist(char *path, size_t path_len);
 
+/**
+   @param path location to write built path to
+   @param path_len maximum buffer size
+   @return true on success
+
+   Builds the path to the user's default file index.
+ */
+bool path_builder_index(char *path, size_t path_len);
+
+/**
+   @param path location to write built path to
+   @param path_len maximum buffer size
+   @return true on success
+
+   Builds the path to the user's default index daemon socket.
+ */
+bool path_builder_socket(char *path, size_t path_len);
+
 #endif
 
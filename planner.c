@@ -0,0 +1,209 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file planner.c
+   @brief Split queries into find expressions and filter expressions.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#include <stdlib.h>
+#include <assert.h>
+
+#include "planner.h"
+#include "translate.h"
+#include "log.h"
+#include "utils.h"
+#include "gettext.h"
+
+/*! @cond INTERNAL */
+typedef struct
+{
+	Pool *pool;
+	Node *exprs;
+	Node *filter_exprs;
+	Node *prune_exprs;
+	size_t moved;
+} PlannerCtx;
+/*! @endcond */
+
+static Node *
+_planner_append(Pool *pool, Node *chain, Node *node)
+{
+	assert(pool != NULL);
+	assert(node != NULL);
+
+	return chain ? ast_expr_node_new(pool, &node->loc, chain, OP_AND, node) : node;
+}
+
+static void
+_planner_split(PlannerCtx *ctx, Node *node)
+{
+	assert(ctx != NULL);
+	assert(node != NULL);
+
+	if(node->type == NODE_EXPRESSION && ((ExpressionNode *)node)->op == OP_AND)
+	{
+		_planner_split(ctx, ((ExpressionNode *)node)->first);
+		_planner_split(ctx, ((ExpressionNode *)node)->second);
+	}
+	else if(node->type == NODE_PRUNE)
+	{
+		Node *expr = ((PruneNode *)node)->expr;
+
+		ctx->prune_exprs = ctx->prune_exprs ? ast_expr_node_new(ctx->pool, &node->loc, ctx->prune_exprs, OP_OR, expr) : expr;
+	}
+	else if(ast_is_find_expression(node))
+	{
+		ctx->exprs = _planner_append(ctx->pool, ctx->exprs, node);
+		++ctx->moved;
+	}
+	else
+	{
+		ctx->filter_exprs = _planner_append(ctx->pool, ctx->filter_exprs, node);
+	}
+}
+
+static bool
+_planner_contains_prune(const Node *node)
+{
+	bool found = false;
+
+	assert(node != NULL);
+
+	if(node->type == NODE_PRUNE)
+	{
+		found = true;
+	}
+	else if(node->type == NODE_EXPRESSION)
+	{
+		found = _planner_contains_prune(((ExpressionNode *)node)->first)
+		        || _planner_contains_prune(((ExpressionNode *)node)->second);
+	}
+	else if(node->type == NODE_NOT)
+	{
+		found = _planner_contains_prune(((NotNode *)node)->expr);
+	}
+
+	return found;
+}
+
+static bool
+_planner_validate(Node *node, char **err)
+{
+	bool success = true;
+
+	assert(node != NULL);
+	assert(err != NULL);
+
+	if(ast_is_find_expression(node))
+	{
+		size_t argc = 0;
+		char **argv = NULL;
+
+		success = translate(node, TRANSLATION_FLAG_NONE, &argc, &argv, err);
+
+		for(size_t i = 0; i < argc; ++i)
+		{
+			free(argv[i]);
+		}
+
+		free(argv);
+	}
+	else if(node->type == NODE_EXPRESSION)
+	{
+		success = _planner_validate(((ExpressionNode *)node)->first, err)
+		          && _planner_validate(((ExpressionNode *)node)->second, err);
+	}
+	else if(node->type == NODE_NOT)
+	{
+		success = _planner_validate(((NotNode *)node)->expr, err);
+	}
+
+	return success;
+}
+
+bool
+planner_plan(Pool *pool, RootNode *root, char **err)
+{
+	bool success = true;
+
+	assert(pool != NULL);
+	assert(root != NULL);
+	assert(err != NULL);
+
+	*err = NULL;
+
+	if(root->filter_exprs)
+	{
+		PlannerCtx ctx;
+
+		ctx.pool = pool;
+		ctx.exprs = root->exprs;
+		ctx.filter_exprs = NULL;
+		ctx.prune_exprs = NULL;
+		ctx.moved = 0;
+
+		_planner_split(&ctx, root->filter_exprs);
+
+		DEBUGF("planner", "Moved %zu filter operand(s) to find.", ctx.moved);
+
+		root->exprs = ctx.exprs;
+		root->filter_exprs = ctx.filter_exprs;
+		root->prune_exprs = ctx.prune_exprs;
+
+		if((root->filter_exprs && _planner_contains_prune(root->filter_exprs))
+		   || (root->prune_exprs && _planner_contains_prune(root->prune_exprs)))
+		{
+			*err = utils_strdup(_("`prune' can only be used as operand of the top-level `and' chain."));
+			success = false;
+		}
+
+		if(success && root->prune_exprs)
+		{
+			success = _planner_validate(root->prune_exprs, err);
+		}
+
+		if(success && root->filter_exprs)
+		{
+			success = _planner_validate(root->filter_exprs, err);
+		}
+	}
+
+	return success;
+}
+
+void
+planner_evaluate_in_process(Pool *pool, RootNode *root)
+{
+	assert(pool != NULL);
+	assert(root != NULL);
+
+	if(root->exprs)
+	{
+		DEBUG("planner", "Moving find expressions to filter expressions.");
+
+		root->filter_exprs = root->filter_exprs ? ast_expr_node_new(pool, &root->exprs->loc, root->exprs, OP_AND, root->filter_exprs) : root->exprs;
+		root->exprs = NULL;
+	}
+}
+
+bool
+planner_requires_walker(const RootNode *root)
+{
+	assert(root != NULL);
+
+	return root->prune_exprs && !ast_is_find_expression(root->prune_exprs);
+}
@@ -0,0 +1,61 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file planner.h
+   @brief Split queries into find expressions and filter expressions.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stdbool.h>
+#include <datatypes.h>
+
+#include "ast.h"
+
+/**
+   @param pool Pool used to allocate new nodes
+   @param root root node of a query
+   @param err location to store an error message to
+   @return true on success
+
+   Moves all operands of the top-level "and" chain which find can evaluate
+   from the filter expressions to the find expressions. Remaining conditions
+   are evaluated in-process and validated like find expressions.
+
+   Operands of the form "prune expr" are collected in the prune expressions.
+ */
+bool planner_plan(Pool *pool, RootNode *root, char **err);
+
+/**
+   @param pool Pool used to allocate new nodes
+   @param root a planned query
+
+   Moves the find expressions to the filter expressions. This is necessary if
+   the directory tree isn't walked by find.
+ */
+void planner_evaluate_in_process(Pool *pool, RootNode *root);
+
+/**
+   @param root a planned query
+   @return true if the directory tree has to be walked in-process
+
+   Tests if the prune expressions of a query contain functions.
+ */
+bool planner_requires_walker(const RootNode *root);
+
+#endif
@@ -0,0 +1,896 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file predicate.c
+   @brief Evaluate find conditions in-process.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fnmatch.h>
+#include <regex.h>
+#include <pwd.h>
+#include <grp.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#include "predicate.h"
+#include "fs.h"
+#include "log.h"
+#include "utils.h"
+#include "gettext.h"
+
+/*! @cond INTERNAL */
+#ifdef _LARGEFILE64_SOURCE
+typedef struct stat64 PredicateStat;
+#else
+typedef struct stat PredicateStat;
+#endif
+
+typedef struct
+{
+	const ConditionNode *node;
+	bool has_regex;
+	struct re_pattern_buffer regex;
+	long int id;
+} PredicateEntry;
+
+struct _Predicates
+{
+	bool follow;
+	struct timespec now;
+	FSMap *fsmap;
+	PredicateEntry *entries;
+	size_t count;
+};
+
+typedef struct
+{
+	const char *name;
+	reg_syntax_t syntax;
+} RegexSyntax;
+
+static const RegexSyntax REGEX_SYNTAXES[] =
+{
+	{ "findutils-default", RE_SYNTAX_EMACS | RE_DOT_NEWLINE },
+	{ "awk", RE_SYNTAX_AWK },
+	{ "egrep", RE_SYNTAX_EGREP },
+	{ "ed", RE_SYNTAX_ED },
+	{ "emacs", RE_SYNTAX_EMACS },
+	{ "gnu-awk", RE_SYNTAX_GNU_AWK },
+	{ "grep", RE_SYNTAX_GREP },
+	{ "posix-awk", RE_SYNTAX_POSIX_AWK },
+	{ "posix-basic", RE_SYNTAX_POSIX_BASIC },
+	{ "posix-egrep", RE_SYNTAX_POSIX_EGREP },
+	{ "posix-extended", RE_SYNTAX_POSIX_EXTENDED },
+	{ "posix-minimal-basic", RE_SYNTAX_POSIX_MINIMAL_BASIC },
+	{ "sed", RE_SYNTAX_SED },
+	{ NULL, 0 }
+};
+/*! @endcond */
+
+static void
+_predicates_set_error(char **err, const char *fmt, ...)
+{
+	assert(err != NULL);
+	assert(fmt != NULL);
+
+	char msg[4096];
+	va_list ap;
+
+	va_start(ap, fmt);
+
+	int written = vsnprintf(msg, sizeof(msg), fmt, ap);
+
+	if(written > 0 && (size_t)written < sizeof(msg))
+	{
+		*err = utils_strdup(msg);
+	}
+	else
+	{
+		WARNING("predicate", "Couldn't set error message, `vsnprintf' failed.");
+	}
+
+	va_end(ap);
+}
+
+static bool
+_predicates_regex_syntax(const char *regex_type, reg_syntax_t *syntax)
+{
+	bool success = false;
+
+	assert(syntax != NULL);
+
+	if(!regex_type)
+	{
+		regex_type = REGEX_SYNTAXES[0].name;
+	}
+
+	for(const RegexSyntax *iter = REGEX_SYNTAXES; iter->name && !success; ++iter)
+	{
+		if(!strcmp(iter->name, regex_type))
+		{
+			*syntax = iter->syntax;
+			success = true;
+		}
+	}
+
+	return success;
+}
+
+static size_t
+_predicates_count_conditions(const Node *node)
+{
+	size_t count = 0;
+
+	if(node)
+	{
+		switch(node->type)
+		{
+			case NODE_CONDITION:
+				count = 1;
+				break;
+
+			case NODE_EXPRESSION:
+				count = _predicates_count_conditions(((ExpressionNode *)node)->first)
+				        + _predicates_count_conditions(((ExpressionNode *)node)->second);
+				break;
+
+			case NODE_NOT:
+				count = _predicates_count_conditions(((NotNode *)node)->expr);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return count;
+}
+
+static bool
+_predicates_compile_regex(PredicateEntry *entry, const char *regex_type, char **err)
+{
+	bool success = false;
+	reg_syntax_t syntax;
+
+	assert(entry != NULL);
+	assert(err != NULL);
+
+	if(_predicates_regex_syntax(regex_type, &syntax))
+	{
+		const char *pattern = entry->node->value->value.svalue ? entry->node->value->value.svalue : "";
+
+		if(entry->node->prop == PROP_IREGEX)
+		{
+			syntax |= RE_ICASE;
+		}
+
+		memset(&entry->regex, 0, sizeof(struct re_pattern_buffer));
+		re_syntax_options = syntax;
+
+		const char *msg = re_compile_pattern(pattern, strlen(pattern), &entry->regex);
+
+		if(msg)
+		{
+			_predicates_set_error(err, _("Couldn't compile regular expression `%s': %s"), pattern, msg);
+			regfree(&entry->regex);
+		}
+		else
+		{
+			entry->has_regex = true;
+			success = true;
+		}
+	}
+	else
+	{
+		_predicates_set_error(err, _("Unknown regular expression type: %s"), regex_type);
+	}
+
+	return success;
+}
+
+static bool
+_predicates_resolve_id(PredicateEntry *entry, char **err)
+{
+	bool success = true;
+
+	assert(entry != NULL);
+	assert(err != NULL);
+
+	const char *name = entry->node->value->value.svalue ? entry->node->value->value.svalue : "";
+
+	if(entry->node->prop == PROP_USER)
+	{
+		struct passwd *pw = getpwnam(name);
+
+		if(pw)
+		{
+			entry->id = pw->pw_uid;
+		}
+		else if(!utils_parse_integer(name, 0, UINT32_MAX, &entry->id))
+		{
+			_predicates_set_error(err, _("`%s' is not the name of a known user."), name);
+			success = false;
+		}
+	}
+	else
+	{
+		struct group *gr = getgrnam(name);
+
+		if(gr)
+		{
+			entry->id = gr->gr_gid;
+		}
+		else if(!utils_parse_integer(name, 0, UINT32_MAX, &entry->id))
+		{
+			_predicates_set_error(err, _("`%s' is not the name of an existing group."), name);
+			success = false;
+		}
+	}
+
+	return success;
+}
+
+static bool
+_predicates_check_size(const PredicateEntry *entry, char **err)
+{
+	bool success = true;
+
+	assert(entry != NULL);
+	assert(err != NULL);
+
+	const ValueNode *value = entry->node->value;
+
+	if((value->vtype == VALUE_NUMERIC && value->value.ivalue < 0)
+	   || (value->vtype == VALUE_SIZE && value->value.pair.a < 0))
+	{
+		_predicates_set_error(err, _("File sizes cannot be negative."));
+		success = false;
+	}
+
+	return success;
+}
+
+static bool
+_predicates_compile(Predicates *predicates, const Node *node, const char *regex_type, char **err)
+{
+	bool success = true;
+
+	assert(predicates != NULL);
+	assert(err != NULL);
+
+	if(node)
+	{
+		switch(node->type)
+		{
+			case NODE_CONDITION:
+				{
+					PredicateEntry *entry = &predicates->entries[predicates->count];
+
+					entry->node = (ConditionNode *)node;
+					((ConditionNode *)node)->predicate = predicates->count++;
+
+					if(entry->node->prop == PROP_REGEX || entry->node->prop == PROP_IREGEX)
+					{
+						success = _predicates_compile_regex(entry, regex_type, err);
+					}
+					else if(entry->node->prop == PROP_USER || entry->node->prop == PROP_GROUP)
+					{
+						success = _predicates_resolve_id(entry, err);
+					}
+					else if(entry->node->prop == PROP_SIZE)
+					{
+						success = _predicates_check_size(entry, err);
+					}
+					else if(entry->node->prop == PROP_FILESYSTEM && !predicates->fsmap)
+					{
+						predicates->fsmap = fs_map_get_default();
+					}
+				}
+				break;
+
+			case NODE_EXPRESSION:
+				success = _predicates_compile(predicates, ((ExpressionNode *)node)->first, regex_type, err)
+				          && _predicates_compile(predicates, ((ExpressionNode *)node)->second, regex_type, err);
+				break;
+
+			case NODE_NOT:
+				success = _predicates_compile(predicates, ((NotNode *)node)->expr, regex_type, err);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return success;
+}
+
+Predicates *
+predicates_new(Node *root, bool follow, const char *regex_type, char **err)
+{
+	assert(root != NULL);
+	assert(err != NULL);
+
+	*err = NULL;
+
+	Predicates *predicates = utils_new(1, Predicates);
+	size_t count = _predicates_count_conditions(root);
+
+	TRACEF("predicate", "Compiling %zu condition(s).", count);
+
+	predicates->follow = follow;
+	clock_gettime(CLOCK_REALTIME, &predicates->now);
+	predicates->entries = utils_new(count ? count : 1, PredicateEntry);
+
+	if(!_predicates_compile(predicates, root, regex_type, err))
+	{
+		predicates_destroy(predicates);
+		predicates = NULL;
+	}
+
+	return predicates;
+}
+
+void
+predicates_destroy(Predicates *predicates)
+{
+	if(predicates)
+	{
+		for(size_t i = 0; i < predicates->count; ++i)
+		{
+			if(predicates->entries[i].has_regex)
+			{
+				regfree(&predicates->entries[i].regex);
+			}
+		}
+
+		free(predicates->entries);
+		free(predicates);
+	}
+}
+
+static const PredicateEntry *
+_predicates_find_entry(const Predicates *predicates, const ConditionNode *node)
+{
+	const PredicateEntry *entry = NULL;
+
+	assert(predicates != NULL);
+	assert(node != NULL);
+
+	if(node->predicate < predicates->count && predicates->entries[node->predicate].node == node)
+	{
+		entry = &predicates->entries[node->predicate];
+	}
+
+	return entry;
+}
+
+static unsigned int
+_predicates_prop_stat_mask(PropertyId prop)
+{
+	unsigned int mask = 0;
+
+	switch(prop)
+	{
+		case PROP_ATIME:
+			mask = STATX_ATIME;
+			break;
+
+		case PROP_CTIME:
+			mask = STATX_CTIME;
+			break;
+
+		case PROP_MTIME:
+			mask = STATX_MTIME;
+			break;
+
+		case PROP_SIZE:
+			mask = STATX_SIZE;
+			break;
+
+		case PROP_USER:
+		case PROP_USER_ID:
+			mask = STATX_UID;
+			break;
+
+		case PROP_GROUP:
+		case PROP_GROUP_ID:
+			mask = STATX_GID;
+			break;
+
+		case PROP_TYPE:
+			mask = STATX_TYPE;
+			break;
+
+		default:
+			break;
+	}
+
+	return mask;
+}
+
+static bool
+_predicates_stat(const Predicates *predicates, FileInfo *info, unsigned int mask, PredicateStat *sb)
+{
+	bool success = false;
+
+	assert(predicates != NULL);
+	assert(info != NULL);
+	assert(sb != NULL);
+
+	/* find -L falls back to the link itself if the target doesn't exist */
+	const FileInfoStat *target = predicates->follow ? file_info_stat_target(info) : NULL;
+
+	if(target)
+	{
+		*sb = *target;
+		success = true;
+	}
+	else if(file_info_stat_fields(info, mask))
+	{
+		*sb = info->sb;
+		success = true;
+	}
+
+	return success;
+}
+
+static bool
+_predicates_compare(int64_t a, CompareType cmp, int64_t b)
+{
+	bool result = false;
+
+	switch(cmp)
+	{
+		case CMP_EQ:
+			result = a == b;
+			break;
+
+		case CMP_LT_EQ:
+			result = a <= b;
+			break;
+
+		case CMP_LT:
+			result = a < b;
+			break;
+
+		case CMP_GT_EQ:
+			result = a >= b;
+			break;
+
+		case CMP_GT:
+			result = a > b;
+			break;
+
+		default:
+			FATALF("predicate", "Unexpected compare operator: %#x", cmp);
+	}
+
+	return result;
+}
+
+static bool
+_predicates_test_name(const ConditionNode *node, const char *path)
+{
+	assert(node != NULL);
+	assert(path != NULL);
+
+	const char *pattern = node->value->value.svalue ? node->value->value.svalue : "";
+
+	return !fnmatch(pattern, basename(path), (node->prop == PROP_INAME) ? FNM_CASEFOLD : 0);
+}
+
+static bool
+_predicates_test_path(const ConditionNode *node, const char *path)
+{
+	assert(node != NULL);
+	assert(path != NULL);
+
+	const char *pattern = node->value->value.svalue ? node->value->value.svalue : "";
+
+	return !fnmatch(pattern, path, (node->prop == PROP_IPATH) ? FNM_CASEFOLD : 0);
+}
+
+static bool
+_predicates_test_regex(const PredicateEntry *entry, const char *path)
+{
+	assert(entry != NULL);
+	assert(path != NULL);
+
+	bool result = false;
+
+	if(entry->has_regex)
+	{
+		int len = (int)strlen(path);
+
+		/* the regular expression has to match the whole path */
+		result = re_match((struct re_pattern_buffer *)&entry->regex, path, len, 0, NULL) == len;
+	}
+
+	return result;
+}
+
+static bool
+_predicates_test_minutes(double age, CompareType cmp, int64_t minutes)
+{
+	bool result = false;
+	double limit = minutes * 60.0;
+
+	/* find compares elapsed minutes without rounding, -mmin n matches ages in (n - 1, n] */
+	switch(cmp)
+	{
+		case CMP_EQ:
+			result = age > limit - 60.0 && age <= limit;
+			break;
+
+		case CMP_LT_EQ:
+			result = age <= limit;
+			break;
+
+		case CMP_LT:
+			result = age < limit;
+			break;
+
+		case CMP_GT_EQ:
+			result = age > limit - 60.0;
+			break;
+
+		case CMP_GT:
+			result = age > limit;
+			break;
+
+		default:
+			FATALF("predicate", "Unexpected compare operator: %#x", cmp);
+	}
+
+	return result;
+}
+
+static bool
+_predicates_test_time(const Predicates *predicates, const ConditionNode *node, const struct timespec *t)
+{
+	bool result;
+
+	assert(predicates != NULL);
+	assert(node != NULL);
+	assert(t != NULL);
+
+	double age = difftime(predicates->now.tv_sec, t->tv_sec) + (predicates->now.tv_nsec - t->tv_nsec) / 1e9;
+
+	if(node->value->vtype == VALUE_TIME && node->value->value.pair.b == TIME_DAYS)
+	{
+		/* find ignores the fractional part of elapsed days */
+		result = _predicates_compare((int64_t)floor(age / 86400.0), node->cmp, node->value->value.pair.a);
+	}
+	else if(node->value->vtype == VALUE_TIME && node->value->value.pair.b == TIME_HOURS)
+	{
+		result = _predicates_test_minutes(age, node->cmp, (int64_t)node->value->value.pair.a * 60);
+	}
+	else if(node->value->vtype == VALUE_TIME)
+	{
+		result = _predicates_test_minutes(age, node->cmp, node->value->value.pair.a);
+	}
+	else
+	{
+		result = _predicates_test_minutes(age, node->cmp, node->value->value.ivalue);
+	}
+
+	return result;
+}
+
+static bool
+_predicates_test_size(const ConditionNode *node, off_t size)
+{
+	assert(node != NULL);
+
+	int64_t bytes;
+
+	if(node->value->vtype == VALUE_SIZE)
+	{
+		bytes = node->value->value.pair.a;
+
+		for(int i = UNIT_BYTES; i < node->value->value.pair.b; ++i)
+		{
+			bytes *= 1024;
+		}
+	}
+	else
+	{
+		bytes = node->value->value.ivalue;
+	}
+
+	return _predicates_compare(size, node->cmp, bytes);
+}
+
+static bool
+_predicates_test_type(FileType type, mode_t mode)
+{
+	bool result = false;
+
+	switch(type)
+	{
+		case FILE_REGULAR:
+			result = S_ISREG(mode);
+			break;
+
+		case FILE_DIRECTORY:
+			result = S_ISDIR(mode);
+			break;
+
+		case FILE_PIPE:
+			result = S_ISFIFO(mode);
+			break;
+
+		case FILE_SOCKET:
+			result = S_ISSOCK(mode);
+			break;
+
+		case FILE_BLOCK:
+			result = S_ISBLK(mode);
+			break;
+
+		case FILE_CHARACTER:
+			result = S_ISCHR(mode);
+			break;
+
+		case FILE_SYMLINK:
+			result = S_ISLNK(mode);
+			break;
+
+		default:
+			FATALF("predicate", "Unsupported file type: %#x", type);
+	}
+
+	return result;
+}
+
+static bool
+_predicates_directory_is_empty(const char *path)
+{
+	bool empty = false;
+	DIR *dir = opendir(path);
+
+	if(dir)
+	{
+		struct dirent *entry;
+
+		empty = true;
+
+		while(empty && (entry = readdir(dir)))
+		{
+			empty = !strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..");
+		}
+
+		closedir(dir);
+	}
+
+	return empty;
+}
+
+static bool
+_predicates_test_flag(const Predicates *predicates, FileFlag flag, FileInfo *info)
+{
+	bool result = false;
+	PredicateStat sb;
+
+	assert(predicates != NULL);
+	assert(info != NULL);
+
+	switch(flag)
+	{
+		case FILE_FLAG_READABLE:
+			result = !access(info->path, R_OK);
+			break;
+
+		case FILE_FLAG_WRITABLE:
+			result = !access(info->path, W_OK);
+			break;
+
+		case FILE_FLAG_EXECUTABLE:
+			result = !access(info->path, X_OK);
+			break;
+
+		case FILE_FLAG_EMPTY:
+			if(_predicates_stat(predicates, info, STATX_TYPE | STATX_SIZE, &sb))
+			{
+				if(S_ISREG(sb.st_mode))
+				{
+					result = sb.st_size == 0;
+				}
+				else if(S_ISDIR(sb.st_mode))
+				{
+					result = _predicates_directory_is_empty(info->path);
+				}
+			}
+			break;
+
+		default:
+			FATALF("predicate", "Invalid flag: %#x", flag);
+	}
+
+	return result;
+}
+
+static bool
+_predicates_test_condition(const Predicates *predicates, const ConditionNode *node, FileInfo *info, bool *result)
+{
+	bool success = true;
+	PredicateStat sb;
+
+	assert(predicates != NULL);
+	assert(node != NULL);
+	assert(info != NULL);
+	assert(result != NULL);
+
+	*result = false;
+
+	const PredicateEntry *entry = _predicates_find_entry(predicates, node);
+
+	if(!entry)
+	{
+		FATAL("predicate", "Condition hasn't been compiled.");
+		success = false;
+	}
+	else if(node->prop == PROP_NAME || node->prop == PROP_INAME)
+	{
+		*result = _predicates_test_name(node, info->path);
+	}
+	else if(node->prop == PROP_PATH || node->prop == PROP_IPATH)
+	{
+		*result = _predicates_test_path(node, info->path);
+	}
+	else if(node->prop == PROP_REGEX || node->prop == PROP_IREGEX)
+	{
+		*result = _predicates_test_regex(entry, info->path);
+	}
+	else if(node->prop == PROP_TYPE && (info->flags & FILE_INFO_FLAG_TYPE))
+	{
+		/* type taken from the directory entry, see walk() */
+		*result = _predicates_test_type(node->value->value.ivalue, info->type);
+	}
+	else if(node->prop == PROP_FILESYSTEM)
+	{
+		if(predicates->fsmap)
+		{
+			*result = !strcmp(fs_map_path(predicates->fsmap, info->path), node->value->value.svalue ? node->value->value.svalue : "");
+		}
+	}
+	else if(_predicates_stat(predicates, info, _predicates_prop_stat_mask(node->prop), &sb))
+	{
+		switch(node->prop)
+		{
+			case PROP_ATIME:
+				*result = _predicates_test_time(predicates, node, &sb.st_atim);
+				break;
+
+			case PROP_CTIME:
+				*result = _predicates_test_time(predicates, node, &sb.st_ctim);
+				break;
+
+			case PROP_MTIME:
+				*result = _predicates_test_time(predicates, node, &sb.st_mtim);
+				break;
+
+			case PROP_SIZE:
+				*result = _predicates_test_size(node, sb.st_size);
+				break;
+
+			case PROP_USER:
+			case PROP_USER_ID:
+				*result = (long int)sb.st_uid == ((node->prop == PROP_USER) ? entry->id : node->value->value.ivalue);
+				break;
+
+			case PROP_GROUP:
+			case PROP_GROUP_ID:
+				*result = (long int)sb.st_gid == ((node->prop == PROP_GROUP) ? entry->id : node->value->value.ivalue);
+				break;
+
+			case PROP_TYPE:
+				*result = _predicates_test_type(node->value->value.ivalue, sb.st_mode);
+				break;
+
+			default:
+				FATALF("predicate", "Invalid property id: %#x", node->prop);
+				success = false;
+		}
+	}
+
+	return success;
+}
+
+bool
+predicates_test(const Predicates *predicates, const Node *node, FileInfo *info, bool *result)
+{
+	bool success = true;
+
+	assert(predicates != NULL);
+	assert(node != NULL);
+	assert(info != NULL);
+	assert(result != NULL);
+
+	if(node->type == NODE_TRUE)
+	{
+		*result = true;
+	}
+	else if(node->type == NODE_VALUE && ((ValueNode *)node)->vtype == VALUE_FLAG)
+	{
+		*result = _predicates_test_flag(predicates, ((ValueNode *)node)->value.ivalue, info);
+	}
+	else if(node->type == NODE_CONDITION)
+	{
+		success = _predicates_test_condition(predicates, (ConditionNode *)node, info, result);
+	}
+	else
+	{
+		FATALF("predicate", "Unexpected node type: %#x", node->type);
+		success = false;
+	}
+
+	TRACEF("predicate", "Tested node of type %#x: success=%d", node->type, success);
+
+	return success;
+}
+
+unsigned int
+predicates_stat_mask(const Node *node)
+{
+	unsigned int mask = 0;
+
+	if(node)
+	{
+		switch(node->type)
+		{
+			case NODE_EXPRESSION:
+				mask = predicates_stat_mask(((ExpressionNode *)node)->first)
+				       | predicates_stat_mask(((ExpressionNode *)node)->second);
+				break;
+
+			case NODE_NOT:
+				mask = predicates_stat_mask(((NotNode *)node)->expr);
+				break;
+
+			case NODE_PRUNE:
+				mask = predicates_stat_mask(((PruneNode *)node)->expr);
+				break;
+
+			case NODE_CONDITION:
+				mask = _predicates_prop_stat_mask(((ConditionNode *)node)->prop);
+				break;
+
+			case NODE_VALUE:
+				if(((ValueNode *)node)->vtype == VALUE_FLAG && ((ValueNode *)node)->value.ivalue == FILE_FLAG_EMPTY)
+				{
+					mask = STATX_TYPE | STATX_SIZE;
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return mask;
+}
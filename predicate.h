@@ -0,0 +1,76 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file predicate.h
+   @brief Evaluate find conditions in-process.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include <stdbool.h>
+
+#include "ast.h"
+#include "fileinfo.h"
+
+/**
+   @struct Predicates
+   @brief Compiled conditions of a filter expression. Regular expressions are
+          compiled and user and group names are resolved once.
+ */
+typedef struct _Predicates Predicates;
+
+/**
+   @param root root node of a filter expression
+   @param follow true to dereference symbolic links
+   @param regex_type regular expression syntax (NULL for find's default)
+   @param err location to store an error message to
+   @return a new Predicates instance or NULL on failure
+
+   Compiles all conditions found in a filter expression.
+ */
+Predicates *predicates_new(Node *root, bool follow, const char *regex_type, char **err);
+
+/**
+   @param predicates Predicates to destroy
+
+   Frees a Predicates instance.
+ */
+void predicates_destroy(Predicates *predicates);
+
+/**
+   @param predicates compiled conditions
+   @param node a ConditionNode, TrueNode or flag
+   @param info file to test
+   @param result location to store the result to
+   @return true on success
+
+   Tests a condition against a file with the same semantics as find. The
+   file status is read on demand. Multiple threads may test conditions of
+   the same Predicates instance at the same time.
+ */
+bool predicates_test(const Predicates *predicates, const Node *node, FileInfo *info, bool *result);
+
+/**
+   @param node an expression (may be NULL)
+   @return statx fields needed to test the conditions of the expression
+
+   Gets the file status fields the conditions of an expression depend on.
+ */
+unsigned int predicates_stat_mask(const Node *node);
+
+#endif
@@ -31,38 +31,46 @@
 typedef struct
 {
 	Processor padding;
-	const char *path;
+	FILE *out;
+	FileInfo *info;
 } PrintProcessor;
 /*! @endcond */
 
-static const char *
+static FileInfo *
 _print_processor_read(Processor *processor)
 {
 	assert(processor != NULL);
 
 	processor->flags &= ~PROCESSOR_FLAG_READABLE;
 
-	return ((PrintProcessor *)processor)->path;
+	return ((PrintProcessor *)processor)->info;
 }
 
 static void
-_print_processor_write(Processor *processor, const char *dir, const char *path)
+_print_processor_write(Processor *processor, FileInfo *info)
 {
 	assert(processor != NULL);
-	assert(dir != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	PrintProcessor *print = (PrintProcessor *)processor;
 
-	printf("%s\n", path);
+	fprintf(print->out, "%s\n", info->path);
+
+	/* e.g. the read end of a pipe has been closed */
+	if(ferror(print->out))
+	{
+		processor->flags |= PROCESSOR_FLAG_ERROR;
+	}
 
 	processor->flags |= PROCESSOR_FLAG_READABLE;
-	print->path = path;
+	print->info = info;
 }
 
 Processor *
-print_processor_new(void)
+print_processor_new(FILE *out)
 {
+	assert(out != NULL);
+
 	Processor *processor = (Processor *)utils_malloc(sizeof(PrintProcessor));
 
 	memset(processor, 0, sizeof(PrintProcessor));
@@ -70,6 +78,8 @@ print_processor_new(void)
 	processor->read = _print_processor_read;
 	processor->write = _print_processor_write;
 
+	((PrintProcessor *)processor)->out = out;
+
 	return processor;
 }
 
@@ -78,34 +88,39 @@ typedef struct
 {
 	Processor padding;
 	FormatParserResult *format;
-	const char *path;
+	FILE *out;
+	FileInfo *info;
 } FormatProcessor;
 /*! @endcond */
 
 
-static const char *
+static FileInfo *
 _print_format_processor_read(Processor *processor)
 {
 	assert(processor != NULL);
 
 	processor->flags &= ~PROCESSOR_FLAG_READABLE;
 
-	return ((FormatProcessor *)processor)->path;
+	return ((FormatProcessor *)processor)->info;
 }
 
 static void
-_print_format_processor_write(Processor *processor, const char *dir, const char *path)
+_print_format_processor_write(Processor *processor, FileInfo *info)
 {
 	assert(processor != NULL);
-	assert(dir != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	FormatProcessor *print = (FormatProcessor *)processor;
 
-	format_write(print->format, dir, path, stdout);
+	format_write(print->format, info, print->out);
+
+	if(ferror(print->out))
+	{
+		processor->flags |= PROCESSOR_FLAG_ERROR;
+	}
 
 	processor->flags |= PROCESSOR_FLAG_READABLE;
-	print->path = path;
+	print->info = info;
 }
 
 static void
@@ -117,11 +132,12 @@ _print_format_processor_free(Processor *processor)
 }
 
 Processor *
-print_format_processor_new(const char *format)
+print_format_processor_new(const char *format, FILE *out)
 {
 	Processor *processor = NULL;
 
 	assert(format != NULL);
+	assert(out != NULL);
 
 	FormatParserResult *result = format_parse(format);
 
@@ -136,6 +152,7 @@ print_format_processor_new(const char *format)
 		processor->free = _print_format_processor_free;
 
 		((FormatProcessor *)processor)->format = result;
+		((FormatProcessor *)processor)->out = out;
 	}
 	else
 	{
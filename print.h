@@ -23,23 +23,26 @@
 #define PRINT_H
 
 #include <stdlib.h>
+#include <stdio.h>
 
 #include "processor.h"
 
 /**
+   @param out stream to write to
    @return a new Processor
 
-   Prints a found file to stdout.
+   Prints a found file to the given stream.
  */
-Processor *print_processor_new(void);
+Processor *print_processor_new(FILE *out);
 
 /**
    @param format a format string
+   @param out stream to write to
    @return a new Processor
 
    Prints a found file using a format string.
  */
-Processor *print_format_processor_new(const char *format);
+Processor *print_format_processor_new(const char *format, FILE *out);
 
 #endif
 
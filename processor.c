@@ -27,30 +27,30 @@
 #include "utils.h"
 #include "log.h"
 
-const char *
+FileInfo *
 processor_read(Processor *processor)
 {
-	const char *path = NULL;
+	FileInfo *info = NULL;
 
 	assert(processor != NULL);
 
 	if(processor_is_readable(processor) && !processor_is_closed(processor))
 	{
-		path = processor->read(processor);
+		info = processor->read(processor);
 	}
 
-	return path;
+	return info;
 }
 
 void
-processor_write(Processor *processor, const char *dir, const char *path)
+processor_write(Processor *processor, FileInfo *info)
 {
 	assert(processor != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	if(!processor_is_closed(processor))
 	{
-		processor->write(processor, dir, path);
+		processor->write(processor, info);
 	}
 }
 
@@ -75,7 +75,7 @@ processor_destroy(Processor *processor)
 }
 
 void
-processor_close(Processor *processor, const char *dir)
+processor_close(Processor *processor)
 {
 	assert(processor != NULL);
 
@@ -126,14 +126,13 @@ _processor_state_to_chain_result(const Processor *processor)
 }
 
 ProcessorChainResult
-processor_chain_write(ProcessorChain *chain, const char *dir, const char *path)
+processor_chain_write(ProcessorChain *chain, FileInfo *info)
 {
 	ProcessorChainResult result = PROCESSOR_CHAIN_CONTINUE;
 
-	assert(dir != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
-	TRACEF("processor", "Writing to processor chain: dir=%s, path=%s", dir, path);
+	TRACEF("processor", "Writing to processor chain: dir=%s, path=%s", info->cli, info->path);
 
 	if(chain)
 	{
@@ -143,13 +142,13 @@ processor_chain_write(ProcessorChain *chain, const char *dir, const char *path)
 
 		if(result == PROCESSOR_CHAIN_CONTINUE)
 		{
-			processor_write(head, dir, path);
+			processor_write(head, info);
 
 			while(processor_is_readable(head) && result == PROCESSOR_CHAIN_CONTINUE)
 			{
 				TRACE("processor", "Reading from processor.");
 
-				result = processor_chain_write(chain->next, dir, processor_read(head));
+				result = processor_chain_write(chain->next, processor_read(head));
 			}
 		}
 	}
@@ -162,12 +161,10 @@ processor_chain_write(ProcessorChain *chain, const char *dir, const char *path)
 }
 
 ProcessorChainResult
-processor_chain_complete(ProcessorChain *chain, const char *dir)
+processor_chain_complete(ProcessorChain *chain)
 {
 	ProcessorChainResult result = PROCESSOR_CHAIN_COMPLETED;
 
-	assert(dir != NULL);
-
 	if(chain)
 	{
 		Processor *head = chain->processor;
@@ -176,16 +173,16 @@ processor_chain_complete(ProcessorChain *chain, const char *dir)
 
 		if(result == PROCESSOR_CHAIN_CONTINUE)
 		{
-			processor_close(head, dir);
+			processor_close(head);
 
 			while(processor_is_readable(head) && result != PROCESSOR_CHAIN_COMPLETED)
 			{
-				result = processor_chain_write(chain->next, dir, processor_read(head));
+				result = processor_chain_write(chain->next, processor_read(head));
 			}
 
 			if(result == PROCESSOR_CHAIN_CONTINUE)
 			{
-				result = PROCESSOR_CHAIN_COMPLETED;
+				result = processor_has_error(head) ? PROCESSOR_CHAIN_ERROR : PROCESSOR_CHAIN_COMPLETED;
 			}
 		}
 	}
@@ -24,6 +24,8 @@
 
 #include <stdbool.h>
 
+#include "fileinfo.h"
+
 /**
    @enum ProcessorFlags
    @brief Available processor state flags.
@@ -54,16 +56,16 @@ typedef struct _Processor
 	   
 	   Reads (and pops) data from the processor's source.
 	 */
-	const char *(*read)(struct _Processor *processor);
+	FileInfo *(*read)(struct _Processor *processor);
 
 	/**
 	   @param processor processor to write to
-	   @param dir search directory
-	   @param path found file
+	   @param info found file
 	   
-	   Writes a found file to the processor's sink.
+	   Writes a found file to the processor's sink. Processors which keep the
+	   FileInfo after returning have to increment its reference counter.
 	 */
-	void (*write)(struct _Processor *processor, const char *dir, const char *path);
+	void (*write)(struct _Processor *processor, FileInfo *info);
 
 	/**
 	   @param processor processor to close
@@ -131,16 +133,15 @@ typedef void (*ProcessorChainBuilderFn)(ProcessorChainBuilder *builder);
 
    Reads (and pops) data from the processor's source.
  */
-const char *processor_read(Processor *processor);
+FileInfo *processor_read(Processor *processor);
 
 /**
    @param processor processor to write to
-   @param dir search directory
-   @param path found file
+   @param info found file
 
    Writes a found file to the processor's sink.
  */
-void processor_write(Processor *processor, const char *dir, const char *path);
+void processor_write(Processor *processor, FileInfo *info);
 
 /**
    @param processor processor to free
@@ -158,11 +159,10 @@ void processor_destroy(Processor *processor);
 
 /**
    @param processor processor to close
-   @param dir search directory
    
    Closes a processor.
  */
-void processor_close(Processor *processor, const char *dir);
+void processor_close(Processor *processor);
 
 /**
    @param chain a processor chain (or NULL if empty)
@@ -189,22 +189,20 @@ typedef enum
 
 /**
    @param chain chain which should process a found path
-   @param dir search directory
-   @param path a found file
+   @param info a found file
    @return new state of the chain
    
    Processes a found file.
  */
-ProcessorChainResult processor_chain_write(ProcessorChain *chain, const char *dir, const char *path);
+ProcessorChainResult processor_chain_write(ProcessorChain *chain, FileInfo *info);
 
 /**
    @param chain a processor chain
-   @param dir search directory
    @return new state of the chain
    
    Closes the first processor of the chain. This will stop any further processing.
  */
-ProcessorChainResult processor_chain_complete(ProcessorChain *chain, const char *dir);
+ProcessorChainResult processor_chain_complete(ProcessorChain *chain);
 
 /**
    @param chain chain to destroy
@@ -676,6 +676,63 @@ _py_ext_discover(void *handle, RegisterCallback fn, RegistrationCtx *ctx)
 	}
 }
 
+static void
+_py_ext_discover_pure(void *handle, MarkPure fn, RegistrationCtx *ctx)
+{
+	PyHandle *py_handle = (PyHandle *)handle;
+
+	assert(py_handle != NULL);
+	assert(py_handle->module != NULL);
+	assert(fn != NULL);
+
+	TRACE("python", "Searching for symbol: `EXTENSION_PURE'");
+
+	if(!PyObject_HasAttrString((PyObject *)py_handle->module, "EXTENSION_PURE"))
+	{
+		TRACE("python", "Couldn't find sequence `EXTENSION_PURE'.");
+		return;
+	}
+
+	PyObject *pure = PyObject_GetAttrString((PyObject *)py_handle->module, "EXTENSION_PURE");
+
+	if(pure)
+	{
+		if(PySequence_Check(pure))
+		{
+			Py_ssize_t len = PySequence_Length(pure);
+
+			for(Py_ssize_t i = 0; i < len; i++)
+			{
+				PyObject *callable = PySequence_ITEM(pure, i);
+				PyObject *name = PyObject_GetAttrString(callable, "__name__");
+
+				if(name && PyUnicode_Check(name))
+				{
+					fn(ctx, PyUnicode_AsUTF8(name));
+				}
+				else
+				{
+					PyErr_Clear();
+					DEBUGF("python", "Object at position %ld of sequence `EXTENSION_PURE' has no name.", i);
+				}
+
+				Py_XDECREF(name);
+				Py_DECREF(callable);
+			}
+		}
+		else
+		{
+			DEBUG("python", "`EXTENSION_PURE' is not a sequence.");
+		}
+
+		Py_DECREF(pure);
+	}
+	else
+	{
+		PyErr_Print();
+	}
+}
+
 static PyObject *
 _py_build_function_tuple(const char *filename, uint32_t argc, void **argv, int *sig)
 {
@@ -853,6 +910,9 @@ py_extension_backend_get_class(ExtensionBackendClass *cls)
 
 	cls->load = _py_ext_backend_load;
 	cls->discover = _py_ext_discover;
+	cls->discover_pure = _py_ext_discover_pure;
+	/* Python functions are invoked from the main thread only */
+	cls->discover_reentrant = NULL;
 	cls->invoke = _py_ext_backend_invoke;
 	cls->unload = _py_ext_backend_unload;
 }
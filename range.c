@@ -31,11 +31,11 @@ typedef struct
 	Processor padding;
 	size_t range;
 	size_t count;
-	const char *path;
+	FileInfo *info;
 } RangeProcessor;
 /*! @endcond */
 
-static const char *
+static FileInfo *
 _limit_processor_read(Processor *processor)
 {
 	assert(processor != NULL);
@@ -49,15 +49,14 @@ _limit_processor_read(Processor *processor)
 		processor->flags |= PROCESSOR_FLAG_CLOSED;
 	}
 
-	return range->path;
+	return range->info;
 }
 
 static void
-_limit_processor_write(Processor *processor, const char *dir, const char *path)
+_limit_processor_write(Processor *processor, FileInfo *info)
 {
 	assert(processor != NULL);
-	assert(dir != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	RangeProcessor *range = (RangeProcessor *)processor;
 
@@ -65,7 +64,7 @@ _limit_processor_write(Processor *processor, const char *dir, const char *path)
 	{
 		processor->flags |= PROCESSOR_FLAG_READABLE;
 		++range->count;
-		range->path = path;
+		range->info = info;
 	}
 	else
 	{
@@ -74,29 +73,28 @@ _limit_processor_write(Processor *processor, const char *dir, const char *path)
 	}
 }
 
-static const char *
+static FileInfo *
 _skip_processor_read(Processor *processor)
 {
 	assert(processor != NULL);
 
 	processor->flags &= ~PROCESSOR_FLAG_READABLE;
 
-	return ((RangeProcessor *)processor)->path;
+	return ((RangeProcessor *)processor)->info;
 }
 
 static void
-_skip_processor_write(Processor *processor, const char *dir, const char *path)
+_skip_processor_write(Processor *processor, FileInfo *info)
 {
 	assert(processor != NULL);
-	assert(dir != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	RangeProcessor *range = (RangeProcessor *)processor;
 
 	if(range->count >= range->range)
 	{
 		processor->flags |= PROCESSOR_FLAG_READABLE;
-		range->path = path;
+		range->info = info;
 	}
 	else
 	{
@@ -106,8 +104,8 @@ _skip_processor_write(Processor *processor, const char *dir, const char *path)
 }
 
 static Processor *
-_range_processor_new(const char *(*read)(Processor *processor),
-                     void (*write)(struct _Processor *processor, const char *dir, const char *path),
+_range_processor_new(FileInfo *(*read)(Processor *processor),
+                     void (*write)(struct _Processor *processor, FileInfo *info),
                      size_t range)
 {
 	assert(read != NULL);
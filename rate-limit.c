@@ -0,0 +1,152 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file rate-limit.c
+   @brief Limit the rate of I/O operations.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <assert.h>
+
+#include "rate-limit.h"
+#include "log.h"
+
+/*! @cond INTERNAL */
+struct _RateLimit
+{
+	/* nanoseconds per operation */
+	int64_t interval;
+	/* nanoseconds operations may be performed ahead of schedule */
+	int64_t tolerance;
+	/* time the next operation is scheduled at */
+	int64_t tat;
+	/* operations aren't delayed beyond this time (0 for no deadline) */
+	int64_t deadline;
+};
+
+#define RATE_LIMIT_BURST_NS 100000000
+/*! @endcond */
+
+static int64_t
+_rate_limit_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+RateLimit *
+rate_limit_new(unsigned int rate)
+{
+	assert(rate > 0);
+
+	/* the bucket is shared with forked searches */
+	RateLimit *limit = mmap(NULL, sizeof(RateLimit), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if(limit == MAP_FAILED)
+	{
+		perror("mmap()");
+		limit = NULL;
+	}
+	else
+	{
+		DEBUGF("misc", "Limiting I/O to %u operations per second.", rate);
+
+		limit->interval = 1000000000 / rate;
+		limit->tolerance = limit->interval > RATE_LIMIT_BURST_NS ? limit->interval : RATE_LIMIT_BURST_NS;
+		limit->tat = 0;
+		limit->deadline = 0;
+	}
+
+	return limit;
+}
+
+void
+rate_limit_destroy(RateLimit *limit)
+{
+	if(limit)
+	{
+		munmap(limit, sizeof(RateLimit));
+	}
+}
+
+void
+rate_limit_set_deadline(RateLimit *limit, int64_t deadline)
+{
+	if(limit)
+	{
+		__atomic_store_n(&limit->deadline, deadline * 1000000, __ATOMIC_RELAXED);
+	}
+}
+
+bool
+rate_limit_acquire(RateLimit *limit, unsigned int tokens)
+{
+	bool success = true;
+
+	if(limit && tokens)
+	{
+		int64_t now = _rate_limit_now();
+		int64_t tat = __atomic_load_n(&limit->tat, __ATOMIC_RELAXED);
+		int64_t start;
+
+		/* reserve the next slots, concurrent callers retry with the updated schedule */
+		do
+		{
+			start = tat > now ? tat : now;
+		} while(!__atomic_compare_exchange_n(&limit->tat, &tat, start + limit->interval * tokens, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+		int64_t wakeup = start - limit->tolerance;
+		int64_t deadline = __atomic_load_n(&limit->deadline, __ATOMIC_RELAXED);
+
+		if(deadline && wakeup >= deadline)
+		{
+			TRACE("misc", "I/O operation(s) scheduled after the deadline.");
+
+			wakeup = deadline;
+			success = false;
+		}
+
+		int64_t delay = wakeup - now;
+
+		if(delay > 0)
+		{
+			struct timespec ts;
+
+			TRACEF("misc", "Delaying %u I/O operation(s) by %ld ns.", tokens, (long)delay);
+
+			ts.tv_sec = delay / 1000000000;
+			ts.tv_nsec = delay % 1000000000;
+
+			int rc;
+
+			do
+			{
+				rc = nanosleep(&ts, &ts);
+			} while(rc == -1 && errno == EINTR);
+		}
+	}
+
+	return success;
+}
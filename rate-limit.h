@@ -0,0 +1,70 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file rate-limit.h
+   @brief Limit the rate of I/O operations.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef RATE_LIMIT_H
+#define RATE_LIMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+   @struct RateLimit
+   @brief A token bucket shared by all threads and child processes of efind.
+          Operations exceeding the rate wait until tokens are available.
+ */
+typedef struct _RateLimit RateLimit;
+
+/**
+   @param rate operations per second
+   @return a new RateLimit or NULL on failure
+
+   Creates a RateLimit. Up to a tenth of a second's worth of operations may
+   be performed in a burst.
+ */
+RateLimit *rate_limit_new(unsigned int rate);
+
+/**
+   @param limit RateLimit to free (may be NULL)
+
+   Frees a RateLimit.
+ */
+void rate_limit_destroy(RateLimit *limit);
+
+/**
+   @param limit a RateLimit (may be NULL)
+   @param deadline monotonic time in milliseconds, 0 for no deadline
+
+   Sets the time operations aren't delayed beyond.
+ */
+void rate_limit_set_deadline(RateLimit *limit, int64_t deadline);
+
+/**
+   @param limit a RateLimit (may be NULL)
+   @param tokens number of operations to perform
+   @return false if the operations are scheduled after the deadline
+
+   Blocks until the given number of operations may be performed. If the
+   operations are scheduled after the deadline the function returns when
+   the deadline is reached.
+ */
+bool rate_limit_acquire(RateLimit *limit, unsigned int tokens);
+
+#endif
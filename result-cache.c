@@ -0,0 +1,768 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file result-cache.c
+   @brief Cache search results of unchanged directories.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <assert.h>
+
+#include "result-cache.h"
+#include "log.h"
+#include "utils.h"
+#include "gettext.h"
+
+/*! @cond INTERNAL */
+#define RESULT_CACHE_MAGIC   "EFRC"
+#define RESULT_CACHE_VERSION 1
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME        1099511628211ULL
+
+typedef struct
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t key_len;
+	uint64_t count;
+} ResultCacheHeader;
+
+typedef struct
+{
+	uint64_t dev;
+	uint64_t ino;
+	int64_t mtime_sec;
+	int64_t mtime_nsec;
+	int64_t ctime_sec;
+	int64_t ctime_nsec;
+} ResultCacheStatus;
+
+typedef struct
+{
+	ResultCacheStatus status;
+	uint32_t path_len;
+	uint32_t count;
+} ResultCacheDirHeader;
+
+typedef struct
+{
+	char *name;
+	unsigned char type;
+} ResultCacheEntry;
+
+typedef struct _ResultCacheDir
+{
+	char *path;
+	uint64_t hash;
+	ResultCacheStatus status;
+	bool listed;
+	bool cached;
+	bool failed;
+	ResultCacheEntry *entries;
+	size_t count;
+	size_t size;
+	struct _ResultCacheDir *next;
+} ResultCacheDir;
+
+typedef struct
+{
+	ResultCacheDir **buckets;
+	size_t buckets_count;
+	ResultCacheDir **dirs;
+	size_t count;
+	size_t size;
+} ResultCacheTable;
+
+struct _ResultCache
+{
+	char *filename;
+	char *key;
+	bool follow;
+	ResultCacheTable old;
+	ResultCacheTable dirs;
+};
+/*! @endcond */
+
+static uint64_t
+_result_cache_hash(const char *str)
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+
+	assert(str != NULL);
+
+	for(const unsigned char *ptr = (const unsigned char *)str; *ptr; ++ptr)
+	{
+		hash ^= *ptr;
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static ResultCacheDir *
+_result_cache_dir_new(const char *path)
+{
+	assert(path != NULL);
+
+	ResultCacheDir *dir = utils_new(1, ResultCacheDir);
+
+	dir->path = utils_strdup(path);
+	dir->hash = _result_cache_hash(path);
+
+	return dir;
+}
+
+static void
+_result_cache_dir_free(ResultCacheDir *dir)
+{
+	if(dir)
+	{
+		for(size_t i = 0; i < dir->count; ++i)
+		{
+			free(dir->entries[i].name);
+		}
+
+		free(dir->entries);
+		free(dir->path);
+		free(dir);
+	}
+}
+
+static void
+_result_cache_table_clear(ResultCacheTable *table)
+{
+	assert(table != NULL);
+
+	for(size_t i = 0; i < table->count; ++i)
+	{
+		_result_cache_dir_free(table->dirs[i]);
+	}
+
+	free(table->dirs);
+	free(table->buckets);
+	memset(table, 0, sizeof(ResultCacheTable));
+}
+
+static void
+_result_cache_table_rehash(ResultCacheTable *table)
+{
+	assert(table != NULL);
+
+	free(table->buckets);
+
+	table->buckets_count = table->buckets_count ? table->buckets_count * 2 : 64;
+	table->buckets = utils_new(table->buckets_count, ResultCacheDir *);
+
+	for(size_t i = 0; i < table->count; ++i)
+	{
+		ResultCacheDir *dir = table->dirs[i];
+		size_t bucket = dir->hash & (table->buckets_count - 1);
+
+		dir->next = table->buckets[bucket];
+		table->buckets[bucket] = dir;
+	}
+}
+
+static void
+_result_cache_table_insert(ResultCacheTable *table, ResultCacheDir *dir)
+{
+	assert(table != NULL);
+	assert(dir != NULL);
+
+	if(table->count == table->size)
+	{
+		table->size = table->size ? table->size * 2 : 64;
+
+		if(table->dirs)
+		{
+			table->dirs = utils_renew(table->dirs, table->size, ResultCacheDir *);
+		}
+		else
+		{
+			table->dirs = utils_new(table->size, ResultCacheDir *);
+		}
+	}
+
+	table->dirs[table->count++] = dir;
+
+	if(table->count > table->buckets_count)
+	{
+		_result_cache_table_rehash(table);
+	}
+	else
+	{
+		size_t bucket = dir->hash & (table->buckets_count - 1);
+
+		dir->next = table->buckets[bucket];
+		table->buckets[bucket] = dir;
+	}
+}
+
+static ResultCacheDir *
+_result_cache_table_lookup(const ResultCacheTable *table, const char *path)
+{
+	ResultCacheDir *dir = NULL;
+
+	assert(table != NULL);
+	assert(path != NULL);
+
+	if(table->buckets_count)
+	{
+		uint64_t hash = _result_cache_hash(path);
+
+		dir = table->buckets[hash & (table->buckets_count - 1)];
+
+		while(dir && (dir->hash != hash || strcmp(dir->path, path)))
+		{
+			dir = dir->next;
+		}
+	}
+
+	return dir;
+}
+
+static void
+_result_cache_dir_append(ResultCacheDir *dir, const char *name, unsigned char type)
+{
+	assert(dir != NULL);
+	assert(name != NULL);
+
+	if(dir->count == dir->size)
+	{
+		dir->size = dir->size ? dir->size * 2 : 8;
+
+		if(dir->entries)
+		{
+			dir->entries = utils_renew(dir->entries, dir->size, ResultCacheEntry);
+		}
+		else
+		{
+			dir->entries = utils_new(dir->size, ResultCacheEntry);
+		}
+	}
+
+	dir->entries[dir->count].name = utils_strdup(name);
+	dir->entries[dir->count].type = type;
+	++dir->count;
+}
+
+static void
+_result_cache_status_from_stat(ResultCacheStatus *status, const struct stat *st)
+{
+	assert(status != NULL);
+	assert(st != NULL);
+
+	memset(status, 0, sizeof(ResultCacheStatus));
+
+	status->dev = st->st_dev;
+	status->ino = st->st_ino;
+	status->mtime_sec = st->st_mtim.tv_sec;
+	status->mtime_nsec = st->st_mtim.tv_nsec;
+	status->ctime_sec = st->st_ctim.tv_sec;
+	status->ctime_nsec = st->st_ctim.tv_nsec;
+}
+
+static bool
+_result_cache_normalize(const char *path, char *dst)
+{
+	size_t len = strlen(path);
+
+	if(len >= PATH_MAX)
+	{
+		return false;
+	}
+
+	/* the walker keeps trailing slashes of starting points */
+	while(len > 1 && path[len - 1] == '/')
+	{
+		--len;
+	}
+
+	memcpy(dst, path, len);
+	dst[len] = '\0';
+
+	return true;
+}
+
+static const char *
+_result_cache_split(const char *path, char *parent)
+{
+	const char *name = NULL;
+
+	if(_result_cache_normalize(path, parent))
+	{
+		char *offset = strrchr(parent, '/');
+
+		if(offset && offset[1])
+		{
+			name = path + (offset - parent) + 1;
+			offset[offset == parent] = '\0';
+		}
+	}
+
+	return name;
+}
+
+static bool
+_result_cache_read(const char **ptr, const char *end, void *dst, size_t len)
+{
+	bool success = false;
+
+	if((size_t)(end - *ptr) >= len)
+	{
+		memcpy(dst, *ptr, len);
+		*ptr += len;
+		success = true;
+	}
+
+	return success;
+}
+
+static bool
+_result_cache_parse_dir(ResultCache *cache, const char **ptr, const char *end)
+{
+	ResultCacheDirHeader header;
+	char path[PATH_MAX];
+	bool success = false;
+
+	if(_result_cache_read(ptr, end, &header, sizeof(ResultCacheDirHeader))
+	   && header.path_len && header.path_len < PATH_MAX
+	   && _result_cache_read(ptr, end, path, header.path_len))
+	{
+		path[header.path_len] = '\0';
+
+		ResultCacheDir *dir = _result_cache_dir_new(path);
+
+		dir->status = header.status;
+		success = true;
+
+		for(uint32_t i = 0; i < header.count && success; ++i)
+		{
+			uint8_t type;
+			uint16_t len;
+			char name[PATH_MAX];
+
+			success = _result_cache_read(ptr, end, &type, sizeof(uint8_t))
+			          && _result_cache_read(ptr, end, &len, sizeof(uint16_t))
+			          && len && len < sizeof(name)
+			          && _result_cache_read(ptr, end, name, len);
+
+			if(success)
+			{
+				name[len] = '\0';
+				_result_cache_dir_append(dir, name, type);
+			}
+		}
+
+		if(success)
+		{
+			_result_cache_table_insert(&cache->old, dir);
+		}
+		else
+		{
+			_result_cache_dir_free(dir);
+		}
+	}
+
+	return success;
+}
+
+static bool
+_result_cache_parse(ResultCache *cache, const char *data, size_t size)
+{
+	ResultCacheHeader header;
+	const char *ptr = data;
+	const char *end = data + size;
+	bool success = false;
+
+	assert(cache != NULL);
+	assert(data != NULL);
+
+	if(_result_cache_read(&ptr, end, &header, sizeof(ResultCacheHeader))
+	   && !memcmp(header.magic, RESULT_CACHE_MAGIC, sizeof(header.magic))
+	   && header.version == RESULT_CACHE_VERSION
+	   && header.key_len == strlen(cache->key)
+	   && (size_t)(end - ptr) >= header.key_len
+	   && !memcmp(ptr, cache->key, header.key_len))
+	{
+		ptr += header.key_len;
+		success = true;
+
+		for(uint64_t i = 0; i < header.count && success; ++i)
+		{
+			success = _result_cache_parse_dir(cache, &ptr, end);
+		}
+	}
+
+	return success;
+}
+
+static void
+_result_cache_load(ResultCache *cache)
+{
+	assert(cache != NULL);
+
+	FILE *fp = fopen(cache->filename, "rb");
+
+	if(fp)
+	{
+		struct stat st;
+
+		if(!fstat(fileno(fp), &st) && st.st_size > 0)
+		{
+			char *data = utils_malloc(st.st_size);
+
+			if(fread(data, 1, st.st_size, fp) == (size_t)st.st_size
+			   && _result_cache_parse(cache, data, st.st_size))
+			{
+				DEBUGF("cache", "Loaded %zu cached director(ies).", cache->old.count);
+			}
+			else
+			{
+				WARNINGF("cache", "Ignoring invalid result cache: %s", cache->filename);
+				_result_cache_table_clear(&cache->old);
+			}
+
+			free(data);
+		}
+
+		fclose(fp);
+	}
+	else
+	{
+		DEBUGF("cache", "No cached results found: %s", cache->filename);
+	}
+}
+
+ResultCache *
+result_cache_open(const char *dir, const char *key, bool follow)
+{
+	char filename[PATH_MAX];
+	char name[32];
+
+	assert(dir != NULL);
+	assert(key != NULL);
+
+	ResultCache *cache = utils_new(1, ResultCache);
+
+	snprintf(name, sizeof(name), "%016" PRIx64, _result_cache_hash(key));
+
+	if(!utils_path_join(dir, name, filename, sizeof(filename)))
+	{
+		*filename = '\0';
+	}
+
+	cache->filename = utils_strdup(filename);
+	cache->key = utils_strdup(key);
+	cache->follow = follow;
+
+	if(mkdir(dir, 0700) && errno != EEXIST)
+	{
+		WARNINGF("cache", "Couldn't create directory `%s', errno=%d.", dir, errno);
+	}
+
+	if(*filename)
+	{
+		_result_cache_load(cache);
+	}
+
+	return cache;
+}
+
+void
+result_cache_destroy(ResultCache *cache)
+{
+	if(cache)
+	{
+		_result_cache_table_clear(&cache->old);
+		_result_cache_table_clear(&cache->dirs);
+		free(cache->filename);
+		free(cache->key);
+		free(cache);
+	}
+}
+
+static ResultCacheDir *
+_result_cache_get_dir(ResultCache *cache, const char *path)
+{
+	char key[PATH_MAX];
+	ResultCacheDir *dir = NULL;
+
+	if(_result_cache_normalize(path, key))
+	{
+		dir = _result_cache_table_lookup(&cache->dirs, key);
+
+		if(!dir)
+		{
+			dir = _result_cache_dir_new(key);
+			_result_cache_table_insert(&cache->dirs, dir);
+		}
+	}
+
+	return dir;
+}
+
+void
+result_cache_add_dir(ResultCache *cache, const char *path)
+{
+	char parent[PATH_MAX];
+
+	assert(cache != NULL);
+	assert(path != NULL);
+
+	const char *name = _result_cache_split(path, parent);
+
+	if(name)
+	{
+		ResultCacheDir *dir = _result_cache_table_lookup(&cache->dirs, parent);
+
+		if(dir)
+		{
+			_result_cache_dir_append(dir, name, DT_DIR);
+		}
+	}
+
+	_result_cache_get_dir(cache, path);
+}
+
+void
+result_cache_add_match(ResultCache *cache, const char *path)
+{
+	char parent[PATH_MAX];
+	char key[PATH_MAX];
+
+	assert(cache != NULL);
+	assert(path != NULL);
+
+	const char *name = _result_cache_split(path, parent);
+
+	if(name && _result_cache_normalize(path, key) && !_result_cache_table_lookup(&cache->dirs, key))
+	{
+		ResultCacheDir *dir = _result_cache_table_lookup(&cache->dirs, parent);
+
+		if(dir)
+		{
+			/* the walker doesn't read the status of listed regular files */
+			_result_cache_dir_append(dir, name, DT_REG);
+		}
+	}
+}
+
+bool
+result_cache_list(ResultCache *cache, const char *path, WalkListing *listing)
+{
+	struct stat st;
+	bool cached = false;
+
+	assert(cache != NULL);
+	assert(path != NULL);
+	assert(listing != NULL);
+
+	ResultCacheDir *dir = _result_cache_get_dir(cache, path);
+
+	if(dir && !(cache->follow ? stat(path, &st) : lstat(path, &st)))
+	{
+		char key[PATH_MAX];
+
+		_result_cache_status_from_stat(&dir->status, &st);
+		dir->listed = true;
+
+		_result_cache_normalize(path, key);
+
+		ResultCacheDir *old = _result_cache_table_lookup(&cache->old, key);
+
+		if(old && !memcmp(&old->status, &dir->status, sizeof(ResultCacheStatus)))
+		{
+			for(size_t i = 0; i < old->count; ++i)
+			{
+				walk_listing_append(listing, old->entries[i].name, old->entries[i].type);
+			}
+
+			dir->cached = true;
+			cached = true;
+		}
+	}
+
+	TRACEF("cache", "Directory `%s' changed: %d", path, !cached);
+
+	return cached;
+}
+
+bool
+result_cache_is_cached(ResultCache *cache, const char *path)
+{
+	char parent[PATH_MAX];
+	bool cached = false;
+
+	assert(cache != NULL);
+	assert(path != NULL);
+
+	if(_result_cache_split(path, parent))
+	{
+		ResultCacheDir *dir = _result_cache_table_lookup(&cache->dirs, parent);
+
+		cached = dir && dir->cached;
+	}
+
+	return cached;
+}
+
+void
+result_cache_fail(ResultCache *cache, const char *path)
+{
+	char parent[PATH_MAX];
+	char key[PATH_MAX];
+
+	assert(cache != NULL);
+	assert(path != NULL);
+
+	if(_result_cache_normalize(path, key))
+	{
+		ResultCacheDir *dir = _result_cache_table_lookup(&cache->dirs, key);
+
+		if(dir)
+		{
+			dir->failed = true;
+		}
+	}
+
+	if(_result_cache_split(path, parent))
+	{
+		ResultCacheDir *dir = _result_cache_table_lookup(&cache->dirs, parent);
+
+		if(dir)
+		{
+			dir->failed = true;
+		}
+	}
+}
+
+static bool
+_result_cache_write_dir(FILE *fp, const ResultCacheDir *dir)
+{
+	ResultCacheDirHeader header;
+	bool success;
+
+	memset(&header, 0, sizeof(ResultCacheDirHeader));
+
+	header.status = dir->status;
+	header.path_len = strlen(dir->path);
+	header.count = dir->count;
+
+	success = fwrite(&header, sizeof(ResultCacheDirHeader), 1, fp) == 1
+	          && fwrite(dir->path, header.path_len, 1, fp) == 1;
+
+	for(size_t i = 0; i < dir->count && success; ++i)
+	{
+		uint8_t type = dir->entries[i].type;
+		uint16_t len = strlen(dir->entries[i].name);
+
+		success = fwrite(&type, sizeof(uint8_t), 1, fp) == 1
+		          && fwrite(&len, sizeof(uint16_t), 1, fp) == 1
+		          && fwrite(dir->entries[i].name, len, 1, fp) == 1;
+	}
+
+	return success;
+}
+
+static bool
+_result_cache_write(ResultCache *cache, FILE *fp)
+{
+	ResultCacheHeader header;
+	bool success;
+
+	memset(&header, 0, sizeof(ResultCacheHeader));
+	memcpy(header.magic, RESULT_CACHE_MAGIC, sizeof(header.magic));
+	header.version = RESULT_CACHE_VERSION;
+	header.key_len = strlen(cache->key);
+
+	for(size_t i = 0; i < cache->dirs.count; ++i)
+	{
+		if(cache->dirs.dirs[i]->listed && !cache->dirs.dirs[i]->failed)
+		{
+			++header.count;
+		}
+	}
+
+	success = fwrite(&header, sizeof(ResultCacheHeader), 1, fp) == 1
+	          && fwrite(cache->key, header.key_len, 1, fp) == 1;
+
+	for(size_t i = 0; i < cache->dirs.count && success; ++i)
+	{
+		const ResultCacheDir *dir = cache->dirs.dirs[i];
+
+		if(dir->listed && !dir->failed)
+		{
+			success = _result_cache_write_dir(fp, dir);
+		}
+	}
+
+	return success;
+}
+
+bool
+result_cache_save(ResultCache *cache)
+{
+	char tmp[PATH_MAX];
+	bool success = false;
+
+	assert(cache != NULL);
+
+	if(*cache->filename && snprintf(tmp, sizeof(tmp), "%s.tmp", cache->filename) < (int)sizeof(tmp))
+	{
+		DEBUGF("cache", "Writing result cache: %s", cache->filename);
+
+		FILE *fp = fopen(tmp, "wb");
+
+		if(fp)
+		{
+			success = _result_cache_write(cache, fp);
+			success = !fclose(fp) && success;
+
+			if(success && rename(tmp, cache->filename))
+			{
+				success = false;
+			}
+
+			if(!success)
+			{
+				unlink(tmp);
+			}
+		}
+
+		if(!success)
+		{
+			fprintf(stderr, _("Couldn't write result cache: %s\n"), cache->filename);
+		}
+	}
+
+	return success;
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file result-cache.h
+   @brief Cache search results of unchanged directories.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stdbool.h>
+
+#include "walk.h"
+
+/**
+   @struct ResultCache
+   @brief Matching files of a search grouped by directory. Each directory is
+          stored with its device, inode, modification and status change time.
+ */
+typedef struct _ResultCache ResultCache;
+
+/**
+   @param dir directory to store cache files in
+   @param key string identifying the search (expression, starting point, options)
+   @param follow true if symbolic links are dereferenced
+   @return a new ResultCache
+
+   Loads the results of a previous search with the same key. The cache is
+   empty if no valid cache file is found.
+ */
+ResultCache *result_cache_open(const char *dir, const char *key, bool follow);
+
+/**
+   @param cache ResultCache to free
+
+   Frees a ResultCache without saving it.
+ */
+void result_cache_destroy(ResultCache *cache);
+
+/**
+   @param cache a ResultCache
+   @param path a directory found by the walker
+
+   Adds a directory to the entries of its parent directory.
+ */
+void result_cache_add_dir(ResultCache *cache, const char *path);
+
+/**
+   @param cache a ResultCache
+   @param path a matching file
+
+   Adds a matching file to the entries of its parent directory. Directories
+   are ignored, they are always evaluated.
+ */
+void result_cache_add_match(ResultCache *cache, const char *path);
+
+/**
+   @param cache a ResultCache
+   @param path path of a directory to read
+   @param listing listing to append cached entries to
+   @return true if the directory hasn't changed
+
+   Reads the status of a directory. If it hasn't changed since the previous
+   search its subdirectories and matching files are appended to the listing.
+ */
+bool result_cache_list(ResultCache *cache, const char *path, WalkListing *listing);
+
+/**
+   @param cache a ResultCache
+   @param path a file found by the walker
+   @return true if the file is a cached match
+
+   Tests if a file has been listed from the cache, i.e. it matched the
+   expression in the previous search.
+ */
+bool result_cache_is_cached(ResultCache *cache, const char *path);
+
+/**
+   @param cache a ResultCache
+   @param path a file which couldn't be accessed
+
+   Excludes the file's directory from the cache.
+ */
+void result_cache_fail(ResultCache *cache, const char *path);
+
+/**
+   @param cache a ResultCache
+   @return true on success
+
+   Writes the directories read by the current search to the cache file.
+ */
+bool result_cache_save(ResultCache *cache);
+
+#endif
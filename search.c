@@ -28,11 +28,14 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/time.h>
+#include <sys/prctl.h>
+#include <time.h>
 #include <signal.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <assert.h>
 #include <datatypes.h>
 
@@ -41,15 +44,35 @@
 #include "parser.h"
 #include "utils.h"
 #include "eval.h"
+#include "eval-pool.h"
+#include "optimize.h"
+#include "planner.h"
+#include "predicate.h"
+#include "walk.h"
+#include "index.h"
+#include "result-cache.h"
 #include "gettext.h"
+#include "linux.h"
 
 /*! @cond INTERNAL */
-typedef EvalResult (*Filter)(const char *filename, void *user_data);
 
 typedef struct
 {
 	ParserResult *result;
 	ExtensionManager *extensions;
+	bool owns_extensions;
+	EvalPlan *plan;
+	EvalPool *pool;
+	FoundFileCallback found_file;
+	void *user_data;
+	bool aborted;
+	bool stopped;
+	ResultCache *cache;
+	RateLimit *rate_limit;
+	bool calls_functions;
+	int64_t deadline;
+	int output_fd;
+	uint32_t output_checks;
 } FilterArgs;
 
 typedef struct
@@ -57,28 +80,54 @@ typedef struct
 	pid_t child_pid;
 	int outfd;
 	int errfd;
+	const char *const *paths;
+	size_t count;
 	FilterArgs filter_args;
-	Callback found_file;
+	FoundFileCallback found_file;
 	Callback err_message;
 	void *user_data;
 } ParentCtx;
 
+typedef struct
+{
+	char *data;
+	size_t len;
+	size_t size;
+} RecordBuffer;
+
 typedef struct
 {
 	Buffer *buffer;
 	char *line;
 	int32_t count;
 	size_t llen;
-	bool filter;
+	const char *const *paths;
+	size_t npaths;
+	const char *cli;
 	FilterArgs *filter_args;
+	FoundFileCallback found_file;
 	Callback cb;
 	void *user_data;
 } ReaderArgs;
 
+typedef struct
+{
+	const char *path;
+	FilterArgs *filter_args;
+	EvalPlan *prune_plan;
+	Callback err_message;
+	int32_t count;
+	int status;
+} WalkerArgs;
+
 const int PROCESS_STATUS_OK       = 0;
 const int PROCESS_STATUS_ERROR    = 1;
 const int PROCESS_STATUS_FINISHED = 2;
 const int PROCESS_STATUS_STOP     = 3;
+const int PROCESS_STATUS_TIMEOUT  = 4;
+
+/*! The output pipe is tested after the given number of files. */
+#define SEARCH_OUTPUT_CHECK_INTERVAL 64
 /*! @endcond */
 
 void
@@ -90,14 +139,36 @@ search_options_free(SearchOptions *opts)
 	{
 		free(opts->regex_type);
 	}
+
+	if(opts->cache_file)
+	{
+		free(opts->cache_file);
+	}
+
+	if(opts->skip_fs_types)
+	{
+		free(opts->skip_fs_types);
+	}
+
+	if(opts->index_file)
+	{
+		free(opts->index_file);
+	}
+
+	if(opts->result_cache)
+	{
+		free(opts->result_cache);
+	}
+
+	rate_limit_destroy(opts->rate_limit);
 }
 
 static void
-_search_merge_options(size_t *argc, char ***argv, const char *path, const SearchOptions *opts)
+_search_merge_options(size_t *argc, char ***argv, const char *const *paths, size_t count, const SearchOptions *opts, bool tag_roots)
 {
 	assert(argc != NULL);
 	assert(argv != NULL);
-	assert(path != NULL);
+	assert(paths != NULL);
 	assert(opts != NULL);
 
 	char **nargv;
@@ -105,7 +176,7 @@ _search_merge_options(size_t *argc, char ***argv, const char *path, const Search
 	size_t index = 0;
 
 	/* initialize argument vector */
-	maxsize = (*argc) + 8; /* "find" + path + *argv + options + NULL */
+	maxsize = (*argc) + count + 12; /* "find" + paths + *argv + parentheses + options + NULL */
 
 	nargv = utils_new(maxsize, char *);
 
@@ -118,8 +189,11 @@ _search_merge_options(size_t *argc, char ***argv, const char *path, const Search
 		nargv[index++] = utils_strdup("-L");
 	}
 
-	/* copy search path */
-	nargv[index++] = utils_strdup(path);
+	/* copy search paths */
+	for(size_t i = 0; i < count; i++)
+	{
+		nargv[index++] = utils_strdup(paths[i]);
+	}
 
 	/* regex type */
 	if(opts && opts->regex_type)
@@ -128,12 +202,28 @@ _search_merge_options(size_t *argc, char ***argv, const char *path, const Search
 		nargv[index++] = utils_strdup(opts->regex_type);
 	}
 
+	/* don't descend directories on other filesystems */
+	if(opts && opts->one_file_system)
+	{
+		nargv[index++] = utils_strdup("-xdev");
+	}
+
 	/* copy translated find arguments */
+	if(tag_roots && *argc)
+	{
+		nargv[index++] = utils_strdup("(");
+	}
+
 	for(size_t i = 0; i < *argc; i++)
 	{
 		nargv[index++] = (*argv)[i];
 	}
 
+	if(tag_roots && *argc)
+	{
+		nargv[index++] = utils_strdup(")");
+	}
+
 	/* maximum search depth */
 	if(opts && opts->max_depth >= 0)
 	{
@@ -145,16 +235,64 @@ _search_merge_options(size_t *argc, char ***argv, const char *path, const Search
 		nargv[index++] = utils_strdup(buffer);
 	}
 
+	/* print each file preceded by its starting point, NUL can't be part of a path */
+	if(tag_roots)
+	{
+		nargv[index++] = utils_strdup("-printf");
+		nargv[index++] = utils_strdup("%H\\0%p\\0");
+	}
+
 	*argc = index;
 
 	free(*argv);
 	*argv = nargv;
 }
 
+static bool
+_search_in_process(const RootNode *root, const SearchOptions *opts)
+{
+	assert(root != NULL);
+	assert(opts != NULL);
+
+	/* find's own I/O can't be limited */
+	return opts->index_file || opts->result_cache || opts->respect_ignore_files || opts->rate_limit || planner_requires_walker(root);
+}
+
+static void
+_search_prune_fs_types(ParserResult *result, const char *fs_types)
+{
+	assert(result != NULL);
+	assert(fs_types != NULL);
+
+	char *types = utils_strdup(fs_types);
+	char *rest = types;
+	char *fs;
+
+	while((fs = strtok_r(rest, ",", &rest)))
+	{
+		char *value = utils_strdup(fs);
+
+		slist_append(&result->data.strings, value);
+
+		Node *node = ast_value_node_new_str_nodup(result->data.pool, &result->root->padding.loc, value);
+
+		node = ast_cond_node_new(result->data.pool, &node->loc, PROP_FILESYSTEM, CMP_EQ, (ValueNode *)node);
+
+		if(result->root->prune_exprs)
+		{
+			node = ast_expr_node_new(result->data.pool, &node->loc, result->root->prune_exprs, OP_OR, node);
+		}
+
+		result->root->prune_exprs = node;
+	}
+
+	free(types);
+}
+
 static ParserResult *
-_search_translate_expr(const char *path, const char *expr, TranslationFlags flags, const SearchOptions *opts, size_t *argc, char ***argv)
+_search_translate_expr(const char *const *paths, size_t count, const char *expr, TranslationFlags flags, const SearchOptions *opts, bool tag_roots, size_t *argc, char ***argv)
 {
-	assert(path != NULL);
+	assert(paths != NULL);
 	assert(expr != NULL);
 	assert(opts != NULL);
 	assert(argc != NULL);
@@ -169,9 +307,39 @@ _search_translate_expr(const char *path, const char *expr, TranslationFlags flag
 	{
 		char *err = NULL;
 
-		if(translate(result->root->exprs, flags, argc, argv, &err))
+		if(planner_plan(result->data.pool, result->root, &err))
 		{
-			_search_merge_options(argc, argv, path, opts);
+			bool in_process = _search_in_process(result->root, opts);
+
+			if(in_process)
+			{
+				planner_evaluate_in_process(result->data.pool, result->root);
+			}
+			else if(opts->skip_fs_types)
+			{
+				_search_prune_fs_types(result, opts->skip_fs_types);
+			}
+
+			Node *exprs = optimize(result->data.pool, result->root->exprs);
+
+			if(result->root->prune_exprs && !in_process)
+			{
+				Node *prune = ast_prune_node_new(result->data.pool,
+				                                 &result->root->prune_exprs->loc,
+				                                 optimize(result->data.pool, result->root->prune_exprs));
+
+				exprs = exprs ? ast_expr_node_new(result->data.pool, &prune->loc, prune, OP_AND, exprs) : prune;
+			}
+
+			if(translate(exprs, flags, argc, argv, &err))
+			{
+				_search_merge_options(argc, argv, paths, count, opts, tag_roots && !in_process);
+			}
+			else
+			{
+				result->success = false;
+				result->err = err;
+			}
 		}
 		else
 		{
@@ -195,6 +363,41 @@ _search_translate_expr(const char *path, const char *expr, TranslationFlags flag
 	return result;
 }
 
+static Predicates *
+_search_compile_predicates(ParserResult *result, const SearchOptions *opts)
+{
+	Predicates *predicates = NULL;
+
+	assert(result != NULL);
+	assert(opts != NULL);
+
+	if(result->success)
+	{
+		Node *exprs = result->root->filter_exprs;
+
+		if(result->root->prune_exprs && _search_in_process(result->root, opts))
+		{
+			exprs = exprs ? ast_expr_node_new(result->data.pool, &exprs->loc, result->root->prune_exprs, OP_OR, exprs) : result->root->prune_exprs;
+		}
+
+		if(exprs)
+		{
+			char *err = NULL;
+
+			/* indexed file status has already been read with respect to symbolic links */
+			predicates = predicates_new(exprs, opts->follow && !opts->index_file, opts->regex_type, &err);
+
+			if(!predicates)
+			{
+				result->success = false;
+				result->err = err;
+			}
+		}
+	}
+
+	return predicates;
+}
+
 static void
 _search_child_process(char **argv)
 {
@@ -216,23 +419,71 @@ _search_child_process(char **argv)
 	}
 }
 
+static int64_t
+_search_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static bool
+_search_deadline_passed(const FilterArgs *args)
+{
+	assert(args != NULL);
+
+	return args->deadline && _search_now() >= args->deadline;
+}
+
+static bool
+_search_output_closed(FilterArgs *args)
+{
+	assert(args != NULL);
+
+	return args->output_fd >= 0
+	       && !(++args->output_checks % SEARCH_OUTPUT_CHECK_INTERVAL)
+	       && linux_pipe_is_broken(args->output_fd);
+}
+
+static int
+_search_test_stop(FilterArgs *args)
+{
+	int status = PROCESS_STATUS_OK;
+
+	assert(args != NULL);
+
+	if(_search_deadline_passed(args))
+	{
+		DEBUG("search", "Deadline reached, stopping search.");
+		status = PROCESS_STATUS_TIMEOUT;
+	}
+	else if(_search_output_closed(args))
+	{
+		DEBUG("search", "Output has been closed, stopping search.");
+		args->stopped = true;
+		status = PROCESS_STATUS_STOP;
+	}
+
+	return status;
+}
+
 static EvalResult
-_search_filter(const char *filename, void *user_data)
+_search_filter(FileInfo *info, FilterArgs *args)
 {
 	EvalResult result = EVAL_RESULT_TRUE;
 
-	assert(filename != NULL);
-	assert(user_data != NULL);
-
-	FilterArgs *args = (FilterArgs *)user_data;
+	assert(info != NULL);
+	assert(args != NULL);
 
 	if(args->result->root->filter_exprs)
 	{
-		TRACEF("search", "Filtering file: %s", filename);
+		TRACEF("search", "Filtering file: %s", info->path);
 
 		if(args->extensions)
 		{
-			result = evaluate(args->extensions, args->result->root->filter_exprs, filename);
+			result = eval_plan_evaluate(args->plan, args->extensions, info);
 
 			if(result == EVAL_RESULT_ABORTED)
 			{
@@ -249,21 +500,53 @@ _search_filter(const char *filename, void *user_data)
 	return result;
 }
 
+static bool
+_search_found_file(FileInfo *info, FilterArgs *args)
+{
+	assert(info != NULL);
+	assert(args != NULL);
+
+	if(args->cache)
+	{
+		result_cache_add_match(args->cache, info->path);
+	}
+
+	if(args->found_file && args->found_file(info, args->user_data))
+	{
+		args->stopped = true;
+	}
+
+	return args->stopped;
+}
+
 static int
-_search_process_line(ReaderArgs *args)
+_search_process_file_info(FileInfo *info, FilterArgs *args)
 {
 	int status = PROCESS_STATUS_OK;
 
+	assert(info != NULL);
 	assert(args != NULL);
-	assert(args->line != NULL);
 
-	if(args->filter)
+	/* filter functions may read the file's content */
+	if(args->calls_functions && !rate_limit_acquire(args->rate_limit, 1))
+	{
+		DEBUG("search", "Deadline reached, stopping search.");
+		status = PROCESS_STATUS_TIMEOUT;
+	}
+	else if(args->pool)
+	{
+		if(!eval_pool_submit(args->pool, info))
+		{
+			status = args->aborted ? PROCESS_STATUS_ERROR : PROCESS_STATUS_STOP;
+		}
+	}
+	else
 	{
-		EvalResult result = _search_filter(args->line, args->filter_args);
+		EvalResult result = _search_filter(info, args);
 
-		if(result == EVAL_RESULT_TRUE && args->cb)
+		if(result == EVAL_RESULT_TRUE)
 		{
-			if(args->cb(args->line, args->user_data))
+			if(_search_found_file(info, args))
 			{
 				status = PROCESS_STATUS_STOP;
 			}
@@ -273,7 +556,78 @@ _search_process_line(ReaderArgs *args)
 			status = PROCESS_STATUS_ERROR;
 		}
 	}
-	else if(args->cb)
+
+	return status;
+}
+
+static const char *
+_search_find_root(const ReaderArgs *args, const char *root)
+{
+	const char *cli = NULL;
+
+	assert(args != NULL);
+	assert(root != NULL);
+
+	for(size_t i = 0; i < args->npaths && !cli; i++)
+	{
+		if(!strcmp(args->paths[i], root))
+		{
+			cli = args->paths[i];
+		}
+	}
+
+	if(!cli)
+	{
+		WARNINGF("search", "Unknown starting point: %s", root);
+		cli = args->paths[0];
+	}
+
+	return cli;
+}
+
+static int
+_search_process_found_file(ReaderArgs *args)
+{
+	int status = PROCESS_STATUS_OK;
+
+	assert(args != NULL);
+	assert(args->line != NULL);
+
+	/* find prints the starting point of each file in the preceding record */
+	if(!args->cli)
+	{
+		args->cli = _search_find_root(args, args->line);
+	}
+	else
+	{
+		status = _search_test_stop(args->filter_args);
+
+		if(status == PROCESS_STATUS_OK)
+		{
+			FileInfo *info = file_info_new(args->cli, false, args->line);
+
+			if(info)
+			{
+				status = _search_process_file_info(info, args->filter_args);
+				file_info_unref(info);
+			}
+		}
+
+		args->cli = NULL;
+	}
+
+	return status;
+}
+
+static int
+_search_process_line(ReaderArgs *args)
+{
+	int status = PROCESS_STATUS_OK;
+
+	assert(args != NULL);
+	assert(args->line != NULL);
+
+	if(args->cb)
 	{
 		if(args->cb(args->line, args->user_data))
 		{
@@ -284,6 +638,72 @@ _search_process_line(ReaderArgs *args)
 	return status;
 }
 
+static void
+_search_record_buffer_init(RecordBuffer *buf)
+{
+	assert(buf != NULL);
+
+	buf->size = 4096;
+	buf->data = utils_new(buf->size, char);
+	buf->len = 0;
+}
+
+static ssize_t
+_search_record_buffer_fill(RecordBuffer *buf, int fd)
+{
+	assert(buf != NULL);
+
+	/* a record doesn't fit into the buffer */
+	if(buf->len == buf->size)
+	{
+		buf->size *= 2;
+		buf->data = utils_renew(buf->data, buf->size, char);
+	}
+
+	ssize_t bytes = read(fd, buf->data + buf->len, buf->size - buf->len);
+
+	if(bytes > 0)
+	{
+		buf->len += bytes;
+	}
+
+	return bytes;
+}
+
+static int
+_search_process_records(ReaderArgs *args, RecordBuffer *buf)
+{
+	int status = PROCESS_STATUS_OK;
+	size_t offset = 0;
+	const char *end;
+
+	assert(args != NULL);
+	assert(buf != NULL);
+
+	args->count = 0;
+
+	while(status == PROCESS_STATUS_OK && (end = memchr(buf->data + offset, '\0', buf->len - offset)))
+	{
+		utils_copy_string(buf->data + offset, &args->line);
+		offset = end - buf->data + 1;
+
+		status = _search_process_found_file(args);
+
+		if(status == PROCESS_STATUS_OK && !args->cli)
+		{
+			if(args->count < INT32_MAX)
+			{
+				++args->count;
+			}
+		}
+	}
+
+	memmove(buf->data, buf->data + offset, buf->len - offset);
+	buf->len -= offset;
+
+	return status;
+}
+
 static int
 _search_process_lines_from_buffer(ReaderArgs *args)
 {
@@ -298,7 +718,7 @@ _search_process_lines_from_buffer(ReaderArgs *args)
 	{
 		status = _search_process_line(args);
 
-		if(status == PROCESS_STATUS_OK)
+		if(status == PROCESS_STATUS_OK && !args->cli)
 		{
 			if(args->count < INT32_MAX)
 			{
@@ -320,13 +740,13 @@ _search_flush_and_process_buffer(ReaderArgs *args)
 
 	args->count = 0;
 
-	if(args->cb && !buffer_is_empty(args->buffer))
+	if((args->cb || args->found_file) && !buffer_is_empty(args->buffer))
 	{
 		status = _search_process_lines_from_buffer(args);
 
 		if(status == PROCESS_STATUS_OK && buffer_flush(args->buffer, &args->line, &args->llen))
 		{
-			if(_search_process_line(args) == PROCESS_STATUS_OK)
+			if(_search_process_line(args) == PROCESS_STATUS_OK && !args->cli)
 			{
 				if(args->count < INT32_MAX)
 				{
@@ -394,12 +814,16 @@ _search_kill_child(pid_t pid)
 }
 
 static void
-_search_reader_args_init(ReaderArgs *args, FilterArgs *filter_args, void *user_data)
+_search_reader_args_init(ReaderArgs *args, const char *const *paths, size_t count, FilterArgs *filter_args, FoundFileCallback found_file, void *user_data)
 {
 	assert(args != NULL);
+	assert(paths != NULL);
 
 	memset(args, 0, sizeof(ReaderArgs));
+	args->paths = paths;
+	args->npaths = count;
 	args->filter_args = filter_args;
+	args->found_file = found_file;
 	args->user_data = user_data;
 }
 
@@ -423,7 +847,7 @@ _search_parent_process(ParentCtx *ctx)
 	assert(ctx->errfd > 0);
 
 	fd_set rfds;
-	Buffer outbuf;
+	RecordBuffer outbuf;
 	Buffer errbuf;
 	ReaderArgs reader_args;
 	int lc = 0;
@@ -431,21 +855,24 @@ _search_parent_process(ParentCtx *ctx)
 
 	DEBUG("search", "Initializing parent process.");
 
-	buffer_init(&outbuf, 4096);
+	_search_record_buffer_init(&outbuf);
 	buffer_init(&errbuf, 4096);
 
-	_search_reader_args_init(&reader_args, &ctx->filter_args, ctx->user_data);
+	_search_reader_args_init(&reader_args, ctx->paths, ctx->count, &ctx->filter_args, ctx->found_file, ctx->user_data);
 
 	DEBUGF("search", "Reading data from child process (pid=%ld).", ctx->child_pid);
 
 	int maxfd = (ctx->errfd > ctx->outfd ? ctx->errfd : ctx->outfd) + 1;
+	int output_fd = ctx->filter_args.output_fd;
 
-	while(status == PROCESS_STATUS_OK)
+	/* a pipe's write end becomes readable when its read end has been closed */
+	if(output_fd >= maxfd)
 	{
-		FD_ZERO(&rfds);
-		FD_SET(ctx->outfd, &rfds);
-		FD_SET(ctx->errfd, &rfds);
+		maxfd = output_fd + 1;
+	}
 
+	while(status == PROCESS_STATUS_OK)
+	{
 		ssize_t bytes;
 		ssize_t sum = 0;
 
@@ -453,19 +880,61 @@ _search_parent_process(ParentCtx *ctx)
 		{
 			sum = 0;
 
-			if(select(maxfd, &rfds, NULL, NULL, NULL) > 0)
+			struct timeval timeout;
+			int ready = 0;
+
+			/* select() overwrites the set, rebuild it before each call */
+			FD_ZERO(&rfds);
+			FD_SET(ctx->outfd, &rfds);
+			FD_SET(ctx->errfd, &rfds);
+
+			if(output_fd >= 0)
 			{
-				if(FD_ISSET(ctx->outfd, &rfds))
-				{
-					reader_args.buffer = &outbuf;
-					reader_args.cb = ctx->found_file;
-					reader_args.filter = true;
+				FD_SET(output_fd, &rfds);
+			}
 
-					while(status == PROCESS_STATUS_OK && (bytes = buffer_fill_from_fd(&outbuf, ctx->outfd, 512)) > 0)
-					{
-						status = _search_process_lines_from_buffer(&reader_args);
+			if(ctx->filter_args.deadline)
+			{
+				int64_t left = ctx->filter_args.deadline - _search_now();
 
-						TRACEF("search", "Received %ld byte(s) from stdout, read %d line(s) from stdout buffer.", bytes, reader_args.count);
+				timeout.tv_sec = left > 0 ? left / 1000 : 0;
+				timeout.tv_usec = left > 0 ? (left % 1000) * 1000 : 0;
+			}
+
+			if(!_search_deadline_passed(&ctx->filter_args))
+			{
+				ready = select(maxfd, &rfds, NULL, NULL, ctx->filter_args.deadline ? &timeout : NULL);
+			}
+
+			if(!ready)
+			{
+				DEBUG("search", "Deadline reached, stopping search.");
+				status = PROCESS_STATUS_TIMEOUT;
+			}
+			else if(ready > 0)
+			{
+				if(output_fd >= 0 && FD_ISSET(output_fd, &rfds))
+				{
+					if(linux_pipe_is_broken(output_fd))
+					{
+						DEBUG("search", "Output has been closed, stopping search.");
+						ctx->filter_args.stopped = true;
+						status = PROCESS_STATUS_STOP;
+					}
+					else
+					{
+						/* readable for another reason, don't poll it in a busy loop */
+						output_fd = -1;
+					}
+				}
+
+				if(FD_ISSET(ctx->outfd, &rfds))
+				{
+					while(status == PROCESS_STATUS_OK && (bytes = _search_record_buffer_fill(&outbuf, ctx->outfd)) > 0)
+					{
+						status = _search_process_records(&reader_args, &outbuf);
+
+						TRACEF("search", "Received %ld byte(s) from stdout, read %d file(s) from stdout buffer.", bytes, reader_args.count);
 
 						if(status == PROCESS_STATUS_OK)
 						{
@@ -490,7 +959,6 @@ _search_parent_process(ParentCtx *ctx)
 				{
 					reader_args.buffer = &errbuf;
 					reader_args.cb = ctx->err_message;
-					reader_args.filter = false;
 
 					while(status == PROCESS_STATUS_OK && (bytes = buffer_fill_from_fd(&errbuf, ctx->errfd, 512)) > 0)
 					{
@@ -507,7 +975,7 @@ _search_parent_process(ParentCtx *ctx)
 			}
 		} while(status == PROCESS_STATUS_OK && sum);
 
-		if(status == PROCESS_STATUS_STOP || status == PROCESS_STATUS_ERROR)
+		if(status == PROCESS_STATUS_STOP || status == PROCESS_STATUS_ERROR || status == PROCESS_STATUS_TIMEOUT)
 		{
 			_search_kill_child(ctx->child_pid);
 		}
@@ -521,27 +989,14 @@ _search_parent_process(ParentCtx *ctx)
 	{
 		TRACE("search", "Flushing all buffers.");
 
-		reader_args.buffer = &outbuf;
-		reader_args.cb = ctx->found_file;
-		reader_args.filter = true;
-
-		if(_search_flush_and_process_buffer(&reader_args) == PROCESS_STATUS_OK)
+		/* find terminates each record, so only an incomplete record can be left */
+		if(outbuf.len)
 		{
-			if(INT32_MAX - reader_args.count >= lc)
-			{
-				lc += reader_args.count;
-			}
-			else
-			{
-				ERROR("search", "Integer overflow.");
-			}
-
-			TRACEF("search", "Flushed stdout, lc=%d.", lc);
+			WARNINGF("search", "Discarding %zu byte(s) of an incomplete record.", outbuf.len);
 		}
 
 		reader_args.buffer = &errbuf;
 		reader_args.cb = ctx->err_message;
-		reader_args.filter = false;
 
 		_search_flush_and_process_buffer(&reader_args);
 	}
@@ -550,11 +1005,27 @@ _search_parent_process(ParentCtx *ctx)
 		lc = -1;
 	}
 
+	/* files submitted before the deadline are still evaluated */
+	if(ctx->filter_args.pool && (status == PROCESS_STATUS_OK || status == PROCESS_STATUS_FINISHED || status == PROCESS_STATUS_TIMEOUT))
+	{
+		TRACE("search", "Waiting for pending evaluations.");
+
+		if(!eval_pool_flush(ctx->filter_args.pool) && ctx->filter_args.aborted)
+		{
+			lc = -1;
+		}
+	}
+
+	if(status == PROCESS_STATUS_TIMEOUT && lc >= 0)
+	{
+		lc = SEARCH_TIMED_OUT;
+	}
+
 	TRACE("search", "Cleaning up parent process.");
 
 	_search_reader_args_free(&reader_args);
 
-	buffer_free(&outbuf);
+	free(outbuf.data);
 	buffer_free(&errbuf);
 
 	return lc;
@@ -589,6 +1060,43 @@ _search_close_parent_fds(int outfds[2], int errfds[2])
 	return _search_close_fd(&outfds[1]) | _search_close_fd(&errfds[1]);
 }
 
+/* find mustn't outlive the process reading its output, e.g. a child of the
+   device scheduler terminated by its parent */
+static bool
+_search_bind_child_to_parent(pid_t parent)
+{
+	bool success = false;
+
+	if(prctl(PR_SET_PDEATHSIG, SIGTERM) == -1)
+	{
+		perror("prctl()");
+	}
+	else if(getppid() == parent)
+	{
+		success = true;
+	}
+
+	return success;
+}
+
+static bool
+_search_set_nonblocking(int fd)
+{
+	int flags = fcntl(fd, F_GETFL);
+	bool success = false;
+
+	if(flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1)
+	{
+		success = true;
+	}
+	else
+	{
+		perror("fcntl()");
+	}
+
+	return success;
+}
+
 static bool
 _search_close_and_dup_child_fds(int outfds[2], int errfds[2])
 {
@@ -636,16 +1144,123 @@ _search_close_all_fds(int outfds[2], int errfds[2])
 	}
 }
 
+static bool
+_search_pool_evaluated(FileInfo *info, EvalResult result, void *user_data)
+{
+	FilterArgs *args = user_data;
+	bool stop = false;
+
+	assert(info != NULL);
+	assert(args != NULL);
+
+	if(result == EVAL_RESULT_TRUE)
+	{
+		stop = _search_found_file(info, args);
+	}
+	else if(result == EVAL_RESULT_ABORTED)
+	{
+		fprintf(stderr, _("Evaluation aborted.\n"));
+		args->aborted = true;
+		stop = true;
+	}
+
+	return stop;
+}
+
+static bool
+_search_calls_functions(const Node *node)
+{
+	bool calls = false;
+
+	if(node)
+	{
+		switch(node->type)
+		{
+			case NODE_FUNC:
+				calls = true;
+				break;
+
+			case NODE_EXPRESSION:
+				calls = _search_calls_functions(((ExpressionNode *)node)->first)
+				        || _search_calls_functions(((ExpressionNode *)node)->second);
+				break;
+
+			case NODE_COMPARE:
+				calls = _search_calls_functions(((CompareNode *)node)->first)
+				        || _search_calls_functions(((CompareNode *)node)->second);
+				break;
+
+			case NODE_NOT:
+				calls = _search_calls_functions(((NotNode *)node)->expr);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return calls;
+}
+
 static void
-_search_filter_args_init(FilterArgs *args, ParserResult *parser_result)
+_search_filter_args_init(FilterArgs *args, ParserResult *parser_result, Predicates *predicates, const SearchOptions *opts, FoundFileCallback found_file, void *user_data)
 {
 	assert(args != NULL);
 	assert(parser_result != NULL);
+	assert(opts != NULL);
 
 	args->result = parser_result;
-	args->extensions = extension_manager_new();
+	args->extensions = opts->extensions;
+	args->owns_extensions = !opts->extensions;
+	args->plan = NULL;
+	args->pool = NULL;
+	args->found_file = found_file;
+	args->user_data = user_data;
+	args->aborted = false;
+	args->stopped = false;
+	args->cache = NULL;
+	args->rate_limit = opts->rate_limit;
+	args->calls_functions = _search_calls_functions(parser_result->root->filter_exprs);
+	args->deadline = opts->timeout ? _search_now() + opts->timeout : 0;
+	rate_limit_set_deadline(args->rate_limit, args->deadline);
+	args->output_fd = opts->output_fd;
+	args->output_checks = 0;
+
+	if(args->owns_extensions)
+	{
+		args->extensions = extension_manager_new();
+		extension_manager_load_default(args->extensions);
+	}
+
+	if(parser_result->root->filter_exprs)
+	{
+		args->plan = eval_plan_new(parser_result->root->filter_exprs, predicates);
+
+		if(opts->cache_file)
+		{
+			extension_manager_open_cache(args->extensions, opts->cache_file, opts->cache_size);
+		}
 
-	extension_manager_load_default(args->extensions);
+		size_t inflight = opts->inflight;
+
+		/* files evaluated concurrently read their content concurrently */
+		if(opts->max_inflight && opts->max_inflight < inflight)
+		{
+			inflight = opts->max_inflight;
+		}
+
+		if(inflight > 1)
+		{
+			if(eval_pool_supports(args->extensions, parser_result->root->filter_exprs))
+			{
+				args->pool = eval_pool_new(args->extensions, parser_result->root->filter_exprs, predicates, inflight, _search_pool_evaluated, args);
+			}
+			else
+			{
+				WARNING("search", "Expression contains functions which aren't reentrant, evaluating files sequentially.");
+			}
+		}
+	}
 }
 
 static void
@@ -653,19 +1268,28 @@ _search_filter_args_free(FilterArgs *args)
 {
 	assert(args != NULL);
 
-	if(args->extensions)
+	eval_pool_destroy(args->pool);
+
+	if(args->owns_extensions)
 	{
 		extension_manager_destroy(args->extensions);
 	}
+	else if(args->extensions)
+	{
+		extension_manager_close_cache(args->extensions);
+	}
+
+	eval_plan_destroy(args->plan);
 }
 
-int
-search_files(const char *path, const char *expr, TranslationFlags flags, const SearchOptions *opts, Callback found_file, Callback err_message, void *user_data)
+static int
+_search_run_find(const char *const *paths, size_t count, char **argv, ParserResult *result, Predicates *predicates, const SearchOptions *opts, FoundFileCallback found_file, Callback err_message, void *user_data)
 {
 	int ret = -1;
 
-	assert(path != NULL);
-	assert(expr != NULL);
+	assert(paths != NULL);
+	assert(argv != NULL);
+	assert(result != NULL);
 	assert(opts != NULL);
 
 	int outfds[2];
@@ -680,88 +1304,64 @@ search_files(const char *path, const char *expr, TranslationFlags flags, const S
 	{
 		if(pipe2(errfds, 0) >= 0)
 		{
-			char **argv = NULL;
-			size_t argc = 0;
-			ParserResult *result;
+			DEBUG("search", "Pipes created successfully, forking and running `find'.");
 
-			TRACE("search", "Pipes created successfully, translating expression.");
+			pid_t parent = getpid();
+			pid_t pid = fork();
 
-			result = _search_translate_expr(path, expr, flags, opts, &argc, &argv);
-
-			assert(result != NULL);
-
-			if(result->success)
+			if(pid == -1)
 			{
-				DEBUG("search", "Expression parsed successfully, forking and running `find'.");
-
-				pid_t pid = fork();
-
-				if(pid == -1)
+				FATALF("search", "`fork' failed with result %ld.", pid);
+				perror("fork()");
+			}
+			else if(pid == 0)
+			{
+				if(!_search_bind_child_to_parent(parent))
 				{
-					FATALF("search", "`fork' failed with result %ld.", pid);
-					perror("fork()");
+					_exit(EXIT_FAILURE);
 				}
-				else if(pid == 0)
+				else if(_search_close_and_dup_child_fds(outfds, errfds))
 				{
-					if(_search_close_and_dup_child_fds(outfds, errfds))
-					{
-						_search_child_process(argv);
-					}
-					else
-					{
-						ERROR("search", "Couldn't initialize child's file descriptors.");
-					}
+					_search_child_process(argv);
 				}
 				else
 				{
-					if(_search_close_parent_fds(outfds, errfds))
-					{
-						ParentCtx ctx;
-
-						memset(&ctx, 0, sizeof(ParentCtx));
-
-						ctx.child_pid = pid;
-						ctx.outfd = outfds[0];
-						ctx.errfd = errfds[0];
-						ctx.found_file = found_file;
-						ctx.err_message = err_message;
-						ctx.user_data = user_data;
-
-						_search_filter_args_init(&ctx.filter_args, result);
-
-						ret = _search_parent_process(&ctx);
-
-						_search_filter_args_free(&ctx.filter_args);
-					}
-					else
-					{
-						WARNING("search", "Couldn't close parent's file descriptors.");
-					}
+					ERROR("search", "Couldn't initialize child's file descriptors.");
 				}
 			}
-			else if(result->err)
-			{
-				TRACEF("search", "Couldn't parse expression: %s", result->err);
-				fprintf(stderr, "%s\n", result->err);
-			}
 			else
 			{
-				TRACE("search", "Couldn't parse expression, no error message set.");
-			}
+				/* reading must not block while find runs without writing anything,
+				   or a closed output would only be noticed when find exits */
+				if(_search_close_parent_fds(outfds, errfds)
+				   && _search_set_nonblocking(outfds[0])
+				   && _search_set_nonblocking(errfds[0]))
+				{
+					ParentCtx ctx;
 
-			DEBUGF("search", "Search finished with result %d.", ret);
+					memset(&ctx, 0, sizeof(ParentCtx));
 
-			if(argv)
-			{
-				for(size_t i = 0; i < argc; i++)
+					ctx.child_pid = pid;
+					ctx.paths = paths;
+					ctx.count = count;
+					ctx.outfd = outfds[0];
+					ctx.errfd = errfds[0];
+					ctx.found_file = found_file;
+					ctx.err_message = err_message;
+					ctx.user_data = user_data;
+
+					_search_filter_args_init(&ctx.filter_args, result, predicates, opts, found_file, user_data);
+
+					ret = _search_parent_process(&ctx);
+
+					_search_filter_args_free(&ctx.filter_args);
+				}
+				else
 				{
-					free(argv[i]);
+					WARNING("search", "Couldn't close parent's file descriptors.");
 				}
-
-				free(argv);
 			}
 
-			parser_result_free(result);
 			_search_close_all_fds(outfds, errfds);
 		}
 		else
@@ -787,6 +1387,507 @@ search_files(const char *path, const char *expr, TranslationFlags flags, const S
 	return ret;
 }
 
+static WalkAction
+_search_visit(FileInfo *info, WalkerArgs *args)
+{
+	WalkAction action = WALK_CONTINUE;
+	EvalResult result = EVAL_RESULT_FALSE;
+
+	assert(info != NULL);
+	assert(args != NULL);
+
+	if(args->prune_plan)
+	{
+		result = eval_plan_evaluate(args->prune_plan, args->filter_args->extensions, info);
+	}
+
+	if(result == EVAL_RESULT_TRUE)
+	{
+		TRACEF("search", "Pruning file: %s", info->path);
+		action = WALK_SKIP;
+	}
+	else if(result == EVAL_RESULT_ABORTED)
+	{
+		fprintf(stderr, _("Evaluation aborted.\n"));
+		args->status = PROCESS_STATUS_ERROR;
+	}
+	else
+	{
+		args->status = _search_process_file_info(info, args->filter_args);
+
+		if(args->status == PROCESS_STATUS_OK && args->count < INT32_MAX)
+		{
+			++args->count;
+		}
+	}
+
+	if(args->status != PROCESS_STATUS_OK)
+	{
+		action = WALK_STOP;
+	}
+
+	return action;
+}
+
+static WalkAction
+_search_visit_cached(FileInfo *info, WalkerArgs *args)
+{
+	WalkAction action = WALK_CONTINUE;
+
+	assert(info != NULL);
+	assert(args != NULL);
+
+	TRACEF("search", "Found cached match: %s", info->path);
+
+	if(_search_found_file(info, args->filter_args))
+	{
+		args->status = PROCESS_STATUS_STOP;
+		action = WALK_STOP;
+	}
+	else if(args->count < INT32_MAX)
+	{
+		++args->count;
+	}
+
+	return action;
+}
+
+static WalkAction
+_search_walk_visit(const WalkEntry *entry, void *user_data)
+{
+	WalkerArgs *args = user_data;
+	WalkAction action = WALK_CONTINUE;
+
+	assert(entry != NULL);
+	assert(args != NULL);
+
+	FileInfo *info = NULL;
+
+	args->status = _search_test_stop(args->filter_args);
+
+	if(args->status == PROCESS_STATUS_OK)
+	{
+		info = file_info_new(args->path, false, entry->path);
+	}
+	else
+	{
+		action = WALK_STOP;
+	}
+
+	if(info)
+	{
+		file_info_set_type(info, entry->type);
+
+		if(entry->stx)
+		{
+			file_info_set_statx(info, entry->stx);
+		}
+
+		ResultCache *cache = args->filter_args->cache;
+
+		if(cache && entry->is_dir)
+		{
+			result_cache_add_dir(cache, entry->path);
+		}
+
+		/* files listed from the cache matched in the previous search */
+		if(cache && !entry->is_dir && result_cache_is_cached(cache, entry->path))
+		{
+			action = _search_visit_cached(info, args);
+		}
+		else
+		{
+			action = _search_visit(info, args);
+		}
+
+		file_info_unref(info);
+	}
+
+	return action;
+}
+
+static bool
+_search_walk_list(const char *path, WalkListing *listing, void *user_data)
+{
+	WalkerArgs *args = user_data;
+
+	assert(path != NULL);
+	assert(args != NULL);
+
+	return result_cache_list(args->filter_args->cache, path, listing);
+}
+
+static WalkAction
+_search_index_visit(const IndexEntry *entry, void *user_data)
+{
+	WalkerArgs *args = user_data;
+	WalkAction action = WALK_CONTINUE;
+
+	assert(entry != NULL);
+	assert(args != NULL);
+
+	FileInfo *info = NULL;
+
+	args->status = _search_test_stop(args->filter_args);
+
+	if(args->status == PROCESS_STATUS_OK)
+	{
+		info = file_info_new(args->path, false, entry->path);
+	}
+	else
+	{
+		action = WALK_STOP;
+	}
+
+	if(info)
+	{
+		file_info_set_stat(info, entry->sb);
+		action = _search_visit(info, args);
+		file_info_unref(info);
+	}
+
+	return action;
+}
+
+static void
+_search_walk_error(const char *path, int errnum, void *user_data)
+{
+	WalkerArgs *args = user_data;
+
+	assert(path != NULL);
+	assert(args != NULL);
+
+	if(args->filter_args->cache)
+	{
+		result_cache_fail(args->filter_args->cache, path);
+	}
+
+	if(args->err_message)
+	{
+		char msg[PATH_MAX + 256];
+
+		snprintf(msg, sizeof(msg), _("Couldn't access `%s': %s"), path, strerror(errnum));
+		args->err_message(msg, args->filter_args->user_data);
+	}
+}
+
+static void
+_search_walker_args_init(WalkerArgs *args, FilterArgs *filter_args, const char *path, ParserResult *result, Predicates *predicates, Callback err_message)
+{
+	assert(args != NULL);
+	assert(filter_args != NULL);
+	assert(path != NULL);
+	assert(result != NULL);
+
+	memset(args, 0, sizeof(WalkerArgs));
+
+	args->path = path;
+	args->filter_args = filter_args;
+	args->prune_plan = result->root->prune_exprs ? eval_plan_new(result->root->prune_exprs, predicates) : NULL;
+	args->err_message = err_message;
+	args->status = PROCESS_STATUS_OK;
+}
+
+static int
+_search_walker_args_complete(WalkerArgs *args, bool success)
+{
+	assert(args != NULL);
+
+	int ret = -1;
+
+	/* the walker stops by itself when the rate limit would delay it beyond the deadline */
+	if(args->status == PROCESS_STATUS_OK && _search_deadline_passed(args->filter_args))
+	{
+		args->status = PROCESS_STATUS_TIMEOUT;
+	}
+
+	/* files submitted before the deadline are still evaluated */
+	if(args->filter_args->pool && (args->status == PROCESS_STATUS_OK || args->status == PROCESS_STATUS_TIMEOUT))
+	{
+		TRACE("search", "Waiting for pending evaluations.");
+
+		if(!eval_pool_flush(args->filter_args->pool) && args->filter_args->aborted)
+		{
+			args->status = PROCESS_STATUS_ERROR;
+		}
+	}
+
+	eval_plan_destroy(args->prune_plan);
+
+	if(args->status == PROCESS_STATUS_TIMEOUT)
+	{
+		ret = SEARCH_TIMED_OUT;
+	}
+	else if(success && args->status != PROCESS_STATUS_ERROR)
+	{
+		ret = args->count;
+	}
+
+	return ret;
+}
+
+static int
+_search_add_count(int count, int n)
+{
+	int ret = n;
+
+	/* failures and timeouts are passed on */
+	if(count < 0)
+	{
+		ret = count;
+	}
+	else if(n >= 0)
+	{
+		ret = (INT_MAX - n >= count) ? count + n : INT_MAX;
+	}
+
+	return ret;
+}
+
+static char *
+_search_result_cache_key(const char *path, const char *expr, const SearchOptions *opts)
+{
+	char cwd[PATH_MAX];
+
+	assert(path != NULL);
+	assert(expr != NULL);
+	assert(opts != NULL);
+
+	*cwd = '\0';
+
+	/* results of relative starting points depend on the working directory */
+	if(*path != '/' && !getcwd(cwd, sizeof(cwd)))
+	{
+		*cwd = '\0';
+	}
+
+	const char *format = "%s\n%s\n%s\n%d\n%d\n%s\n%d\n%d\n%s";
+	const char *regex_type = opts->regex_type ? opts->regex_type : "";
+	const char *skip_fs_types = opts->skip_fs_types ? opts->skip_fs_types : "";
+
+	int len = snprintf(NULL, 0, format, cwd, path, expr, opts->max_depth, opts->follow, regex_type,
+	                   opts->respect_ignore_files, opts->one_file_system, skip_fs_types);
+
+	char *key = utils_new(len + 1, char);
+
+	snprintf(key, len + 1, format, cwd, path, expr, opts->max_depth, opts->follow, regex_type,
+	         opts->respect_ignore_files, opts->one_file_system, skip_fs_types);
+
+	return key;
+}
+
+static bool
+_search_result_is_cacheable(const RootNode *root)
+{
+	assert(root != NULL);
+
+	/* cached results of unchanged directories must not depend on the time of the search */
+	return (!root->exprs || ast_is_time_invariant(root->exprs))
+	       && (!root->filter_exprs || ast_is_time_invariant(root->filter_exprs))
+	       && (!root->prune_exprs || ast_is_time_invariant(root->prune_exprs));
+}
+
+static int
+_search_walk(const char *const *paths, size_t count, const char *expr, ParserResult *result, Predicates *predicates, const SearchOptions *opts, FoundFileCallback found_file, Callback err_message, void *user_data)
+{
+	FilterArgs filter_args;
+	WalkOptions walk_opts;
+	int ret = 0;
+
+	assert(paths != NULL);
+	assert(expr != NULL);
+	assert(result != NULL);
+	assert(opts != NULL);
+
+	DEBUG("search", "Walking directory tree in-process.");
+
+	_search_filter_args_init(&filter_args, result, predicates, opts, found_file, user_data);
+
+	walk_opts.max_depth = opts->max_depth;
+	walk_opts.follow = opts->follow;
+	walk_opts.respect_ignore_files = opts->respect_ignore_files;
+	walk_opts.one_file_system = opts->one_file_system;
+	walk_opts.skip_fs_types = opts->skip_fs_types;
+	walk_opts.stat_mask = opts->stat_mask;
+	walk_opts.inode_order = opts->inode_order;
+	walk_opts.rate_limit = opts->rate_limit;
+	walk_opts.max_inflight = opts->max_inflight;
+
+	/* conditions dereferencing symbolic links read the file status themselves */
+	if(!opts->follow)
+	{
+		walk_opts.stat_mask |= predicates_stat_mask(result->root->filter_exprs) | predicates_stat_mask(result->root->prune_exprs);
+	}
+
+	DEBUGF("search", "Reading file status fields %#x in batches.", walk_opts.stat_mask);
+
+	bool cacheable = opts->result_cache && _search_result_is_cacheable(result->root);
+
+	if(opts->result_cache && !cacheable)
+	{
+		DEBUG("search", "Expression depends on the current time or extension functions, search results aren't cached.");
+	}
+
+	for(size_t i = 0; i < count && ret >= 0 && !filter_args.stopped; i++)
+	{
+		WalkerArgs args;
+
+		TRACEF("search", "Walking directory: \"%s\"", paths[i]);
+
+		_search_walker_args_init(&args, &filter_args, paths[i], result, predicates, err_message);
+
+		if(cacheable)
+		{
+			char *key = _search_result_cache_key(paths[i], expr, opts);
+
+			filter_args.cache = result_cache_open(opts->result_cache, key, opts->follow);
+			free(key);
+		}
+
+		walk_opts.list = filter_args.cache ? _search_walk_list : NULL;
+
+		bool success = walk(paths[i], &walk_opts, _search_walk_visit, _search_walk_error, &args);
+
+		ret = _search_add_count(ret, _search_walker_args_complete(&args, success));
+
+		/* incomplete results mustn't be cached */
+		if(filter_args.cache && !filter_args.stopped && args.status == PROCESS_STATUS_OK)
+		{
+			result_cache_save(filter_args.cache);
+		}
+
+		result_cache_destroy(filter_args.cache);
+		filter_args.cache = NULL;
+	}
+
+	_search_filter_args_free(&filter_args);
+
+	return ret;
+}
+
+static int
+_search_index(const char *const *paths, size_t count, ParserResult *result, Predicates *predicates, const SearchOptions *opts, FoundFileCallback found_file, Callback err_message, void *user_data)
+{
+	int ret = -1;
+
+	assert(paths != NULL);
+	assert(result != NULL);
+	assert(opts != NULL);
+	assert(opts->index_file != NULL);
+
+	DEBUGF("search", "Querying index: %s", opts->index_file);
+
+	Index *index = index_open(opts->index_file);
+
+	if(index)
+	{
+		FilterArgs filter_args;
+
+		_search_filter_args_init(&filter_args, result, predicates, opts, found_file, user_data);
+
+		ret = 0;
+
+		for(size_t i = 0; i < count && ret >= 0 && !filter_args.stopped; i++)
+		{
+			WalkerArgs args;
+
+			_search_walker_args_init(&args, &filter_args, paths[i], result, predicates, err_message);
+
+			bool success = index_query(index, paths[i], opts->max_depth, _search_index_visit, &args);
+
+			if(!success)
+			{
+				fprintf(stderr, _("Index is corrupt: %s\n"), opts->index_file);
+			}
+
+			ret = _search_add_count(ret, _search_walker_args_complete(&args, success));
+		}
+
+		_search_filter_args_free(&filter_args);
+		index_close(index);
+	}
+	else
+	{
+		fprintf(stderr, _("Couldn't open index `%s': %s\n"), opts->index_file, strerror(errno));
+	}
+
+	return ret;
+}
+
+int
+search_dirs(const char *const *paths, size_t count, const char *expr, TranslationFlags flags, const SearchOptions *opts, FoundFileCallback found_file, Callback err_message, void *user_data)
+{
+	int ret = -1;
+
+	assert(paths != NULL);
+	assert(count > 0);
+	assert(expr != NULL);
+	assert(opts != NULL);
+
+	char **argv = NULL;
+	size_t argc = 0;
+
+	TRACE("search", "Translating expression.");
+
+	ParserResult *result = _search_translate_expr(paths, count, expr, flags, opts, true, &argc, &argv);
+
+	assert(result != NULL);
+
+	Predicates *predicates = _search_compile_predicates(result, opts);
+
+	if(result->success)
+	{
+		DEBUG("search", "Expression parsed successfully.");
+
+		if(opts->index_file)
+		{
+			ret = _search_index(paths, count, result, predicates, opts, found_file, err_message, user_data);
+		}
+		else if(_search_in_process(result->root, opts))
+		{
+			ret = _search_walk(paths, count, expr, result, predicates, opts, found_file, err_message, user_data);
+		}
+		else
+		{
+			ret = _search_run_find(paths, count, argv, result, predicates, opts, found_file, err_message, user_data);
+		}
+	}
+	else if(result->err)
+	{
+		TRACEF("search", "Couldn't parse expression: %s", result->err);
+		fprintf(stderr, "%s\n", result->err);
+	}
+	else
+	{
+		TRACE("search", "Couldn't parse expression, no error message set.");
+	}
+
+	DEBUGF("search", "Search finished with result %d.", ret);
+
+	if(argv)
+	{
+		for(size_t i = 0; i < argc; i++)
+		{
+			free(argv[i]);
+		}
+
+		free(argv);
+	}
+
+	predicates_destroy(predicates);
+	parser_result_free(result);
+
+	return ret;
+}
+
+int
+search_files(const char *path, const char *expr, TranslationFlags flags, const SearchOptions *opts, FoundFileCallback found_file, Callback err_message, void *user_data)
+{
+	assert(path != NULL);
+
+	return search_dirs(&path, 1, expr, flags, opts, found_file, err_message, user_data);
+}
+
 bool
 search_debug(FILE *out, FILE *err, const char *path, const char *expr, TranslationFlags flags, const SearchOptions *opts)
 {
@@ -803,7 +1904,7 @@ search_debug(FILE *out, FILE *err, const char *path, const char *expr, Translati
 	size_t argc = 0;
 	char **argv = NULL;
 
-	ParserResult *result = _search_translate_expr(path, expr, flags, opts, &argc, &argv);
+	ParserResult *result = _search_translate_expr(&path, 1, expr, flags, opts, false, &argc, &argv);
 
 	assert(result != NULL);
 
@@ -27,6 +27,10 @@
 #include <stdint.h>
 
 #include "translate.h"
+#include "fileinfo.h"
+#include "extension.h"
+#include "walk.h"
+#include "rate-limit.h"
 
 /**
    @struct SearchOptions
@@ -40,8 +44,41 @@ typedef struct
 	bool follow;
 	/*! Regular expression type. */
 	char *regex_type;
+	/*! Cache file for results of pure extension functions. */
+	char *cache_file;
+	/*! Number of entries of a new extension cache file (0 for default size). */
+	size_t cache_size;
+	/*! Maximum number of files evaluated concurrently. */
+	size_t inflight;
+	/*! Skip files matching patterns found in .gitignore/.ignore files. */
+	bool respect_ignore_files;
+	/*! Don't descend directories on other filesystems. */
+	bool one_file_system;
+	/*! Comma-separated list of filesystems to skip. */
+	char *skip_fs_types;
+	/*! Index to query instead of searching the filesystem (may be NULL). */
+	char *index_file;
+	/*! Directory to cache search results in (may be NULL). */
+	char *result_cache;
+	/*! Preloaded extensions (NULL to load the default extensions). */
+	ExtensionManager *extensions;
+	/*! statx fields needed to print or sort found files. */
+	unsigned int stat_mask;
+	/*! Sort directory entries by inode number before reading their status. */
+	WalkInodeOrder inode_order;
+	/*! Limits the rate of I/O operations (may be NULL). */
+	RateLimit *rate_limit;
+	/*! Maximum number of I/O requests in flight, 0 for the default. */
+	size_t max_inflight;
+	/*! Milliseconds after which the search is stopped, 0 for no limit. */
+	int64_t timeout;
+	/*! Pipe found files are written to, the search is stopped when it's closed (-1 to ignore). */
+	int output_fd;
 } SearchOptions;
 
+/*! Returned by search_files() and search_dirs() if the search has been stopped after its timeout. */
+#define SEARCH_TIMED_OUT -2
+
 /**
    @param opts SearchOptions to free
 
@@ -56,6 +93,14 @@ void search_options_free(SearchOptions *opts);
  */
 typedef bool (*Callback)(const char *str, void *user_data);
 
+/**
+   @typedef FoundFileCallback
+   @brief A function called for each found file. The callback has to increment
+          the reference counter of the FileInfo if it keeps the record.
+          If the callback returns true the search aborts.
+ */
+typedef bool (*FoundFileCallback)(FileInfo *info, void *user_data);
+
 /**
    @param path directory to search in
    @param expr expression
@@ -64,12 +109,35 @@ typedef bool (*Callback)(const char *str, void *user_data);
    @param found_file function called for each found file
    @param err_message function called for each failure message
    @param user_data user data
-   @return number of found files
+   @return number of found files, SEARCH_TIMED_OUT or -1 on failure
 
    Translates an expression and executes GNU find. If specified, the result is filtered
-   by evaluating a tree of filter functions.
+   by evaluating a tree of filter functions. If directories are pruned by functions,
+   ignore files are respected or I/O is rate limited the directory tree is walked
+   in-process instead.
+   If an index file is set the expression is evaluated against the index.
+   If a timeout is set the search is stopped when it expires, files evaluated
+   until then are still passed to found_file.
+ */
+int search_files(const char *path, const char *expr, TranslationFlags flags, const SearchOptions *opts, FoundFileCallback found_file, Callback err_message, void *user_data);
+
+/**
+   @param paths directories to search in
+   @param count number of directories
+   @param expr expression
+   @param flags translation flags
+   @param opts search options
+   @param found_file function called for each found file
+   @param err_message function called for each failure message
+   @param user_data user data
+   @return number of found files, SEARCH_TIMED_OUT or -1 on failure
+
+   Like search_files() but searches several directories. The expression is
+   parsed and extensions are loaded only once, all directories are passed to
+   a single find process. The cli field of found files is the directory they
+   were found in.
  */
-int search_files(const char *path, const char *expr, TranslationFlags flags, const SearchOptions *opts, Callback found_file, Callback err_message, void *user_data);
+int search_dirs(const char *const *paths, size_t count, const char *expr, TranslationFlags flags, const SearchOptions *opts, FoundFileCallback found_file, Callback err_message, void *user_data);
 
 /**
    @param out stream to write the translated expression to
@@ -0,0 +1,611 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file server.c
+   @brief Serve efind requests over a Unix domain socket.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <assert.h>
+
+#include "server.h"
+#include "fs.h"
+#include "utils.h"
+#include "log.h"
+
+/*! @cond INTERNAL */
+/*
+   A request consists of a 32bit length, followed by the NUL-terminated working
+   directory and arguments. The client's standard output and standard error are
+   passed along with the length. The server answers with a 32bit exit status.
+ */
+#define SERVER_MAX_REQUEST_SIZE (1024 * 1024)
+
+/* seconds a client may take to send its request */
+#define SERVER_RECEIVE_TIMEOUT 10
+
+struct _Server
+{
+	int fd;
+	char *path;
+};
+
+static volatile sig_atomic_t _server_stop = 0;
+/*! @endcond */
+
+static bool
+_server_path_to_addr(const char *path, struct sockaddr_un *addr)
+{
+	bool success = false;
+
+	assert(path != NULL);
+	assert(addr != NULL);
+
+	memset(addr, 0, sizeof(struct sockaddr_un));
+	addr->sun_family = AF_UNIX;
+
+	if(strlen(path) < sizeof(addr->sun_path))
+	{
+		strcpy(addr->sun_path, path);
+		success = true;
+	}
+	else
+	{
+		errno = ENAMETOOLONG;
+	}
+
+	return success;
+}
+
+static void
+_server_remove_stale_socket(const char *path, const struct sockaddr_un *addr)
+{
+	struct stat sb;
+
+	assert(path != NULL);
+	assert(addr != NULL);
+
+	if(!lstat(path, &sb) && S_ISSOCK(sb.st_mode))
+	{
+		/* only remove sockets no server is listening on anymore */
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+		if(fd != -1)
+		{
+			if(connect(fd, (const struct sockaddr *)addr, sizeof(struct sockaddr_un)) == -1 && errno == ECONNREFUSED)
+			{
+				DEBUGF("server", "Removing stale socket: %s", path);
+				unlink(path);
+			}
+
+			close(fd);
+		}
+	}
+}
+
+Server *
+server_new(const char *path)
+{
+	Server *server = NULL;
+	struct sockaddr_un addr;
+
+	assert(path != NULL);
+
+	if(_server_path_to_addr(path, &addr))
+	{
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+		if(fd != -1)
+		{
+			_server_remove_stale_socket(path, &addr);
+
+			mode_t mask = umask(0077);
+			int rc = bind(fd, (struct sockaddr *)&addr, sizeof(struct sockaddr_un));
+
+			umask(mask);
+
+			if(!rc && !listen(fd, SOMAXCONN))
+			{
+				DEBUGF("server", "Listening on socket: %s", path);
+
+				server = utils_new(1, Server);
+				server->fd = fd;
+				server->path = utils_strdup(path);
+			}
+			else
+			{
+				int errnum = errno;
+
+				ERRORF("server", "Couldn't listen on socket `%s', errno=%d.", path, errnum);
+				close(fd);
+				errno = errnum;
+			}
+		}
+	}
+
+	return server;
+}
+
+static void
+_server_reap_children(void)
+{
+	pid_t pid;
+
+	while((pid = waitpid(-1, NULL, WNOHANG)) > 0)
+	{
+		TRACEF("server", "Child process %ld exited.", (long)pid);
+	}
+}
+
+void
+server_destroy(Server *server)
+{
+	if(server)
+	{
+		close(server->fd);
+		unlink(server->path);
+		free(server->path);
+		free(server);
+
+		_server_reap_children();
+	}
+}
+
+int
+server_get_fd(const Server *server)
+{
+	assert(server != NULL);
+
+	return server->fd;
+}
+
+static bool
+_server_read_all(int fd, void *buffer, size_t len)
+{
+	char *ptr = buffer;
+
+	while(len)
+	{
+		ssize_t bytes = read(fd, ptr, len);
+
+		if(bytes > 0)
+		{
+			ptr += bytes;
+			len -= bytes;
+		}
+		else if(!bytes || errno != EINTR)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool
+_server_write_all(int fd, const void *buffer, size_t len)
+{
+	const char *ptr = buffer;
+
+	while(len)
+	{
+		ssize_t bytes = write(fd, ptr, len);
+
+		if(bytes > 0)
+		{
+			ptr += bytes;
+			len -= bytes;
+		}
+		else if(bytes == -1 && errno != EINTR)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool
+_server_receive_header(int fd, uint32_t *len, int fds[2])
+{
+	bool success = false;
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(int) * 2)];
+		struct cmsghdr align;
+	} control;
+
+	assert(len != NULL);
+	assert(fds != NULL);
+
+	memset(&msg, 0, sizeof(struct msghdr));
+
+	iov.iov_base = len;
+	iov.iov_len = sizeof(uint32_t);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	fds[0] = fds[1] = -1;
+
+	ssize_t bytes = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+
+	if(bytes > 0)
+	{
+		struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+
+		if(cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS && cmsg->cmsg_len == CMSG_LEN(sizeof(int) * 2))
+		{
+			memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * 2);
+			success = ((size_t)bytes == sizeof(uint32_t) || _server_read_all(fd, (char *)len + bytes, sizeof(uint32_t) - bytes));
+		}
+	}
+
+	return success;
+}
+
+static char **
+_server_split_request(char *data, size_t len, int *argc)
+{
+	assert(data != NULL);
+	assert(argc != NULL);
+
+	char **argv = utils_new(len + 1, char *);
+	size_t offset = 0;
+
+	*argc = 0;
+
+	while(offset < len)
+	{
+		argv[(*argc)++] = data + offset;
+		offset += strlen(data + offset) + 1;
+	}
+
+	return argv;
+}
+
+static void
+_server_run_handler(int fd, char *data, uint32_t len, int fds[2], ServerHandler handler, void *user_data)
+{
+	int status = EXIT_FAILURE;
+	int argc;
+	char **argv = _server_split_request(data, len, &argc);
+
+	assert(handler != NULL);
+
+	/* the server may have installed its own signal handlers */
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+
+	int null = open("/dev/null", O_RDONLY);
+
+	if(argc >= 2 && !chdir(argv[0])
+	   && null != -1 && dup2(null, STDIN_FILENO) != -1
+	   && dup2(fds[0], STDOUT_FILENO) != -1 && dup2(fds[1], STDERR_FILENO) != -1)
+	{
+		status = handler(argc - 1, argv + 1, user_data);
+
+		fflush(stdout);
+		fflush(stderr);
+	}
+	else
+	{
+		ERRORF("server", "Couldn't set up request, errno=%d.", errno);
+	}
+
+	int32_t result = status;
+
+	_server_write_all(fd, &result, sizeof(int32_t));
+	_exit(EXIT_SUCCESS);
+}
+
+static void
+_server_handle_request(int fd, ServerHandler handler, void *user_data)
+{
+	uint32_t len;
+	int fds[2];
+	struct timeval timeout;
+
+	assert(handler != NULL);
+
+	timeout.tv_sec = SERVER_RECEIVE_TIMEOUT;
+	timeout.tv_usec = 0;
+
+	if(setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(struct timeval)))
+	{
+		WARNINGF("server", "Couldn't set receive timeout, errno=%d.", errno);
+	}
+
+	if(_server_receive_header(fd, &len, fds) && len && len <= SERVER_MAX_REQUEST_SIZE)
+	{
+		char *data = utils_malloc(len + 1);
+
+		if(_server_read_all(fd, data, len))
+		{
+			data[len] = '\0';
+			_server_run_handler(fd, data, len, fds, handler, user_data);
+		}
+
+		free(data);
+	}
+
+	WARNING("server", "Received malformed request.");
+	_exit(EXIT_FAILURE);
+}
+
+bool
+server_accept(Server *server, ServerHandler handler, void *user_data)
+{
+	bool success = false;
+
+	assert(server != NULL);
+	assert(handler != NULL);
+
+	_server_reap_children();
+
+	int fd = accept4(server->fd, NULL, NULL, SOCK_CLOEXEC);
+
+	if(fd != -1)
+	{
+		fflush(stdout);
+		fflush(stderr);
+
+		/* the request is received by the child, a slow client mustn't block the server */
+		pid_t pid = fork();
+
+		if(pid == 0)
+		{
+			_server_handle_request(fd, handler, user_data);
+		}
+		else if(pid == -1)
+		{
+			ERRORF("server", "`fork' failed, errno=%d.", errno);
+		}
+		else
+		{
+			DEBUGF("server", "Handling request in child process %ld.", (long)pid);
+			success = true;
+		}
+
+		close(fd);
+	}
+
+	return success;
+}
+
+static void
+_server_signal_handler(int signum)
+{
+	_server_stop = 1;
+}
+
+void
+server_install_signal_handlers(void)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(struct sigaction));
+	sa.sa_handler = _server_signal_handler;
+	sigemptyset(&sa.sa_mask);
+
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+}
+
+bool
+server_stop_requested(void)
+{
+	return _server_stop != 0;
+}
+
+bool
+server_run(Server *server, ServerHandler handler, void *user_data)
+{
+	bool success = true;
+
+	assert(server != NULL);
+	assert(handler != NULL);
+
+	server_install_signal_handlers();
+
+	/* the mount table signals changes with POLLPRI */
+	int mounts = open("/proc/self/mounts", O_RDONLY | O_CLOEXEC);
+
+	if(mounts == -1)
+	{
+		WARNINGF("server", "Couldn't open mount table, errno=%d.", errno);
+	}
+
+	while(!_server_stop && success)
+	{
+		struct pollfd fds[2];
+
+		fds[0].fd = server->fd;
+		fds[0].events = POLLIN;
+		fds[1].fd = mounts;
+		fds[1].events = POLLPRI;
+
+		int rc = poll(fds, 2, -1);
+
+		if(rc > 0)
+		{
+			if(fds[1].revents & (POLLPRI | POLLERR))
+			{
+				fs_map_reload_default();
+			}
+
+			if(fds[0].revents & POLLIN)
+			{
+				server_accept(server, handler, user_data);
+			}
+		}
+		else if(rc == -1 && errno != EINTR)
+		{
+			ERRORF("server", "`poll' failed, errno=%d.", errno);
+			success = false;
+		}
+	}
+
+	if(mounts != -1)
+	{
+		close(mounts);
+	}
+
+	return success;
+}
+
+static char *
+_server_build_request(int argc, char *argv[], uint32_t *len)
+{
+	char cwd[PATH_MAX];
+	char *data = NULL;
+
+	assert(argv != NULL);
+	assert(len != NULL);
+
+	if(getcwd(cwd, sizeof(cwd)))
+	{
+		size_t size = strlen(cwd) + 1;
+
+		for(int i = 0; i < argc; ++i)
+		{
+			size += strlen(argv[i]) + 1;
+		}
+
+		if(size <= SERVER_MAX_REQUEST_SIZE)
+		{
+			data = utils_malloc(size);
+			*len = (uint32_t)size;
+
+			size_t offset = strlen(cwd) + 1;
+
+			memcpy(data, cwd, offset);
+
+			for(int i = 0; i < argc; ++i)
+			{
+				size_t arglen = strlen(argv[i]) + 1;
+
+				memcpy(data + offset, argv[i], arglen);
+				offset += arglen;
+			}
+		}
+		else
+		{
+			errno = E2BIG;
+		}
+	}
+
+	return data;
+}
+
+static bool
+_server_send_header(int fd, uint32_t len)
+{
+	struct msghdr msg;
+	struct iovec iov;
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(int) * 2)];
+		struct cmsghdr align;
+	} control;
+	int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+
+	memset(&msg, 0, sizeof(struct msghdr));
+	memset(&control, 0, sizeof(control));
+
+	iov.iov_base = &len;
+	iov.iov_len = sizeof(uint32_t);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(int) * 2);
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * 2);
+
+	return sendmsg(fd, &msg, 0) == sizeof(uint32_t);
+}
+
+int
+server_connect(const char *path, int argc, char *argv[])
+{
+	int status = -1;
+	struct sockaddr_un addr;
+	uint32_t len;
+
+	assert(path != NULL);
+	assert(argv != NULL);
+
+	char *data = _server_build_request(argc, argv, &len);
+
+	if(data && _server_path_to_addr(path, &addr))
+	{
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+		if(fd != -1)
+		{
+			if(!connect(fd, (struct sockaddr *)&addr, sizeof(struct sockaddr_un))
+			   && _server_send_header(fd, len)
+			   && _server_write_all(fd, data, len))
+			{
+				int32_t result;
+
+				DEBUGF("server", "Request sent to `%s', waiting for exit status.", path);
+
+				if(_server_read_all(fd, &result, sizeof(int32_t)))
+				{
+					status = result;
+				}
+			}
+
+			int errnum = errno;
+
+			close(fd);
+			errno = errnum;
+		}
+	}
+
+	free(data);
+
+	return status;
+}
@@ -0,0 +1,114 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file server.h
+   @brief Serve efind requests over a Unix domain socket.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdbool.h>
+
+/**
+   @typedef ServerHandler
+   @brief Function handling a request in a child process. The working directory,
+          standard output and standard error of the client have been set up.
+          Returns the exit status sent to the client.
+ */
+typedef int (*ServerHandler)(int argc, char *argv[], void *user_data);
+
+/**
+   @struct Server
+   @brief A listening Unix domain socket.
+ */
+typedef struct _Server Server;
+
+/**
+   @param path location of the socket
+   @return a new Server or NULL on failure
+
+   Creates a Unix domain socket and listens for requests. A stale socket
+   found at the given location is replaced.
+ */
+Server *server_new(const char *path);
+
+/**
+   @param server Server to destroy
+
+   Closes and removes the socket.
+ */
+void server_destroy(Server *server);
+
+/**
+   @param server a Server
+   @return file descriptor to poll for incoming requests
+
+   Gets the file descriptor of the listening socket.
+ */
+int server_get_fd(const Server *server);
+
+/**
+   @param server a Server
+   @param handler function handling the request
+   @param user_data user data
+   @return false if no request could be accepted
+
+   Accepts a pending request and handles it in a forked child process, so
+   loaded extensions and caches of the server are shared with the handler.
+   The child receives the request, clients sending nothing time out.
+   Finished child processes are reaped.
+ */
+bool server_accept(Server *server, ServerHandler handler, void *user_data);
+
+/**
+   Installs handlers for SIGINT and SIGTERM requesting the server to stop.
+ */
+void server_install_signal_handlers(void);
+
+/**
+   @return true if SIGINT or SIGTERM has been received
+
+   Tests if the server should stop.
+ */
+bool server_stop_requested(void);
+
+/**
+   @param server a Server
+   @param handler function handling requests
+   @param user_data user data
+   @return false on failure
+
+   Accepts and handles requests until SIGINT or SIGTERM is received. The
+   shared list of mountpoints is generated again when the mount table changes,
+   so forked requests don't have to read it.
+ */
+bool server_run(Server *server, ServerHandler handler, void *user_data);
+
+/**
+   @param path location of the socket
+   @param argc number of arguments
+   @param argv arguments
+   @return exit status of the request or -1 on failure
+
+   Sends the current working directory, standard output, standard error and
+   the given arguments to a server and waits until the request has been handled.
+ */
+int server_connect(const char *path, int argc, char *argv[]);
+
+#endif
+
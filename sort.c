@@ -37,7 +37,7 @@ typedef struct
 } SortProcessor;
 /*! @endcond */
 
-static const char *
+static FileInfo *
 _sort_processor_read(Processor *processor)
 {
 	assert(processor != NULL);
@@ -47,7 +47,7 @@ _sort_processor_read(Processor *processor)
 	processor->flags |= PROCESSOR_FLAG_READABLE;
 
 	FileListEntry *entry = file_list_at(sort->files, sort->offset);
-	const char *path = entry->info->path;
+	FileInfo *info = entry->info;
 
 	++sort->offset;
 
@@ -57,19 +57,18 @@ _sort_processor_read(Processor *processor)
 		processor->flags |= PROCESSOR_FLAG_CLOSED;
 	}
 
-	return path;
+	return info;
 }
 
 static void
-_sort_processor_write(Processor *processor, const char *dir, const char *path)
+_sort_processor_write(Processor *processor, FileInfo *info)
 {
 	assert(processor != NULL);
-	assert(dir != NULL);
-	assert(path != NULL);
+	assert(info != NULL);
 
 	SortProcessor *sort = (SortProcessor *)processor;
 
-	file_list_append(sort->files, dir, path);
+	file_list_append(sort->files, info);
 }
 
 static void
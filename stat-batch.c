@@ -0,0 +1,397 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file stat-batch.c
+   @brief Read the status of many files with a single system call.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <assert.h>
+
+#include "stat-batch.h"
+#include "log.h"
+#include "utils.h"
+
+/*! @cond INTERNAL */
+struct _StatBatch
+{
+	int fd;
+	unsigned int depth;
+	void *sq_ring;
+	size_t sq_ring_size;
+	void *cq_ring;
+	size_t cq_ring_size;
+	struct io_uring_sqe *sqes;
+	size_t sqes_size;
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_array;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_cqe *cqes;
+};
+
+/* set if statx isn't supported by the kernel or blocked by a seccomp filter */
+static bool _stat_batch_no_statx = false;
+/*! @endcond */
+
+static void
+_stat_batch_unmap(StatBatch *batch)
+{
+	assert(batch != NULL);
+
+	if(batch->sqes)
+	{
+		munmap(batch->sqes, batch->sqes_size);
+	}
+
+	if(batch->cq_ring && batch->cq_ring != batch->sq_ring)
+	{
+		munmap(batch->cq_ring, batch->cq_ring_size);
+	}
+
+	if(batch->sq_ring)
+	{
+		munmap(batch->sq_ring, batch->sq_ring_size);
+	}
+
+	if(batch->fd != -1)
+	{
+		close(batch->fd);
+	}
+
+	batch->sqes = NULL;
+	batch->cq_ring = NULL;
+	batch->sq_ring = NULL;
+	batch->fd = -1;
+}
+
+static bool
+_stat_batch_setup(StatBatch *batch, unsigned int depth)
+{
+	struct io_uring_params params;
+
+	assert(batch != NULL);
+
+	memset(&params, 0, sizeof(struct io_uring_params));
+
+	batch->fd = syscall(__NR_io_uring_setup, depth, &params);
+
+	if(batch->fd == -1)
+	{
+		DEBUGF("stat-batch", "io_uring isn't available: %s", strerror(errno));
+		return false;
+	}
+
+	batch->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	batch->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+	if(params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if(batch->cq_ring_size > batch->sq_ring_size)
+		{
+			batch->sq_ring_size = batch->cq_ring_size;
+		}
+
+		batch->cq_ring_size = batch->sq_ring_size;
+	}
+
+	batch->sq_ring = mmap(NULL, batch->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, batch->fd, IORING_OFF_SQ_RING);
+
+	if(batch->sq_ring == MAP_FAILED)
+	{
+		batch->sq_ring = NULL;
+	}
+	else if(params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		batch->cq_ring = batch->sq_ring;
+	}
+	else
+	{
+		batch->cq_ring = mmap(NULL, batch->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, batch->fd, IORING_OFF_CQ_RING);
+
+		if(batch->cq_ring == MAP_FAILED)
+		{
+			batch->cq_ring = NULL;
+		}
+	}
+
+	if(batch->cq_ring)
+	{
+		batch->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+		batch->sqes = mmap(NULL, batch->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, batch->fd, IORING_OFF_SQES);
+
+		if(batch->sqes == MAP_FAILED)
+		{
+			batch->sqes = NULL;
+		}
+	}
+
+	if(!batch->sqes)
+	{
+		WARNINGF("stat-batch", "Couldn't map io_uring buffers: %s", strerror(errno));
+		_stat_batch_unmap(batch);
+		return false;
+	}
+
+	batch->sq_head = (unsigned int *)((char *)batch->sq_ring + params.sq_off.head);
+	batch->sq_tail = (unsigned int *)((char *)batch->sq_ring + params.sq_off.tail);
+	batch->sq_mask = (unsigned int *)((char *)batch->sq_ring + params.sq_off.ring_mask);
+	batch->sq_array = (unsigned int *)((char *)batch->sq_ring + params.sq_off.array);
+	batch->cq_head = (unsigned int *)((char *)batch->cq_ring + params.cq_off.head);
+	batch->cq_tail = (unsigned int *)((char *)batch->cq_ring + params.cq_off.tail);
+	batch->cq_mask = (unsigned int *)((char *)batch->cq_ring + params.cq_off.ring_mask);
+	batch->cqes = (struct io_uring_cqe *)((char *)batch->cq_ring + params.cq_off.cqes);
+
+	/* the completion queue is at least as large as the submission queue */
+	batch->depth = params.sq_entries;
+
+	DEBUGF("stat-batch", "Created io_uring instance with %u entries.", batch->depth);
+
+	return true;
+}
+
+StatBatch *
+stat_batch_new(unsigned int depth)
+{
+	assert(depth > 0);
+
+	StatBatch *batch = utils_new(1, StatBatch);
+
+	batch->fd = -1;
+
+	if(!_stat_batch_setup(batch, depth))
+	{
+		DEBUG("stat-batch", "Falling back to statx.");
+	}
+
+	return batch;
+}
+
+void
+stat_batch_destroy(StatBatch *batch)
+{
+	if(batch)
+	{
+		_stat_batch_unmap(batch);
+		free(batch);
+	}
+}
+
+static int
+_stat_batch_lstat(int dirfd, const char *name, struct statx *stx)
+{
+	int ret;
+
+	assert(name != NULL);
+	assert(stx != NULL);
+
+	#ifdef _LARGEFILE64_SOURCE
+	struct stat64 sb;
+
+	ret = fstatat64(dirfd, name, &sb, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT);
+	#else
+	struct stat sb;
+
+	ret = fstatat(dirfd, name, &sb, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT);
+	#endif
+
+	if(!ret)
+	{
+		memset(stx, 0, sizeof(struct statx));
+
+		stx->stx_mask = STATX_BASIC_STATS;
+		stx->stx_mode = sb.st_mode;
+		stx->stx_nlink = sb.st_nlink;
+		stx->stx_uid = sb.st_uid;
+		stx->stx_gid = sb.st_gid;
+		stx->stx_ino = sb.st_ino;
+		stx->stx_size = sb.st_size;
+		stx->stx_blocks = sb.st_blocks;
+		stx->stx_blksize = sb.st_blksize;
+		stx->stx_atime.tv_sec = sb.st_atim.tv_sec;
+		stx->stx_atime.tv_nsec = sb.st_atim.tv_nsec;
+		stx->stx_mtime.tv_sec = sb.st_mtim.tv_sec;
+		stx->stx_mtime.tv_nsec = sb.st_mtim.tv_nsec;
+		stx->stx_ctime.tv_sec = sb.st_ctim.tv_sec;
+		stx->stx_ctime.tv_nsec = sb.st_ctim.tv_nsec;
+		stx->stx_dev_major = major(sb.st_dev);
+		stx->stx_dev_minor = minor(sb.st_dev);
+		stx->stx_rdev_major = major(sb.st_rdev);
+		stx->stx_rdev_minor = minor(sb.st_rdev);
+	}
+
+	return ret;
+}
+
+static int
+_stat_batch_statx(int dirfd, const char *name, unsigned int mask, struct statx *stx)
+{
+	int ret = -1;
+
+	assert(name != NULL);
+	assert(stx != NULL);
+
+	if(!__atomic_load_n(&_stat_batch_no_statx, __ATOMIC_RELAXED))
+	{
+		ret = statx(dirfd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, mask, stx);
+
+		if(ret && (errno == ENOSYS || errno == EPERM))
+		{
+			DEBUG("stat-batch", "statx isn't available, falling back to lstat.");
+			__atomic_store_n(&_stat_batch_no_statx, true, __ATOMIC_RELAXED);
+		}
+	}
+
+	if(__atomic_load_n(&_stat_batch_no_statx, __ATOMIC_RELAXED))
+	{
+		ret = _stat_batch_lstat(dirfd, name, stx);
+	}
+
+	return ret;
+}
+
+static void
+_stat_batch_sync(int dirfd, StatRequest *request, unsigned int mask)
+{
+	assert(request != NULL);
+
+	request->err = _stat_batch_statx(dirfd, request->name, mask, &request->stx) ? errno : 0;
+}
+
+static bool
+_stat_batch_submit(StatBatch *batch, int dirfd, StatRequest *requests, size_t count, unsigned int mask)
+{
+	size_t next = 0;
+	size_t completed = 0;
+	unsigned int inflight = 0;
+
+	assert(batch != NULL);
+	assert(requests != NULL);
+
+	while(completed < count)
+	{
+		unsigned int tail = *batch->sq_tail;
+
+		while(next < count && inflight < batch->depth)
+		{
+			unsigned int index = tail & *batch->sq_mask;
+			struct io_uring_sqe *sqe = &batch->sqes[index];
+
+			memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+			sqe->opcode = IORING_OP_STATX;
+			sqe->fd = dirfd;
+			sqe->addr = (uintptr_t)requests[next].name;
+			sqe->len = mask;
+			sqe->off = (uintptr_t)&requests[next].stx;
+			sqe->statx_flags = AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT;
+			sqe->user_data = next;
+
+			batch->sq_array[index] = index;
+
+			++tail;
+			++next;
+			++inflight;
+		}
+
+		__atomic_store_n(batch->sq_tail, tail, __ATOMIC_RELEASE);
+
+		unsigned int pending = tail - __atomic_load_n(batch->sq_head, __ATOMIC_ACQUIRE);
+
+		if(syscall(__NR_io_uring_enter, batch->fd, pending, 1, IORING_ENTER_GETEVENTS, NULL, 0) == -1 && errno != EINTR)
+		{
+			WARNINGF("stat-batch", "io_uring_enter failed: %s", strerror(errno));
+			return false;
+		}
+
+		unsigned int head = *batch->cq_head;
+		unsigned int cq_tail = __atomic_load_n(batch->cq_tail, __ATOMIC_ACQUIRE);
+
+		while(head != cq_tail)
+		{
+			struct io_uring_cqe *cqe = &batch->cqes[head & *batch->cq_mask];
+			StatRequest *request = &requests[cqe->user_data];
+
+			if(cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP || cqe->res == -ENOSYS || cqe->res == -EPERM)
+			{
+				/* kernel doesn't support IORING_OP_STATX or statx is blocked */
+				_stat_batch_sync(dirfd, request, mask);
+			}
+			else
+			{
+				request->err = cqe->res < 0 ? -cqe->res : 0;
+			}
+
+			++head;
+			++completed;
+			--inflight;
+		}
+
+		__atomic_store_n(batch->cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	return true;
+}
+
+void
+stat_batch_run(StatBatch *batch, int dirfd, StatRequest *requests, size_t count, unsigned int mask)
+{
+	assert(batch != NULL);
+	assert(requests != NULL);
+
+	TRACEF("stat-batch", "Reading status of %zu file(s), mask=%#x.", count, mask);
+
+	if(batch->fd != -1 && count > 1 && !_stat_batch_submit(batch, dirfd, requests, count, mask))
+	{
+		/* requests in flight can't be tracked anymore, read all files again */
+		_stat_batch_unmap(batch);
+	}
+
+	if(batch->fd == -1 || count == 1)
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			_stat_batch_sync(dirfd, &requests[i], mask);
+		}
+	}
+}
+
+int
+stat_batch_file(const char *path, unsigned int mask, struct statx *stx)
+{
+	assert(path != NULL);
+	assert(stx != NULL);
+
+	return _stat_batch_statx(AT_FDCWD, path, mask, stx);
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file stat-batch.h
+   @brief Read the status of many files with a single system call.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef STAT_BATCH_H
+#define STAT_BATCH_H
+
+#include <stddef.h>
+#include <sys/stat.h>
+
+/**
+   @struct StatRequest
+   @brief Status request of a single file.
+ */
+typedef struct
+{
+	/*! Name of the file relative to the directory. */
+	const char *name;
+	/*! File status. */
+	struct statx stx;
+	/*! 0 on success, otherwise an error code. */
+	int err;
+} StatRequest;
+
+/**
+   @struct StatBatch
+   @brief Submits status requests through io_uring. Requests are read with
+          plain statx calls if io_uring isn't available.
+ */
+typedef struct _StatBatch StatBatch;
+
+/**
+   @param depth maximum number of requests in flight
+   @return a new StatBatch
+
+   Creates a StatBatch.
+ */
+StatBatch *stat_batch_new(unsigned int depth);
+
+/**
+   @param batch StatBatch to free
+
+   Frees a StatBatch.
+ */
+void stat_batch_destroy(StatBatch *batch);
+
+/**
+   @param batch a StatBatch
+   @param dirfd directory the names of the requests are relative to
+   @param requests requests to process
+   @param count number of requests
+   @param mask statx fields to read (e.g. STATX_SIZE | STATX_MTIME)
+
+   Reads the status of the given files without following symbolic links.
+   Returns after all requests have been completed.
+ */
+void stat_batch_run(StatBatch *batch, int dirfd, StatRequest *requests, size_t count, unsigned int mask);
+
+/**
+   @param path file to read
+   @param mask statx fields to read
+   @param stx location to store the file status to
+   @return 0 on success, otherwise -1 and errno is set
+
+   Reads the status of a single file without following symbolic links.
+ */
+int stat_batch_file(const char *path, unsigned int mask, struct statx *stx);
+
+#endif
+
@@ -0,0 +1,165 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file tee.c
+   @brief Send found files to multiple processor chains.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#include <assert.h>
+#include <string.h>
+
+#include "tee.h"
+#include "utils.h"
+#include "log.h"
+
+/*! @cond INTERNAL */
+typedef struct
+{
+	Processor padding;
+	ProcessorChain **chains;
+	ProcessorChainResult *results;
+	size_t count;
+} TeeProcessor;
+/*! @endcond */
+
+static FileInfo *
+_tee_processor_read(Processor *processor)
+{
+	assert(processor != NULL);
+
+	processor->flags &= ~PROCESSOR_FLAG_READABLE;
+
+	return NULL;
+}
+
+static void
+_tee_processor_update_state(TeeProcessor *tee)
+{
+	assert(tee != NULL);
+
+	bool open = false;
+
+	for(size_t i = 0; i < tee->count; ++i)
+	{
+		if(tee->results[i] == PROCESSOR_CHAIN_ERROR)
+		{
+			((Processor *)tee)->flags |= PROCESSOR_FLAG_CLOSED | PROCESSOR_FLAG_ERROR;
+		}
+		else if(tee->results[i] == PROCESSOR_CHAIN_CONTINUE)
+		{
+			open = true;
+		}
+	}
+
+	if(!open)
+	{
+		((Processor *)tee)->flags |= PROCESSOR_FLAG_CLOSED;
+	}
+}
+
+static void
+_tee_processor_write(Processor *processor, FileInfo *info)
+{
+	assert(processor != NULL);
+	assert(info != NULL);
+
+	TeeProcessor *tee = (TeeProcessor *)processor;
+
+	for(size_t i = 0; i < tee->count && !processor_has_error(processor); ++i)
+	{
+		if(tee->results[i] == PROCESSOR_CHAIN_CONTINUE)
+		{
+			TRACEF("processor", "Writing file to branch %zu: %s", i, info->path);
+
+			tee->results[i] = processor_chain_write(tee->chains[i], info);
+
+			if(tee->results[i] == PROCESSOR_CHAIN_ERROR)
+			{
+				processor->flags |= PROCESSOR_FLAG_ERROR;
+			}
+		}
+	}
+
+	_tee_processor_update_state(tee);
+}
+
+static void
+_tee_processor_close(Processor *processor)
+{
+	assert(processor != NULL);
+
+	TeeProcessor *tee = (TeeProcessor *)processor;
+
+	for(size_t i = 0; i < tee->count; ++i)
+	{
+		if(tee->results[i] == PROCESSOR_CHAIN_CONTINUE)
+		{
+			TRACEF("processor", "Completing branch %zu.", i);
+
+			tee->results[i] = processor_chain_complete(tee->chains[i]);
+		}
+	}
+
+	processor->flags |= PROCESSOR_FLAG_CLOSED;
+
+	_tee_processor_update_state(tee);
+}
+
+static void
+_tee_processor_free(Processor *processor)
+{
+	assert(processor != NULL);
+
+	TeeProcessor *tee = (TeeProcessor *)processor;
+
+	for(size_t i = 0; i < tee->count; ++i)
+	{
+		processor_chain_destroy(tee->chains[i]);
+	}
+
+	free(tee->chains);
+	free(tee->results);
+}
+
+Processor *
+tee_processor_new(ProcessorChain **chains, size_t count)
+{
+	assert(chains != NULL);
+	assert(count > 0);
+
+	Processor *processor = (Processor *)utils_malloc(sizeof(TeeProcessor));
+
+	memset(processor, 0, sizeof(TeeProcessor));
+
+	processor->read = _tee_processor_read;
+	processor->write = _tee_processor_write;
+	processor->close = _tee_processor_close;
+	processor->free = _tee_processor_free;
+
+	TeeProcessor *tee = (TeeProcessor *)processor;
+
+	tee->chains = chains;
+	tee->count = count;
+	tee->results = utils_new(count, ProcessorChainResult);
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		tee->results[i] = chains[i] ? PROCESSOR_CHAIN_CONTINUE : PROCESSOR_CHAIN_COMPLETED;
+	}
+
+	return processor;
+}
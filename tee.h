@@ -0,0 +1,41 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file tee.h
+   @brief Send found files to multiple processor chains.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef TEE_H
+#define TEE_H
+
+#include <stdlib.h>
+
+#include "processor.h"
+
+/**
+   @param chains processor chains to write found files to
+   @param count number of processor chains
+   @return a new Processor
+
+   Writes each found file to all given chains. The processor takes ownership
+   of the chains and the array. It closes when all chains have been completed
+   and fails as soon as one of the chains fails.
+ */
+Processor *tee_processor_new(ProcessorChain **chains, size_t count);
+
+#endif
+
@@ -16,6 +16,14 @@ discover(RegistrationCtx *ctx, RegisterCallback fn)
 	fn(ctx, "c_sub", 2, CALLBACK_ARG_TYPE_INTEGER, CALLBACK_ARG_TYPE_INTEGER);
 }
 
+void
+declare_reentrant(RegistrationCtx *ctx, MarkReentrant fn)
+{
+	fn(ctx, "c_name_equals");
+	fn(ctx, "c_add");
+	fn(ctx, "c_sub");
+}
+
 int
 c_name_equals(const char *filename, int argc, void *argv[])
 {
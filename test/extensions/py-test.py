@@ -11,4 +11,16 @@ def py_add(filename: str, a: int, b: int):
 def py_sub(filename: str, a: int, b: int):
     return a - b
 
-EXTENSION_EXPORT=[py_name_equals, py_add, py_sub]
+def py_slow_true(filename: str, logfile: str):
+    import time
+
+    with open(logfile, "a") as f:
+        f.write("%s\n" % filename)
+
+    time.sleep(0.005)
+
+    return 1
+
+EXTENSION_EXPORT=[py_name_equals, py_add, py_sub, py_slow_true]
+
+EXTENSION_PURE=[py_slow_true]
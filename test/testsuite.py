@@ -15,7 +15,7 @@
 """
 from testhelpers import *
 from getopt import getopt
-import unittest, inspect, random, os, os.path, shutil, sys, stat, grp, pwd, re
+import unittest, inspect, random, os, os.path, shutil, sys, stat, grp, pwd, re, time, socket
 
 class InvalidArgs(unittest.TestCase):
     def test_invalid_args(self):
@@ -113,10 +113,17 @@ class FileNameAttributes(unittest.TestCase, AssertSearch):
     def test_iname(self):
         self.assert_search(['./test-data', 'iname="*2?m*"'], ["./test-data/00/20M.0", "./test-data/02/20M.2"])
 
+    def test_path(self):
+        self.assert_search(['./test-data', 'path="*/0[12]/*M*"'],
+                           ["./test-data/01/5M.1", "./test-data/02/20M.2", "./test-data/02/5M.2"])
+
+    def test_ipath(self):
+        self.assert_search(['./test-data', 'ipath="./TEST-DATA/00/2*"'], ["./test-data/00/20M.0"])
+
     def test_invalid_values(self):
         t = AttributeTester("./test-data")
 
-        for attr in ["name", "iname"]:
+        for attr in ["name", "iname", "path", "ipath"]:
             t.test_integer(attr)
             t.test_size(attr)
             t.test_time(attr)
@@ -288,6 +295,11 @@ class FileSizeAttribute(unittest.TestCase, AssertSearch):
         t.test_filetype("size")
         t.test_flag("size")
 
+        for expr in ['size > -1k and name="a"', 'size = -1 or name="a"']:
+            for args in [[], ["--respect-ignore-files"]]:
+                returncode, _ = run_executable('efind', ['./test-data', expr] + args)
+                assert(returncode == 1)
+
 class FileGroupAttributes(unittest.TestCase, AssertSearch):
     def test_group(self):
         self.assert_search(['test-data', 'group="%s" and name="*5M*.2"' % run_id("-gn")],
@@ -401,6 +413,14 @@ class FileTypeAttribute(unittest.TestCase, AssertSearch):
         self.assert_search(["./test-links", "type=link"],
                            ["./test-links/00", "./test-links/02"])
 
+    def test_directory_entry_type(self):
+        # the in-process walker tests the type without reading the file status
+        self.assert_search(["./test-data", "type=directory", "--respect-ignore-files"],
+                           ["./test-data", "./test-data/00", "./test-data/01", "./test-data/02"])
+
+        self.assert_search(["./test-links", "type=link", "--respect-ignore-files"],
+                           ["./test-links/00", "./test-links/02"])
+
     def test_block(self):
         self.assert_search(["./test-data", "type=block"], [])
 
@@ -552,6 +572,76 @@ class SearchMultipleDirectories(unittest.TestCase):
 
         assert(returncode == 1)
 
+    def test_starting_points(self):
+        for args in [[], ["--respect-ignore-files"], ["--device-concurrency", "2"]]:
+            returncode, output = run_executable_and_split_output("efind", ["./test-data", "./test-data/02", 'name="1G.2"', "--printf", "%H %P\n"] + args)
+
+            assert(returncode == 0)
+            assert(sorted(output) == ["./test-data 02/1G.2", "./test-data/02 1G.2"])
+
+    def test_newline_in_name(self):
+        os.makedirs("./test-newline/a\nb")
+
+        try:
+            for name in ["a\nb/c\nd", "a\nb/e", "f"]:
+                open(os.path.join("./test-newline", name), "w").close()
+
+            returncode, output = run_executable("efind", ["./test-newline", "./test-data/02", 'type=file and size=0', "--printf", "%H|%P\t"])
+
+            assert(returncode == 0)
+            assert(sorted(output.split("\t")[:-1]) == ["./test-newline|a\nb/c\nd", "./test-newline|a\nb/e", "./test-newline|f"])
+        finally:
+            shutil.rmtree("./test-newline")
+
+    def test_device_concurrency(self):
+        args = ["./test-data/00", "./test-data/01", "./test-data/02", "type=file"]
+        returncode, expected = run_executable_and_split_output("efind", args)
+
+        assert(returncode == 0)
+
+        for concurrency in ["0", "2", "3"]:
+            returncode, output = run_executable_and_split_output("efind", args + ["--device-concurrency", concurrency])
+
+            assert(returncode == 0)
+            assert(sorted(output) == sorted(expected))
+
+        returncode, output = run_executable_and_split_output("efind", args + ["--device-concurrency", "3", "--limit", "5"])
+
+        assert(returncode == 0)
+        assert(len(output) == 5)
+
+        returncode, _ = run_executable("efind", args + ["--device-concurrency", "many"])
+        assert(returncode == 1)
+
+    def test_device_concurrency_index(self):
+        os.makedirs("./test-sched/a")
+        os.makedirs("./test-sched/b")
+
+        try:
+            path = os.path.abspath("./test-sched")
+
+            with open("./test-sched/a/x", "w") as f:
+                f.write("1234")
+
+            open("./test-sched/b/y", "w").close()
+
+            returncode, _ = run_executable("efind", ["--index", "build", path, "--index-file", "./test-sched.index"])
+            assert(returncode == 0)
+
+            os.remove("./test-sched/a/x")
+
+            # found files keep their indexed status when searched by child processes
+            returncode, output = run_executable_and_split_output("efind", [path + "/a", path + "/b", 'type=file', '--printf', '%p %s\n', '--order-by', 's',
+                                                                           '--index', 'query', '--index-file', './test-sched.index', '--device-concurrency', '2'])
+
+            assert(returncode == 0)
+            assert_sequence_equality(output, [path + "/a/x 4", path + "/b/y 0"])
+        finally:
+            shutil.rmtree("./test-sched")
+
+            if os.path.exists("./test-sched.index"):
+                os.remove("./test-sched.index")
+
 class FakeDirTest(unittest.TestCase):
     def __init__(self, name, **kwargs):
         unittest.TestCase.__init__(self, name, **kwargs)
@@ -623,6 +713,7 @@ class ListExtensions(FakeDirTest):
                 '\tefind test extension.',
                 '\tpy_add(integer, integer)',
                 '\tpy_name_equals(string)',
+                '\tpy_slow_true(string)',
                 '\tpy_sub(integer, integer)']
 
     def __build_so_extension_description(self, directory):
@@ -711,13 +802,96 @@ class PythonExtensions(unittest.TestCase, AssertSearch):
     def test_invalid_args(self):
         exprs = ['py_add(5, 1',
                  'py_add(-1, 1)>0 or py_sub("%s")' % random_string(),
-                 'type=file or py_name_equals("%s")' % random_string(),
+                 'type=file or py_name_equals("%s", "%s")' % (random_string(), random_string()),
                  'py_add(1, 2, 3) > py_sub(4, 3)']
 
         for expr in exprs:
             returncode, _ = run_executable('efind', ['./test-data', expr])
             assert(returncode == 1)
 
+    def test_adaptive_order(self):
+        logfile = random_string()
+
+        try:
+            self.assert_search(['./test-data', 'py_slow_true("%s") and py_name_equals("./test-data/02/1G.2")' % logfile],
+                               ["./test-data/02/1G.2"])
+
+            _, files = run_executable_and_split_output("efind", ['./test-data', 'name="*"'])
+
+            with open(logfile) as f:
+                calls = len(f.read().splitlines())
+
+            assert(calls < len(files))
+        finally:
+            os.remove(logfile)
+
+    def test_cache(self):
+        logfile = random_string()
+        cachefile = random_string()
+        folder = random_string()
+
+        try:
+            os.mkdir(folder)
+
+            files = [os.path.join(folder, random_string()) for _ in range(3)]
+
+            for path in files:
+                open(path, "w").close()
+
+            args = [folder, 'type=file and py_slow_true("%s")' % logfile, '--cache-file', cachefile]
+
+            for calls in [len(files), 0]:
+                self.assert_search(args, files)
+
+                with open(logfile, "a+") as f:
+                    f.seek(0)
+                    assert(len(f.read().splitlines()) == calls)
+                    f.truncate(0)
+
+            with open(files[0], "w") as f:
+                f.write(random_string())
+
+            self.assert_search(args, files)
+
+            with open(logfile) as f:
+                assert(f.read().splitlines() == [files[0]])
+
+            # results of a modified module aren't reused
+            module = "./extensions/py-test.py"
+            st = os.stat(module)
+
+            try:
+                os.utime(module, ns=(st.st_atime_ns, st.st_mtime_ns + 1000000000))
+                open(logfile, "w").close()
+
+                self.assert_search(args, files)
+
+                with open(logfile) as f:
+                    assert(len(f.read().splitlines()) == len(files))
+            finally:
+                os.utime(module, ns=(st.st_atime_ns, st.st_mtime_ns))
+        finally:
+            shutil.rmtree(folder, ignore_errors=True)
+
+            for f in [logfile, cachefile]:
+                if os.path.exists(f):
+                    os.remove(f)
+
+    def test_memoization(self):
+        logfile = random_string()
+
+        try:
+            _, files = run_executable_and_split_output("efind", ['./test-data/02', 'name="*"'])
+
+            self.assert_search(['./test-data/02', 'py_slow_true("%s") and (py_slow_true("%s") > 0 or py_add(1, 1) = 2)' % (logfile, logfile)], files)
+
+            with open(logfile) as f:
+                calls = len(f.read().splitlines())
+
+            assert(calls == len(files))
+        finally:
+            os.remove(logfile)
+
     def __list_folder(self, folder):
         return list(map(lambda d: os.path.join(folder, d), os.listdir(folder))) + [folder]
 
@@ -746,13 +920,32 @@ class CExtensions(unittest.TestCase, AssertSearch):
     def test_invalid_args(self):
         exprs = ['c_add(5, 1',
                  'c_add(-1, 1)>0 or c_sub("%s")' % random_string(),
-                 'type=file or c_name_equals("%s")' % random_string(),
+                 'type=file or c_name_equals("%s", "%s")' % (random_string(), random_string()),
                  'c_add(1, 2, 3) > c_sub(4, 3)']
 
         for expr in exprs:
             returncode, _ = run_executable('efind', ['./test-data', expr])
             assert(returncode == 1)
 
+    def test_inflight(self):
+        expr = 'c_add(1, 1) = 2 and c_sub(5, 3) = 2'
+
+        returncode, expected = run_executable_and_split_output('efind', ['./test-data', expr])
+        assert(returncode == 0)
+        assert(len(expected) > 0)
+
+        for inflight in ['2', '4', '16']:
+            returncode, output = run_executable_and_split_output('efind', ['./test-data', expr, '--inflight', inflight])
+            assert(returncode == 0)
+            assert(output == expected)
+
+        returncode, output = run_executable_and_split_output('efind', ['./test-data', 'c_add(1, 1) = 2', '--inflight', '4', '--limit', '3'])
+        assert(returncode == 0)
+        assert(output == expected[:3])
+
+        returncode, _ = run_executable('efind', ['./test-data', expr, '--inflight', '0'])
+        assert(returncode != 0)
+
     def __list_folder(self, folder):
         return list(map(lambda d: os.path.join(folder, d), os.listdir(folder))) + [folder]
 
@@ -966,6 +1159,21 @@ class Printf(unittest.TestCase):
             assert(returncode == 0)
             assert_sequence_equality(efind_output, find_output)
 
+    def test_compare_with_find_in_process(self):
+        # the in-process walker reads only the status fields of the printed attribute
+        find_args = ["./test-data", "-type", "f", "-printf"]
+        efind_args = ["./test-data", "type=file", "--respect-ignore-files", "--printf"]
+
+        for arg in self.__get_comparable_args():
+            returncode, find_output = run_executable_and_split_output("find", find_args + [arg])
+
+            assert(returncode == 0)
+
+            returncode, efind_output = run_executable_and_split_output("efind", efind_args + [arg])
+
+            assert(returncode == 0)
+            assert_sequence_equality(sorted(efind_output), sorted(find_output))
+
     def test_compare_short_and_long_names(self):
         args = ["./test-data", "type=file", "--printf"]
 
@@ -1404,6 +1612,516 @@ class TestRange(unittest.TestCase):
 
             assert(returncode == 1)
 
+class TestOptimizer(unittest.TestCase, AssertSearch):
+    def __print(self, expr):
+        returncode, line = run_executable("efind", ['.', expr, '-p'])
+
+        assert(returncode == 0)
+
+        return line.strip()
+
+    def test_reorder(self):
+        assert(self.__print('user="root" and size > 1 and type=file and name="*.txt"') == "find . -name *.txt -a -type f -a -size +1c -a -user root")
+        assert(self.__print('fs="ext4" or regex=".*" or iname="*.txt"') == "find . -iname *.txt -o -regex .* -o -fstype ext4")
+
+    def test_flatten_and_deduplicate(self):
+        assert(self.__print('name="a" and (name="b" and name="a")') == "find . -name a -a -name b")
+        assert(self.__print('name="a" or (name="b" or (name="c" or name="b"))') == "find . -name a -o -name b -o -name c")
+
+    def test_fold(self):
+        assert(self.__print('not not name="a"') == "find . -name a")
+        assert(self.__print('size >= 0 and name="a"') == "find . -name a")
+        assert(self.__print('size < 0 or name="a"') == "find . -name a")
+
+    def test_search(self):
+        self.assert_search(['./test-data', 'size >= 1M and (type=file and name="*.1")'],
+                           ["./test-data/01/5M.1", "./test-data/01/2G.1"])
+
+class TestPlanner(unittest.TestCase, AssertSearch):
+    def setUp(self):
+        os.environ["EFIND_EXTENSION_PATH"] = "./extensions"
+
+    def tearDown(self):
+        del os.environ["EFIND_EXTENSION_PATH"]
+
+    def test_push_down(self):
+        returncode, line = run_executable("efind", ['.', 'c_add(1, 1) = 2 and type=file and (name="a" or c_sub(1, 1) = 0)', '-p'])
+
+        assert(returncode == 0)
+        assert(line.strip() == "find . -type f")
+
+    def test_mixed_or(self):
+        self.assert_search(['./test-data', 'type=dir or c_name_equals("./test-data/02/20M.2")'],
+                           ["./test-data", "./test-data/00", "./test-data/01", "./test-data/02", "./test-data/02/20M.2"])
+
+        self.assert_search(['./test-data', '(name="*.1" and size>1G) or (c_add(1, 1) = 2 and name="7kb.2")'],
+                           ["./test-data/01/2G.1", "./test-data/02/7kb.2"])
+
+    def test_grouping(self):
+        # chains of conditions are grouped from the left
+        returncode, line = run_executable("efind", ['.', 'type=file and name="a" or name="b"', '-p'])
+
+        assert(returncode == 0)
+        assert(line.strip() == "find . -name b -o -name a -a -type f")
+
+        self.assert_search(['./test-data', 'type=file and name="*.1" or name="0?"'],
+                           ["./test-data/00", "./test-data/01", "./test-data/02",
+                            "./test-data/01/10kb.1", "./test-data/01/15kb.1", "./test-data/01/2G.1",
+                            "./test-data/01/5M.1", "./test-data/01/5b.1"])
+
+        expected = ["./test-data/01/5M.1", "./test-data/01/2G.1"]
+
+        for expr in ['name="*.1" and size>1M or c_add(1, 1) = 3',
+                     'name="*.1" and (size>1M or c_add(1, 1) = 3)',
+                     'name="*.1" and (c_add(1, 1) = 2 and size>1M)']:
+            self.assert_search(['./test-data', expr], expected)
+
+        # function calls following conditions and "and" are grouped from the right
+        self.assert_search(['./test-data', 'name="*.1" and c_add(1, 1) = 3 or c_add(1, 1) = 2'],
+                           ["./test-data/01/10kb.1", "./test-data/01/15kb.1", "./test-data/01/2G.1",
+                            "./test-data/01/5M.1", "./test-data/01/5b.1"])
+
+        # other mixed chains are ambiguous without parentheses
+        for expr in ['type=dir or c_add(1, 1) = 3 and name="*.1"',
+                     'type=dir or name="*.1" and c_add(1, 1) = 3 or size>1M',
+                     'c_add(1, 1) = 3 and name="*.1" or type=dir']:
+            returncode, _ = run_executable('efind', ['./test-data', expr])
+            self.assertNotEqual(returncode, 0)
+
+        self.assert_search(['./test-data', 'type=dir or (c_add(1, 1) = 3 and name="*.1")'],
+                           ["./test-data", "./test-data/00", "./test-data/01", "./test-data/02"])
+
+    def test_conditions(self):
+        exprs = ['name="*.1"',
+                 'iname="*M.2"',
+                 'regex=".*/0[12]/[0-9]+M\.[0-9]"',
+                 'iregex=".*/0[12]/[0-9]+m\.[0-9]"',
+                 'size>1M',
+                 'size<=7k',
+                 'size=0',
+                 'type=dir',
+                 'type=file and not empty',
+                 'empty',
+                 'readable and executable',
+                 'user="%s" and uid=%d' % (pwd.getpwuid(os.getuid()).pw_name, os.getuid()),
+                 'group="%s" or gid=%d' % (grp.getgrgid(os.getgid()).gr_name, os.getgid())]
+
+        for expr in exprs:
+            self.__assert_in_process(['./test-data', expr])
+
+        for regex_type in ["posix-extended", "emacs"]:
+            self.__assert_in_process(['./test-data', 'regex=".*/0[12]/[0-9]+M\.[0-9]"', '--regex-type', regex_type])
+
+    def test_time(self):
+        os.mkdir("./test-planner")
+
+        try:
+            for name, offset in [("a", 90), ("b", 5 * 60 + 30), ("c", 3 * 3600 + 600), ("d", 2 * 86400 + 3600)]:
+                path = os.path.join("./test-planner", name)
+
+                open(path, "w").close()
+
+                st = os.stat(path)
+
+                os.utime(path, (st[stat.ST_ATIME] - offset, st[stat.ST_MTIME] - offset))
+
+            exprs = ['mtime=1 minute', 'mtime<2 minutes', 'mtime>4 minutes', 'mtime=3 hours',
+                     'mtime>=1 day', 'mtime=2 days', 'atime<=5 minutes', 'atime>1 day']
+
+            for expr in exprs:
+                self.__assert_in_process(['./test-planner', 'type=file and (%s)' % expr])
+        finally:
+            shutil.rmtree("./test-planner")
+
+    def test_invalid_conditions(self):
+        exprs = ['user="%s" or c_add(0, 0) = 1' % random_string(),
+                 'size="a" or c_add(0, 0) = 1',
+                 'c_add(0, 0) = 1 or type=1']
+
+        for expr in exprs:
+            returncode, _ = run_executable('efind', ['./test-data', expr])
+            assert(returncode == 1)
+
+    def __assert_in_process(self, args):
+        returncode, expected = run_executable_and_split_output('efind', args)
+
+        assert(returncode == 0)
+
+        args = [args[0], '(%s) or c_add(0, 0) = 1' % args[1]] + args[2:]
+
+        returncode, found = run_executable_and_split_output('efind', args)
+
+        assert(returncode == 0)
+        assert(sorted(found) == sorted(expected))
+
+class TestPrune(unittest.TestCase, AssertSearch):
+    def setUp(self):
+        os.environ["EFIND_EXTENSION_PATH"] = "./extensions"
+
+    def tearDown(self):
+        del os.environ["EFIND_EXTENSION_PATH"]
+
+    def test_translate(self):
+        returncode, line = run_executable("efind", ['.', 'type=file and prune (name="a" or name="b")', '-p'])
+
+        assert(returncode == 0)
+        assert(line.strip() == "find . ! ( ( -name a -o -name b ) -a -prune ) -a -type f")
+
+    def test_prune_conditions(self):
+        self.assert_search(['./test-data', 'prune name="0[01]"'],
+                           ["./test-data", "./test-data/02", "./test-data/02/1G.2", "./test-data/02/20M.2", "./test-data/02/5M.2",
+                            "./test-data/02/5kb.2", "./test-data/02/720b.2", "./test-data/02/7kb.2"])
+
+    def test_prune_functions(self):
+        self.assert_search(['./test-data', 'prune c_name_equals("./test-data/00") and name="*.?" and size>1M'],
+                           ["./test-data/01/5M.1", "./test-data/01/2G.1", "./test-data/02/5M.2", "./test-data/02/20M.2", "./test-data/02/1G.2"])
+
+        self.assert_search(['./test-data', 'prune (c_name_equals("./test-data/00") or name="01") and size>1M', '--max-depth', '2'],
+                           ["./test-data/02/5M.2", "./test-data/02/20M.2", "./test-data/02/1G.2"])
+
+    def test_prune_path(self):
+        returncode, line = run_executable("efind", ['.', 'prune path="*/node_modules" and type=file', '-p'])
+
+        assert(returncode == 0)
+        assert(line.strip() == "find . ! ( -path */node_modules -a -prune ) -a -type f")
+
+        self.assert_search(['./test-data', 'prune (path="./test-data/0[02]" or c_name_equals("./test-data/01/5b.1"))'],
+                           ["./test-data", "./test-data/01", "./test-data/01/10kb.1", "./test-data/01/15kb.1",
+                            "./test-data/01/2G.1", "./test-data/01/5M.1"])
+
+    def test_invalid_prune(self):
+        for expr in ['type=file or prune name="a"', 'not prune name="a"', 'prune prune name="a"']:
+            returncode, _ = run_executable('efind', ['./test-data', expr])
+            assert(returncode == 1)
+
+class TestIgnoreFiles(unittest.TestCase, AssertSearch):
+    def test_respect_ignore_files(self):
+        os.makedirs("./test-ignore/src/sub")
+        os.mkdir("./test-ignore/build")
+        os.makedirs("./test-ignore/.git/objects")
+
+        try:
+            for name in ["src/a.c", "src/a.o", "src/sub/b.c", "src/sub/keep.o", "src/notes.tmp", "build/x.c", ".git/objects/y.c"]:
+                open(os.path.join("./test-ignore", name), "w").close()
+
+            with open("./test-ignore/.gitignore", "w") as f:
+                f.write("# build output\nbuild/\n*.o\n")
+
+            with open("./test-ignore/src/sub/.gitignore", "w") as f:
+                f.write("!keep.o\n")
+
+            with open("./test-ignore/.ignore", "w") as f:
+                f.write("**/*.tmp\n")
+
+            self.assert_search(['./test-ignore', 'name="*.?"', '--respect-ignore-files'],
+                               ["./test-ignore/src/a.c", "./test-ignore/src/sub/b.c", "./test-ignore/src/sub/keep.o"])
+
+            self.assert_search(['./test-ignore', 'name="*.c"', '--respect-ignore-files=no'],
+                               ["./test-ignore/src/a.c", "./test-ignore/src/sub/b.c", "./test-ignore/build/x.c", "./test-ignore/.git/objects/y.c"])
+        finally:
+            shutil.rmtree("./test-ignore")
+
+class TestFilesystems(unittest.TestCase, AssertSearch):
+    def test_filesystems(self):
+        returncode, line = run_executable("efind", ['.', 'type=file', '--one-file-system', '--skip-fs-types', 'proc,nfs', '-p'])
+
+        assert(returncode == 0)
+        assert(line.strip() == "find . -xdev ! ( ( -fstype proc -o -fstype nfs ) -a -prune ) -a -type f")
+
+        self.assert_search(['./test-data', 'name="*.2"', '--one-file-system', '--skip-fs-types', 'proc', '--respect-ignore-files'],
+                           ["./test-data/02/1G.2", "./test-data/02/20M.2", "./test-data/02/5M.2",
+                            "./test-data/02/5kb.2", "./test-data/02/720b.2", "./test-data/02/7kb.2"])
+
+class TestInodeOrder(unittest.TestCase, AssertSearch):
+    def test_inode_order(self):
+        for order in ["auto", "yes", "no"]:
+            self.assert_search(['./test-data', 'type=file and size>5 and size<1000', '--respect-ignore-files', '--inode-order', order],
+                               ["./test-data/00/100b.0", "./test-data/02/720b.2"])
+
+        returncode, _ = run_executable('efind', ['./test-data', 'type=file', '--inode-order', 'sometimes'])
+        assert(returncode == 1)
+
+class TestIOOptions(unittest.TestCase, AssertSearch):
+    def test_io_options(self):
+        expected = ["./test-data/00/100b.0", "./test-data/02/720b.2"]
+
+        for args in [["--io-rate", "1000"], ["--io-rate", "1000", "--respect-ignore-files"], ["--max-inflight", "1"],
+                     ["--io-class", "idle"], ["--io-class", "best-effort"]]:
+            self.assert_search(['./test-data', 'type=file and size>5 and size<1000'] + args, expected)
+
+        # directories are read at the limited rate even if no file matches, reading
+        # test-data at 20 operations per second takes about one second
+        start = time.time()
+
+        self.assert_search(['./test-data', 'name="%s"' % random_string(), '--io-rate', '20'], [])
+
+        assert(time.time() - start >= 0.25)
+
+        for args in [["--io-rate", "-1"],["--max-inflight", "0"], ["--io-class", "realtime"]]:
+            returncode, _ = run_executable('efind', ['./test-data', 'type=file'] + args)
+            assert(returncode == 1)
+
+class TestTimeout(unittest.TestCase, AssertSearch):
+    def test_timeout(self):
+        expected = ["./test-data/00/100b.0", "./test-data/02/720b.2"]
+
+        for args in [["--timeout", "1h"], ["--timeout", "90s", "--respect-ignore-files"]]:
+            self.assert_search(['./test-data', 'type=file and size>5 and size<1000'] + args, expected)
+
+        for args in [[], ["--respect-ignore-files"]]:
+            start = time.time()
+            returncode, output = run_executable('efind', ['./test-data', 'type=file', '--timeout', '100ms', '--io-rate', '1'] + args)
+            assert(returncode == 124)
+            assert(output == "")
+
+            # the rate limit doesn't delay the search beyond the deadline, reading
+            # test-data at one operation per second would take more than 20 seconds
+            assert(time.time() - start < 10)
+
+        for value in ["soon", "0", "-1s", "1d"]:
+            returncode, _ = run_executable('efind', ['./test-data', 'type=file', '--timeout', value])
+            assert(returncode == 1)
+
+class TestClosedOutput(unittest.TestCase):
+    def test_closed_output(self):
+        for args in [[], ["--respect-ignore-files"], ["--device-concurrency", "2"], ["--printf", "%p %s\n"]]:
+            proc = subprocess.Popen(["efind", "./test-data", "type=file"] + args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+
+            assert(proc.stdout.readline())
+
+            proc.stdout.close()
+
+            assert(proc.wait(timeout=10) == 0)
+            assert(proc.stderr.read() == b"")
+
+            proc.stderr.close()
+
+    def test_closed_output_idle_find(self):
+        # find stays alive without writing anything after its results
+        os.makedirs("./fake-find", exist_ok=True)
+
+        with open("./fake-find/find", "w") as f:
+            f.write('#!/bin/sh\n%s "$@"\nexec %s 60\n' % (shutil.which("find"), shutil.which("sleep")))
+
+        os.chmod("./fake-find/find", 0o755)
+
+        env = dict(os.environ, PATH=os.path.abspath("./fake-find") + os.pathsep + os.environ["PATH"])
+        proc = subprocess.Popen(["efind", "./test-data", "type=file"], stdout=subprocess.PIPE, stderr=subprocess.PIPE, env=env)
+
+        try:
+            # efind buffers its output, give it time to read the results of find
+            time.sleep(0.5)
+
+            proc.stdout.close()
+
+            assert(proc.wait(timeout=30) == 0)
+            assert(proc.stderr.read() == b"")
+        finally:
+            if proc.poll() is None:
+                proc.kill()
+                proc.wait()
+
+            proc.stderr.close()
+            shutil.rmtree("./fake-find")
+
+class TestIndex(unittest.TestCase, AssertSearch):
+    def setUp(self):
+        returncode, _ = run_executable("efind", ["--index", "build", "./test-data", "--index-file", "./test-index"])
+
+        assert(returncode == 0)
+
+    def tearDown(self):
+        os.remove("./test-index")
+
+    def test_query(self):
+        for expr in ['type=file and size>5k', 'name="*.1" or type=dir', 'prune name="01" and mtime<1 day']:
+            for path in ["./test-data", "./test-data/02/"]:
+                returncode, expected = run_executable_and_split_output("efind", [path, expr, "--printf", "%p %s %m\n"])
+
+                assert(returncode == 0)
+
+                self.assert_search([path, expr, "--printf", "%p %s %m\n", "--index", "query", "--index-file", "./test-index"], expected)
+
+    def test_max_depth(self):
+        self.assert_search(['./test-data', 'type=dir', '--max-depth', '1', '--index', 'query', '--index-file', './test-index'],
+                           ["./test-data", "./test-data/00", "./test-data/01", "./test-data/02"])
+
+    def test_refresh(self):
+        os.makedirs("./test-refresh/a")
+
+        try:
+            path = os.path.abspath("./test-refresh")
+
+            open("./test-refresh/a/x", "w").close()
+
+            returncode, _ = run_executable("efind", ["--index", "build", "./test-refresh", "--index-file", "./test-index"])
+            assert(returncode == 0)
+
+            with open("./test-refresh/a/x", "w") as f:
+                f.write("1234")
+
+            os.mkdir("./test-refresh/b")
+            open("./test-refresh/b/y", "w").close()
+
+            returncode, _ = run_executable("efind", ["--index", "refresh", "--index-file", "./test-index"])
+            assert(returncode == 0)
+
+            self.assert_search([path, 'type=file', '--printf', '%p %s\n', '--index', 'query', '--index-file', './test-index'],
+                               [path + "/a/x 0", path + "/b/y 0"])
+
+            returncode, _ = run_executable("efind", ["--index", "refresh", "--deep-scan", "--index-file", "./test-index"])
+            assert(returncode == 0)
+
+            self.assert_search([path, 'type=file', '--printf', '%p %s\n', '--index', 'query', '--index-file', './test-index'],
+                               [path + "/a/x 4", path + "/b/y 0"])
+        finally:
+            shutil.rmtree("./test-refresh")
+
+    def test_daemon(self):
+        os.makedirs("./test-daemon/a")
+
+        daemon = None
+
+        try:
+            path = os.path.abspath("./test-daemon")
+
+            open("./test-daemon/a/x", "w").close()
+
+            returncode, _ = run_executable("efind", ["--index", "build", "./test-daemon", "--index-file", "./test-index"])
+            assert(returncode == 0)
+
+            daemon = subprocess.Popen(["efind", "--index", "daemon", "--index-file", "./test-index", "--socket", "./test-socket"])
+
+            for _ in range(50):
+                if os.path.exists("./test-socket"):
+                    break
+
+                time.sleep(0.1)
+
+            self.assert_search([path, 'type=file', '--connect', '--socket', './test-socket'], [path + "/a/x"])
+
+            os.makedirs("./test-daemon/b/c")
+            open("./test-daemon/b/c/y", "w").close()
+            os.remove("./test-daemon/a/x")
+
+            time.sleep(1.5)
+
+            self.assert_search([path, 'type=file', '--connect', '--socket', './test-socket'], [path + "/b/c/y"])
+
+            returncode, _ = run_executable("efind", ["--index", "build", "--connect", "--socket", "./test-socket"])
+            assert(returncode == 1)
+        finally:
+            if daemon:
+                daemon.terminate()
+                daemon.wait()
+
+            shutil.rmtree("./test-daemon")
+
+        assert(not os.path.exists("./test-socket"))
+
+    def test_invalid_index(self):
+        returncode, _ = run_executable("efind", ["./test-data", "type=file", "--index", "query", "--index-file", "./test-data/00/1M.0"])
+        assert(returncode == 1)
+
+        returncode, _ = run_executable("efind", ["./test-data", "type=file", "--index", random_string()])
+        assert(returncode == 1)
+
+class TestResultCache(unittest.TestCase, AssertSearch):
+    def setUp(self):
+        os.makedirs("./test-results/a/b")
+
+        open("./test-results/a/x.c", "w").close()
+        open("./test-results/a/b/y.c", "w").close()
+        open("./test-results/z.h", "w").close()
+
+    def tearDown(self):
+        shutil.rmtree("./test-results")
+        shutil.rmtree("./test-result-cache", ignore_errors=True)
+
+    def test_search(self):
+        for expr in ['type=file and size>5k', 'prune name="01" and type=dir']:
+            returncode, expected = run_executable_and_split_output("efind", ["./test-data", expr])
+
+            assert(returncode == 0)
+
+            for _ in range(2):
+                self.assert_search(["./test-data", expr, "--result-cache", "./test-result-cache"], expected)
+
+    def test_changed_dirs(self):
+        args = ["./test-results", 'name="*.c"', "--result-cache", "./test-result-cache"]
+
+        self.assert_search(args, ["./test-results/a/x.c", "./test-results/a/b/y.c"])
+
+        os.remove("./test-results/a/x.c")
+        os.makedirs("./test-results/c")
+        open("./test-results/c/w.c", "w").close()
+        open("./test-results/a/b/v.c", "w").close()
+
+        self.assert_search(args, ["./test-results/a/b/y.c", "./test-results/a/b/v.c", "./test-results/c/w.c"])
+
+    def test_time_conditions(self):
+        args = ["./test-results", 'name="*.c" and mtime<1 day', "--result-cache", "./test-result-cache"]
+
+        self.assert_search(args, ["./test-results/a/x.c", "./test-results/a/b/y.c"])
+
+        # changing the modification time of a file doesn't change its directory
+        old = time.time() - 3 * 86400
+        os.utime("./test-results/a/x.c", (old, old))
+
+        self.assert_search(args, ["./test-results/a/b/y.c"])
+
+class TestServer(unittest.TestCase, AssertSearch):
+    def setUp(self):
+        self.__server = subprocess.Popen(["efind", "--serve", "./test-socket"])
+
+        for _ in range(50):
+            if os.path.exists("./test-socket"):
+                break
+
+            time.sleep(0.1)
+
+    def tearDown(self):
+        self.__server.terminate()
+        self.__server.wait()
+
+        assert(not os.path.exists("./test-socket"))
+
+    def test_search(self):
+        for expr in ['type=file and size>5k', 'name="*.1" or type=dir']:
+            returncode, expected = run_executable_and_split_output("efind", ["./test-data", expr, "--printf", "%p %s %u %F\n"])
+
+            assert(returncode == 0)
+
+            self.assert_search(["./test-data", expr, "--printf", "%p %s %u %F\n", "--connect", "--socket", "./test-socket"], expected)
+
+    def test_unsupported_action(self):
+        returncode, _ = run_executable("efind", ["--print-extensions", "--connect", "--socket", "./test-socket"])
+        assert(returncode == 1)
+
+    def test_socket_in_use(self):
+        returncode, _ = run_executable("efind", ["--serve", "./test-socket"])
+        assert(returncode == 1)
+
+        returncode, expected = run_executable_and_split_output("efind", ["./test-data", "type=dir"])
+
+        assert(returncode == 0)
+
+        self.assert_search(["./test-data", "type=dir", "--connect", "--socket", "./test-socket"], expected)
+
+    def test_idle_client(self):
+        returncode, expected = run_executable_and_split_output("efind", ["./test-data", "type=dir"])
+
+        assert(returncode == 0)
+
+        # a client that doesn't send its request doesn't block other clients
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as client:
+            client.connect("./test-socket")
+
+            proc = subprocess.run(["efind", "./test-data", "type=dir", "--connect", "--socket", "./test-socket"], stdout=subprocess.PIPE, timeout=30)
+
+            assert(proc.returncode == 0)
+            assert_sequence_equality(proc.stdout.decode("utf-8").split("\n")[:-1], expected)
+
 class TestINI(unittest.TestCase):
     def setUp(self):
         self.__home = os.environ["HOME"]
@@ -1654,6 +2372,66 @@ class TestExec(unittest.TestCase):
 
         assert(returncode == 0)
 
+class TestTee(unittest.TestCase):
+    def setUp(self):
+        self.__files = [random_string() for _ in range(2)]
+
+    def tearDown(self):
+        for f in self.__files:
+            if os.path.exists(f):
+                os.remove(f)
+
+    def __read_lines(self, filename):
+        with open(filename) as f:
+            return f.read().splitlines()
+
+    def test_output(self):
+        _, expected = run_executable_and_split_output("efind", ['./test-data', 'type=file'])
+
+        returncode, output = run_executable_and_split_output("efind", ['./test-data', 'type=file', '--output', self.__files[0]])
+
+        assert(returncode == 0)
+        assert(output == [])
+        assert(self.__read_lines(self.__files[0]) == expected)
+
+    def test_multiple_branches(self):
+        _, paths = run_executable_and_split_output("efind", ['./test-data', 'type=file'])
+        _, names = run_executable_and_split_output("efind", ['./test-data', 'type=file', '--printf', '%f\n'])
+
+        returncode, output = run_executable_and_split_output("efind", ['./test-data', 'type=file',
+                                                                       '--output', self.__files[0],
+                                                                       '--tee', '--printf', '%f\n', '--output', self.__files[1],
+                                                                       '--tee', '--exec', 'echo', '%{path}', ';'])
+
+        assert(returncode == 0)
+        assert(sorted(output) == sorted(paths))
+        assert(self.__read_lines(self.__files[0]) == paths)
+        assert(self.__read_lines(self.__files[1]) == names)
+
+    def test_tee_argument(self):
+        _, paths = run_executable_and_split_output("efind", ['./test-data', 'type=file'])
+
+        # "--tee" is the argument of --printf and doesn't start a branch
+        returncode, output = run_executable_and_split_output("efind", ['./test-data', 'type=file', '--printf', '--tee',
+                                                                       '--output', self.__files[0]])
+
+        assert(returncode == 0)
+        assert(output == [])
+        assert(self.__read_lines(self.__files[0]) == ["--tee" * len(paths)])
+
+    def test_limit(self):
+        returncode, output = run_executable_and_split_output("efind", ['./test-data', 'type=file', '--limit', '1',
+                                                                       '--tee', '--output', self.__files[0]])
+
+        assert(returncode == 0)
+        assert(len(output) == 1)
+        assert(self.__read_lines(self.__files[0]) == output)
+
+    def test_invalid_output(self):
+        returncode, _ = run_executable("efind", ['./test-data', 'type=file', '--output', os.path.join(random_string(), random_string())])
+
+        assert(returncode != 0)
+
 class TestQuoteCharacters(unittest.TestCase):
     def test_single_quote(self):
         returncode, _ = run_executable("efind", ['./test-data', "name='*.txt'"])
@@ -302,6 +302,14 @@ _property_to_str(PropertyId id)
 			name = "filesystem";
 			break;
 
+		case PROP_PATH:
+			name = "path";
+			break;
+
+		case PROP_IPATH:
+			name = "ipath";
+			break;
+
 		default:
 			FATALF("translate", "Invalid property id: %#x", id);
 	}
@@ -372,6 +380,14 @@ _property_to_arg(PropertyId id, int arg)
 			name = "-fstype";
 			break;
 
+		case PROP_PATH:
+			name = "-path";
+			break;
+
+		case PROP_IPATH:
+			name = "-ipath";
+			break;
+
 		default:
 			FATALF("translate", "Invalid property id: %#x", id);
 	}
@@ -463,7 +479,7 @@ _property_supports_string(PropertyId prop)
 {
 	return prop == PROP_NAME || prop == PROP_INAME || prop == PROP_REGEX ||
 	               prop == PROP_IREGEX || prop == PROP_GROUP || prop == PROP_USER ||
-	               prop == PROP_FILESYSTEM;
+	               prop == PROP_FILESYSTEM || prop == PROP_PATH || prop == PROP_IPATH;
 }
 
 static bool
@@ -508,6 +524,22 @@ _test_property(TranslationCtx *ctx, const ConditionNode *node, bool (*test_prope
 	return true;
 }
 
+static bool
+_test_size(TranslationCtx *ctx, const ConditionNode *node, int val)
+{
+	assert(ctx != NULL);
+	assert(node != NULL);
+
+	if(val < 0)
+	{
+		_set_error(ctx, (Node *)node, _("File sizes cannot be negative."));
+
+		return false;
+	}
+
+	return true;
+}
+
 static bool
 _append_numeric_cond_arg(TranslationCtx *ctx, const char *arg, CompareType cmp, int64_t val, const char *suffix)
 {
@@ -826,7 +858,8 @@ _process_condition(TranslationCtx *ctx, ConditionNode *node)
 				}
 				else if(_property_supports_size(node->prop))
 				{
-					success = _append_size_cond(ctx, node->prop, node->cmp, node->value->value.ivalue, UNIT_BYTES);
+					success = _test_size(ctx, node, node->value->value.ivalue)
+					          && _append_size_cond(ctx, node->prop, node->cmp, node->value->value.ivalue, UNIT_BYTES);
 				}
 				else
 				{
@@ -852,7 +885,8 @@ _process_condition(TranslationCtx *ctx, ConditionNode *node)
 		case VALUE_SIZE:
 			if((success = _test_property(ctx, node, &_property_supports_size, "size")))
 			{
-				success = _append_size_cond(ctx, node->prop, node->cmp, node->value->value.pair.a, node->value->value.pair.b);
+				success = _test_size(ctx, node, node->value->value.pair.a)
+				          && _append_size_cond(ctx, node->prop, node->cmp, node->value->value.pair.a, node->value->value.pair.b);
 			}
 			break;
 
@@ -909,6 +943,39 @@ _process_not(TranslationCtx *ctx, NotNode *node)
 	return success;
 }
 
+static bool
+_process_prune(TranslationCtx *ctx, PruneNode *node)
+{
+	bool success = false;
+
+	assert(ctx != NULL);
+	assert(node != NULL);
+
+	const char *lparen = QUOTE_ARGS(ctx) ? "\\(" : "(";
+	const char *rparen = QUOTE_ARGS(ctx) ? "\\)" : ")";
+	bool open = node->expr->type == NODE_EXPRESSION && ((ExpressionNode *)node->expr)->op == OP_OR;
+
+	if(_translation_ctx_append_args(ctx, "!", lparen, NULL_CHARPTR))
+	{
+		if(open)
+		{
+			_translation_ctx_append_arg(ctx, lparen);
+		}
+
+		if((success = _process_node(ctx, node->expr)))
+		{
+			if(open)
+			{
+				_translation_ctx_append_arg(ctx, rparen);
+			}
+
+			success = _translation_ctx_append_args(ctx, "-a", "-prune", rparen, NULL_CHARPTR);
+		}
+	}
+
+	return success;
+}
+
 static bool
 _process_node(TranslationCtx *ctx, Node *node)
 {
@@ -933,6 +1000,14 @@ _process_node(TranslationCtx *ctx, Node *node)
 		{
 			return _process_not(ctx, (NotNode *)node);
 		}
+		else if(node->type == NODE_PRUNE)
+		{
+			return _process_prune(ctx, (PruneNode *)node);
+		}
+		else if(node->type == NODE_TRUE)
+		{
+			return _translation_ctx_append_arg(ctx, "-true");
+		}
 		else
 		{
 			FATALF("translate", "Unsupported node type: %#x", node->type);
@@ -406,3 +406,46 @@ utils_parse_bool(const char *value, bool *dst)
 	return success;
 }
 
+bool
+utils_parse_duration(const char *value, int64_t *dst)
+{
+	bool success = false;
+
+	assert(value != NULL);
+	assert(dst != NULL);
+
+	if(value)
+	{
+		char *tail = NULL;
+		long long v = strtoll(value, &tail, 10);
+		long long factor = 0;
+
+		if(tail != value)
+		{
+			if(*tail == '\0' || !strcmp(tail, "s"))
+			{
+				factor = 1000;
+			}
+			else if(!strcmp(tail, "ms"))
+			{
+				factor = 1;
+			}
+			else if(!strcmp(tail, "m"))
+			{
+				factor = 60 * 1000;
+			}
+			else if(!strcmp(tail, "h"))
+			{
+				factor = 60 * 60 * 1000;
+			}
+		}
+
+		if(factor && v > 0 && v <= INT64_MAX / factor)
+		{
+			*dst = (int64_t)(v * factor);
+			success = true;
+		}
+	}
+
+	return success;
+}
@@ -24,6 +24,7 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdarg.h>
 
 /**
@@ -179,5 +180,15 @@ bool utils_parse_integer(const char *value, long int min, long int max, long int
  */
 bool utils_parse_bool(const char *value, bool *dst);
 
+/**
+   @param value string to parse
+   @param dst location to write the duration in milliseconds to
+   @return true on success
+
+   Tries to convert a positive duration to milliseconds. The number may be
+   followed by a unit (`ms', `s', `m' or `h'), seconds are assumed otherwise.
+ */
+bool utils_parse_duration(const char *value, int64_t *dst);
+
 #endif
 
@@ -0,0 +1,694 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file walk.c
+   @brief Walk directory trees in-process.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+/*! @cond INTERNAL */
+#define _GNU_SOURCE
+/*! @endcond */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <assert.h>
+
+#include "walk.h"
+#include "ignorefile.h"
+#include "fs.h"
+#include "linux.h"
+#include "stat-batch.h"
+#include "utils.h"
+#include "log.h"
+
+/*! @cond INTERNAL */
+#define WALK_STAT_BATCH_SIZE 256
+#define WALK_STAT_BATCH_DEPTH 64
+
+typedef struct
+{
+	char *name;
+	unsigned char type;
+	ino_t ino;
+} WalkDirent;
+
+struct _WalkListing
+{
+	WalkDirent *entries;
+	size_t count;
+	size_t size;
+};
+
+typedef struct
+{
+	dev_t dev;
+	ino_t ino;
+} WalkAncestor;
+
+typedef struct
+{
+	const WalkOptions *opts;
+	WalkCallback cb;
+	WalkErrorCallback err;
+	void *user_data;
+	char path[PATH_MAX];
+	size_t len;
+	WalkAncestor *ancestors;
+	size_t ancestors_count;
+	size_t ancestors_size;
+	IgnoreRules *ignore_rules;
+	FSMap *fsmap;
+	StatBatch *batch;
+	size_t batch_size;
+	dev_t rotational_dev;
+	bool rotational;
+	bool rotational_known;
+	dev_t root_dev;
+	bool need_dev;
+	bool failed;
+	bool stop;
+} WalkCtx;
+/*! @endcond */
+
+static void
+_walk_fail(WalkCtx *ctx, int errnum)
+{
+	assert(ctx != NULL);
+
+	TRACEF("walk", "Couldn't access `%s', errno=%d.", ctx->path, errnum);
+
+	if(ctx->err)
+	{
+		ctx->err(ctx->path, errnum, ctx->user_data);
+	}
+
+	ctx->failed = true;
+}
+
+static bool
+_walk_stat(WalkCtx *ctx, unsigned char type, const struct statx *stx, mode_t *mode, struct stat *st)
+{
+	bool success = true;
+
+	assert(ctx != NULL);
+	assert(mode != NULL);
+	assert(st != NULL);
+
+	*mode = 0;
+
+	if(stx && (!ctx->opts->follow || !S_ISLNK(stx->stx_mode)))
+	{
+		/* the status has already been read in batch */
+		st->st_mode = stx->stx_mode;
+		st->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+		st->st_ino = stx->stx_ino;
+
+		*mode = stx->stx_mode & S_IFMT;
+	}
+	else if(ctx->opts->follow && (type == DT_DIR || type == DT_LNK || type == DT_UNKNOWN))
+	{
+		if(!stat(ctx->path, st))
+		{
+			*mode = st->st_mode & S_IFMT;
+		}
+		else if(errno != ENOENT || lstat(ctx->path, st))
+		{
+			_walk_fail(ctx, errno);
+			success = false;
+		}
+		else
+		{
+			*mode = st->st_mode & S_IFMT;
+		}
+	}
+	else if(type == DT_UNKNOWN || (ctx->need_dev && type == DT_DIR))
+	{
+		if(!lstat(ctx->path, st))
+		{
+			*mode = st->st_mode & S_IFMT;
+		}
+		else
+		{
+			_walk_fail(ctx, errno);
+			success = false;
+		}
+	}
+	else
+	{
+		/* d_type is sufficient, the file's status isn't read */
+		*mode = DTTOIF(type);
+	}
+
+	return success;
+}
+
+static bool
+_walk_push_ancestor(WalkCtx *ctx, const struct stat *st)
+{
+	bool loop = false;
+
+	assert(ctx != NULL);
+	assert(st != NULL);
+
+	for(size_t i = 0; i < ctx->ancestors_count && !loop; ++i)
+	{
+		loop = ctx->ancestors[i].dev == st->st_dev && ctx->ancestors[i].ino == st->st_ino;
+	}
+
+	if(loop)
+	{
+		_walk_fail(ctx, ELOOP);
+	}
+	else
+	{
+		if(ctx->ancestors_count == ctx->ancestors_size)
+		{
+			ctx->ancestors_size = ctx->ancestors_size ? ctx->ancestors_size * 2 : 16;
+
+			if(ctx->ancestors)
+			{
+				ctx->ancestors = utils_renew(ctx->ancestors, ctx->ancestors_size, WalkAncestor);
+			}
+			else
+			{
+				ctx->ancestors = utils_new(ctx->ancestors_size, WalkAncestor);
+			}
+		}
+
+		ctx->ancestors[ctx->ancestors_count].dev = st->st_dev;
+		ctx->ancestors[ctx->ancestors_count].ino = st->st_ino;
+		++ctx->ancestors_count;
+	}
+
+	return !loop;
+}
+
+static void
+_walk_listing_add(WalkListing *listing, const char *name, unsigned char type, ino_t ino)
+{
+	assert(listing != NULL);
+	assert(name != NULL);
+
+	if(listing->count == listing->size)
+	{
+		listing->size = listing->size ? listing->size * 2 : 16;
+
+		if(listing->entries)
+		{
+			listing->entries = utils_renew(listing->entries, listing->size, WalkDirent);
+		}
+		else
+		{
+			listing->entries = utils_new(listing->size, WalkDirent);
+		}
+	}
+
+	listing->entries[listing->count].name = utils_strdup(name);
+	listing->entries[listing->count].type = type;
+	listing->entries[listing->count].ino = ino;
+	++listing->count;
+}
+
+void
+walk_listing_append(WalkListing *listing, const char *name, unsigned char type)
+{
+	_walk_listing_add(listing, name, type, 0);
+}
+
+static void
+_walk_listing_clear(WalkListing *listing)
+{
+	assert(listing != NULL);
+
+	for(size_t i = 0; i < listing->count; ++i)
+	{
+		free(listing->entries[i].name);
+	}
+
+	free(listing->entries);
+	memset(listing, 0, sizeof(WalkListing));
+}
+
+static int
+_walk_compare_inodes(const void *a, const void *b)
+{
+	ino_t ino_a = ((const WalkDirent *)a)->ino;
+	ino_t ino_b = ((const WalkDirent *)b)->ino;
+
+	return (ino_a > ino_b) - (ino_a < ino_b);
+}
+
+static bool
+_walk_reads_status(const WalkCtx *ctx, const WalkListing *listing)
+{
+	bool reads = ctx->opts->stat_mask || ctx->opts->follow || ctx->need_dev;
+
+	for(size_t i = 0; i < listing->count && !reads; ++i)
+	{
+		reads = listing->entries[i].type == DT_UNKNOWN;
+	}
+
+	return reads;
+}
+
+static bool
+_walk_sort_by_inode(WalkCtx *ctx, DIR *dir, const WalkListing *listing)
+{
+	bool sort = false;
+
+	assert(ctx != NULL);
+	assert(dir != NULL);
+	assert(listing != NULL);
+
+	if(listing->count > 1)
+	{
+		if(ctx->opts->inode_order == WALK_INODE_ORDER_YES)
+		{
+			sort = true;
+		}
+		else if(ctx->opts->inode_order == WALK_INODE_ORDER_AUTO && _walk_reads_status(ctx, listing))
+		{
+			struct stat st;
+
+			if(!fstat(dirfd(dir), &st))
+			{
+				if(!ctx->rotational_known || ctx->rotational_dev != st.st_dev)
+				{
+					ctx->rotational = linux_dev_is_rotational(st.st_dev);
+					ctx->rotational_dev = st.st_dev;
+					ctx->rotational_known = true;
+				}
+
+				sort = ctx->rotational;
+			}
+		}
+	}
+
+	return sort;
+}
+
+static bool
+_walk_acquire(WalkCtx *ctx, unsigned int tokens)
+{
+	assert(ctx != NULL);
+
+	if(!rate_limit_acquire(ctx->opts->rate_limit, tokens))
+	{
+		TRACE("walk", "Deadline of rate limit reached, walk stopped.");
+		ctx->stop = true;
+	}
+
+	return !ctx->stop;
+}
+
+static void
+_walk_read_dir(WalkCtx *ctx, WalkListing *listing)
+{
+	DIR *dir;
+
+	assert(ctx != NULL);
+	assert(listing != NULL);
+
+	if(ctx->opts->list && ctx->opts->list(ctx->path, listing, ctx->user_data))
+	{
+		TRACEF("walk", "Using cached entries of directory `%s'.", ctx->path);
+	}
+	else
+	{
+		_walk_listing_clear(listing);
+
+		if(!_walk_acquire(ctx, 1))
+		{
+			DEBUGF("walk", "Directory `%s' not read.", ctx->path);
+		}
+		else if((dir = opendir(ctx->path)))
+		{
+			struct dirent *ent;
+
+			errno = 0;
+
+			while((ent = readdir(dir)))
+			{
+				if(strcmp(ent->d_name, ".") && strcmp(ent->d_name, ".."))
+				{
+					_walk_listing_add(listing, ent->d_name, ent->d_type, ent->d_ino);
+				}
+
+				errno = 0;
+			}
+
+			if(errno)
+			{
+				_walk_fail(ctx, errno);
+			}
+
+			/* file status is read in inode order to reduce disk seeks */
+			if(_walk_sort_by_inode(ctx, dir, listing))
+			{
+				TRACEF("walk", "Sorting entries of directory `%s' by inode number.", ctx->path);
+				qsort(listing->entries, listing->count, sizeof(WalkDirent), _walk_compare_inodes);
+			}
+
+			closedir(dir);
+		}
+		else
+		{
+			_walk_fail(ctx, errno);
+		}
+	}
+}
+
+static bool
+_walk_queue_stat(WalkCtx *ctx)
+{
+	bool queue = false;
+	struct stat st;
+
+	assert(ctx != NULL);
+
+	/* local filesystems answer from the inode cache, the status of their files
+	   is read on demand */
+	if(ctx->opts->stat_mask && !(ctx->opts->follow ? stat(ctx->path, &st) : lstat(ctx->path, &st)))
+	{
+		FSMap *fsmap = fs_map_get_default();
+		const char *fs = fsmap ? fs_map_dev(fsmap, st.st_dev) : NULL;
+
+		if(fs && fs_is_remote(fs))
+		{
+			TRACEF("walk", "Reading file status of `%s' (%s) in batches.", ctx->path, fs);
+
+			if(!ctx->batch)
+			{
+				unsigned int depth = WALK_STAT_BATCH_DEPTH;
+
+				if(ctx->opts->max_inflight && ctx->opts->max_inflight < depth)
+				{
+					depth = ctx->opts->max_inflight;
+				}
+
+				ctx->batch = stat_batch_new(depth);
+			}
+
+			queue = true;
+		}
+	}
+
+	return queue;
+}
+
+static bool
+_walk_stat_batch(WalkCtx *ctx, const WalkDirent *entries, size_t count, StatRequest *requests)
+{
+	bool success = false;
+
+	assert(ctx != NULL);
+	assert(ctx->batch != NULL);
+	assert(entries != NULL);
+	assert(requests != NULL);
+
+	int fd = open(ctx->path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+
+	if(fd != -1)
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			requests[i].name = entries[i].name;
+		}
+
+		/* the walker needs file type, device & inode number itself */
+		stat_batch_run(ctx->batch, fd, requests, count, ctx->opts->stat_mask | STATX_TYPE | STATX_INO);
+		close(fd);
+
+		success = true;
+	}
+	else
+	{
+		DEBUGF("walk", "Couldn't open directory `%s' to read file status: %s", ctx->path, strerror(errno));
+	}
+
+	return success;
+}
+
+static bool
+_walk_enter_filesystem(WalkCtx *ctx, const struct stat *st, bool *descend)
+{
+	bool visit = true;
+
+	assert(ctx != NULL);
+	assert(st != NULL);
+	assert(descend != NULL);
+
+	*descend = true;
+
+	if(ctx->fsmap)
+	{
+		const char *fs = fs_map_dev(ctx->fsmap, st->st_dev);
+
+		if(!fs)
+		{
+			fs = fs_map_path(ctx->fsmap, ctx->path);
+		}
+
+		if(fs_list_contains(ctx->opts->skip_fs_types, fs))
+		{
+			DEBUGF("walk", "Skipping mountpoint `%s' (filesystem: %s).", ctx->path, fs);
+			visit = false;
+		}
+	}
+
+	if(visit && ctx->opts->one_file_system && st->st_dev != ctx->root_dev)
+	{
+		DEBUGF("walk", "Not descending mountpoint `%s'.", ctx->path);
+		*descend = false;
+	}
+
+	return visit;
+}
+
+static void _walk_visit(WalkCtx *ctx, int32_t depth, mode_t mode, const struct statx *stx, bool descend, const struct stat *st);
+
+static void
+_walk_dir(WalkCtx *ctx, int32_t depth, const struct stat *st)
+{
+	assert(ctx != NULL);
+
+	if(ctx->opts->follow && !_walk_push_ancestor(ctx, st))
+	{
+		return;
+	}
+
+	WalkListing listing;
+
+	memset(&listing, 0, sizeof(WalkListing));
+	_walk_read_dir(ctx, &listing);
+
+	WalkDirent *entries = listing.entries;
+	size_t count = listing.count;
+	size_t len = ctx->len;
+
+	if(ctx->ignore_rules)
+	{
+		ignore_rules_push(ctx->ignore_rules, ctx->path);
+	}
+
+	/* the status of the entries is read in chunks of batch_size files */
+	StatRequest *requests = _walk_queue_stat(ctx) ? utils_new(ctx->batch_size, StatRequest) : NULL;
+	size_t chunk_start = 0;
+	size_t chunk_end = 0;
+	bool chunk_read = false;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(!ctx->stop)
+		{
+			const struct statx *stx = NULL;
+
+			if(requests)
+			{
+				if(i == chunk_end)
+				{
+					chunk_start = i;
+					chunk_end = i + ((count - i < ctx->batch_size) ? count - i : ctx->batch_size);
+					chunk_read = _walk_acquire(ctx, chunk_end - i) && _walk_stat_batch(ctx, entries + i, chunk_end - i, requests);
+				}
+
+				if(chunk_read && !requests[i - chunk_start].err)
+				{
+					stx = &requests[i - chunk_start].stx;
+				}
+			}
+			else
+			{
+				_walk_acquire(ctx, 1);
+			}
+
+			size_t namelen = strlen(entries[i].name);
+			bool slash = len && ctx->path[len - 1] != '/';
+
+			if(len + slash + namelen < PATH_MAX)
+			{
+				struct stat child_st;
+				mode_t mode;
+
+				if(slash)
+				{
+					ctx->path[ctx->len++] = '/';
+				}
+
+				memcpy(ctx->path + ctx->len, entries[i].name, namelen + 1);
+				ctx->len += namelen;
+
+				bool descend = true;
+
+				if(!ctx->stop
+				   && _walk_stat(ctx, entries[i].type, stx, &mode, &child_st)
+				   && !(ctx->ignore_rules && ignore_rules_matches(ctx->ignore_rules, ctx->path, S_ISDIR(mode)))
+				   && !(S_ISDIR(mode) && ctx->need_dev && child_st.st_dev != st->st_dev && !_walk_enter_filesystem(ctx, &child_st, &descend)))
+				{
+					_walk_visit(ctx, depth + 1, mode, stx, descend, &child_st);
+				}
+
+				ctx->len = len;
+				ctx->path[len] = '\0';
+			}
+			else
+			{
+				_walk_fail(ctx, ENAMETOOLONG);
+			}
+		}
+	}
+
+	free(requests);
+	_walk_listing_clear(&listing);
+
+	if(ctx->ignore_rules)
+	{
+		ignore_rules_pop(ctx->ignore_rules);
+	}
+
+	if(ctx->opts->follow)
+	{
+		--ctx->ancestors_count;
+	}
+}
+
+static void
+_walk_visit(WalkCtx *ctx, int32_t depth, mode_t mode, const struct statx *stx, bool descend, const struct stat *st)
+{
+	assert(ctx != NULL);
+
+	WalkEntry entry;
+
+	entry.path = ctx->path;
+	entry.depth = depth;
+	entry.is_dir = S_ISDIR(mode);
+	entry.type = mode;
+	entry.stx = stx;
+
+	WalkAction action = ctx->cb(&entry, ctx->user_data);
+
+	if(action == WALK_STOP)
+	{
+		TRACE("walk", "Walk stopped by callback.");
+		ctx->stop = true;
+	}
+	else if(action == WALK_CONTINUE && entry.is_dir && descend && (ctx->opts->max_depth < 0 || depth < ctx->opts->max_depth))
+	{
+		_walk_dir(ctx, depth, st);
+	}
+}
+
+bool
+walk(const char *path, const WalkOptions *opts, WalkCallback cb, WalkErrorCallback err, void *user_data)
+{
+	assert(path != NULL);
+	assert(opts != NULL);
+	assert(cb != NULL);
+
+	WalkCtx *ctx = utils_new(1, WalkCtx);
+
+	ctx->opts = opts;
+	ctx->cb = cb;
+	ctx->err = err;
+	ctx->user_data = user_data;
+	ctx->len = strlen(path);
+
+	if(opts->respect_ignore_files)
+	{
+		ctx->ignore_rules = ignore_rules_new();
+	}
+
+	if(opts->skip_fs_types)
+	{
+		ctx->fsmap = fs_map_get_default();
+	}
+
+	ctx->need_dev = ctx->fsmap || opts->one_file_system;
+	ctx->batch_size = WALK_STAT_BATCH_SIZE;
+
+	/* don't read more files at once than requests may be in flight */
+	if(opts->max_inflight && opts->max_inflight < ctx->batch_size)
+	{
+		ctx->batch_size = opts->max_inflight;
+	}
+
+	DEBUGF("walk", "Walking directory tree: %s", path);
+
+	if(ctx->len < PATH_MAX)
+	{
+		struct stat st;
+
+		memcpy(ctx->path, path, ctx->len + 1);
+
+		if(!(opts->follow ? stat(path, &st) : lstat(path, &st)))
+		{
+			ctx->root_dev = st.st_dev;
+			_walk_visit(ctx, 0, st.st_mode & S_IFMT, NULL, true, &st);
+		}
+		else
+		{
+			_walk_fail(ctx, errno);
+		}
+	}
+	else
+	{
+		if(err)
+		{
+			err(path, ENAMETOOLONG, user_data);
+		}
+
+		ctx->failed = true;
+	}
+
+	bool success = !ctx->failed;
+
+	ignore_rules_destroy(ctx->ignore_rules);
+	stat_batch_destroy(ctx->batch);
+	free(ctx->ancestors);
+	free(ctx);
+
+	return success;
+}
+
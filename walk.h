@@ -0,0 +1,156 @@
+/***************************************************************************
+    begin........: October 2026
+    copyright....: Sebastian Fedrau
+    email........: sebastian.fedrau@gmail.com
+ ***************************************************************************/
+
+/***************************************************************************
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License v3 as published by
+    the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License v3 for more details.
+ ***************************************************************************/
+/**
+   @file walk.h
+   @brief Walk directory trees in-process.
+   @author Sebastian Fedrau <sebastian.fedrau@gmail.com>
+ */
+#ifndef WALK_H
+#define WALK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "rate-limit.h"
+
+struct statx;
+
+/**
+   @enum WalkAction
+   @brief Actions returned by a WalkCallback.
+ */
+typedef enum
+{
+	/*! Descend the directory (if the file is a directory). */
+	WALK_CONTINUE,
+	/*! Don't descend the directory. */
+	WALK_SKIP,
+	/*! Stop walking. */
+	WALK_STOP
+} WalkAction;
+
+/**
+   @enum WalkInodeOrder
+   @brief Order in which the entries of a directory are visited.
+ */
+typedef enum
+{
+	/*! Sort entries by inode number if the directory is on a rotational disk. */
+	WALK_INODE_ORDER_AUTO,
+	/*! Always sort entries by inode number. */
+	WALK_INODE_ORDER_YES,
+	/*! Visit entries in the order they are read. */
+	WALK_INODE_ORDER_NO
+} WalkInodeOrder;
+
+/**
+   @struct WalkEntry
+   @brief A file found by the walker.
+ */
+typedef struct
+{
+	/*! Path of the file. */
+	const char *path;
+	/*! Depth relative to the starting point. */
+	int32_t depth;
+	/*! true if the file is a directory. */
+	bool is_dir;
+	/*! File type bits (S_IFMT) taken from d_type or the file's status. */
+	mode_t type;
+	/*! File status read in batch without following symbolic links (may be NULL). */
+	const struct statx *stx;
+} WalkEntry;
+
+/**
+   @struct WalkListing
+   @brief Entries of a directory.
+ */
+typedef struct _WalkListing WalkListing;
+
+/**
+   @typedef WalkListCallback
+   @brief Function called before a directory is read. It may append known entries
+          to the listing and return true to prevent the directory from being read.
+ */
+typedef bool (*WalkListCallback)(const char *path, WalkListing *listing, void *user_data);
+
+/**
+   @struct WalkOptions
+   @brief Walker options.
+ */
+typedef struct
+{
+	/*! Directory search level limitation, negative for no limitation. */
+	int32_t max_depth;
+	/*! Dereference symbolic links. */
+	bool follow;
+	/*! Skip files matching patterns found in .gitignore/.ignore files. */
+	bool respect_ignore_files;
+	/*! Don't descend directories on other filesystems. */
+	bool one_file_system;
+	/*! Comma-separated list of filesystems to skip (may be NULL). */
+	const char *skip_fs_types;
+	/*! Function providing cached directory entries (may be NULL). */
+	WalkListCallback list;
+	/*! statx fields to read in batches for entries on network filesystems, 0 to read no status. */
+	unsigned int stat_mask;
+	/*! Sort directory entries by inode number before their status is read. */
+	WalkInodeOrder inode_order;
+	/*! Limits the rate of read directories and files (may be NULL). */
+	RateLimit *rate_limit;
+	/*! Maximum number of status requests in flight, 0 for the default. */
+	unsigned int max_inflight;
+} WalkOptions;
+
+/**
+   @typedef WalkCallback
+   @brief Function called for each found file in pre-order.
+ */
+typedef WalkAction (*WalkCallback)(const WalkEntry *entry, void *user_data);
+
+/**
+   @typedef WalkErrorCallback
+   @brief Function called if a file cannot be accessed.
+ */
+typedef void (*WalkErrorCallback)(const char *path, int errnum, void *user_data);
+
+/**
+   @param listing a WalkListing
+   @param name name of the entry
+   @param type type of the entry (see d_type field of struct dirent)
+
+   Appends an entry to a directory listing.
+ */
+void walk_listing_append(WalkListing *listing, const char *name, unsigned char type);
+
+/**
+   @param path starting point
+   @param opts walker options
+   @param cb function called for each found file
+   @param err function called for each failure
+   @param user_data user data
+   @return false if at least one file couldn't be accessed
+
+   Walks a directory tree like find does. Entries of a directory are read
+   before the directory's children are visited, so only a single directory
+   is open at a time.
+ */
+bool walk(const char *path, const WalkOptions *opts, WalkCallback cb, WalkErrorCallback err, void *user_data);
+
+#endif
+